@@ -20,6 +20,7 @@ file(GLOB_RECURSE HEADER *.h)
 
 add_definitions(-DSHADERS_PATH="${SHADERS_PATH}")
 add_definitions(-DRESOURCES_PATH="${RESOURCES_PATH}")
+add_definitions(-DCACHE_PATH="${CACHE_PATH}")
 add_definitions(-DGLFW_INCLUDE_GLCOREARB)
 
 add_library(${ProjectId} ${SOURCES} ${HEADER})
@@ -13,6 +13,23 @@ find_package(ASSIMP REQUIRED)
 find_package(ANTTWEAKBAR REQUIRED)
 find_package(BULLET REQUIRED)
 
+# optional : parallelize CPU side voxel grid processing
+find_package(OpenMP)
+if(OPENMP_FOUND)
+	set(CMAKE_C_FLAGS "${CMAKE_C_FLAGS} ${OpenMP_C_FLAGS}")
+	set(CMAKE_CXX_FLAGS "${CMAKE_CXX_FLAGS} ${OpenMP_CXX_FLAGS}")
+endif()
+
+# optional : AVX2 code paths for CPU side voxel grid processing
+option(USE_AVX2 "Compile CPU side voxel grid processing with AVX2 instructions" OFF)
+if(USE_AVX2)
+	if(MSVC)
+		set(CMAKE_CXX_FLAGS "${CMAKE_CXX_FLAGS} /arch:AVX2")
+	else()
+		set(CMAKE_CXX_FLAGS "${CMAKE_CXX_FLAGS} -mavx2")
+	endif()
+endif()
+
 set(LIBRARY_OUTPUT_PATH ${PROJECT_BINARY_DIR}/lib)
 GENERATE_SUBDIRS(ALL_LIBRARIES ${CMAKE_SOURCE_DIR}/src/libraries)
 
@@ -271,6 +271,94 @@ void DispatchVoxelizeWithTexAtlasComputeShader::call() 	{
 	GL_R32UI);
 }
 
+DispatchVoxelizeWithPackedTexAtlasComputeShader::DispatchVoxelizeWithPackedTexAtlasComputeShader(
+		ComputeShader* computeShader,
+		TexAtlas::PackedTextureAtlas* packedAtlas,
+		VoxelGridGPU* voxelGrid, Texture* bitMask, int x, int y, int z)
+	: DispatchVoxelGridComputeShaderListener(computeShader, voxelGrid, x,y,z)
+{
+	p_packedAtlas = packedAtlas;
+	p_bitMask = bitMask;
+}
+
+void DispatchVoxelizeWithPackedTexAtlasComputeShader::updateModelMatrices() {
+	if ( !p_packedAtlas )
+	{
+		return;
+	}
+	p_packedAtlas->updateModelMatrices();
+	p_packedAtlas->uploadModelMatrices();
+}
+
+void DispatchVoxelizeWithPackedTexAtlasComputeShader::call() 	{
+	if ( !p_packedAtlas || p_packedAtlas->getNumTexels() == 0 )
+	{
+		return;
+	}
+
+	// use compute program
+	p_computeShader->useProgram();
+
+	// upload output texture
+	glBindImageTexture(0,
+	p_voxelGrid->handle,
+	0,
+	GL_FALSE,
+	0,
+	GL_READ_WRITE,						// allow both for atomic operations
+	GL_R32UI);							// 1 channel 32 bit unsigned int to make sure OR-ing works
+
+	// upload bit mask
+	glBindImageTexture(1,
+	p_bitMask->getTextureHandle(),
+	0,
+	GL_FALSE,
+	0,
+	GL_READ_ONLY,
+	GL_R32UI
+	);
+
+	// bind texel coordinates and model matrices to shader storage buffers
+	glBindBufferBase( GL_SHADER_STORAGE_BUFFER, 0, p_packedAtlas->getTexelBufferHandle() );
+	glBindBufferBase( GL_SHADER_STORAGE_BUFFER, 2, p_packedAtlas->getModelMatrixBufferHandle() );
+
+	// bind packed texture atlas
+	glActiveTexture( GL_TEXTURE3 );
+	glBindTexture( GL_TEXTURE_2D, p_packedAtlas->getTextureHandle() );
+	p_computeShader->uploadUniform( 3, "uniformTextureAtlas" );
+
+	// upload uniform voxel grid matrix
+	p_computeShader->uploadUniform( p_voxelGrid->worldToVoxel, "uniformWorldToVoxel" );
+
+	// upload uniform vertices amount
+	int numVertices = p_packedAtlas->getNumTexels();
+	p_computeShader->uploadUniform( numVertices, "uniformNumVertices");
+
+	// one thread per valid texel of all objects
+	m_num_groups_x = int ( ceil( (float)numVertices / (float)p_computeShader->getLocalGroupSizeX() ) );
+	m_num_groups_y = 1;
+	m_num_groups_z = 1;
+
+	// dispatch as usual
+	DispatchComputeShaderListener::call();
+
+	glMemoryBarrier( GL_ALL_BARRIER_BITS );
+
+	glBindTexture( GL_TEXTURE_2D, 0 );
+	glActiveTexture( GL_TEXTURE0 );
+
+	// unbind image textures
+	glBindImageTexture(0, 0, 0,
+	GL_FALSE, 0,
+	GL_READ_WRITE,
+	GL_R32UI);
+
+	glBindImageTexture(1, 0, 0,
+	GL_FALSE, 0,
+	GL_READ_ONLY,
+	GL_R32UI);
+}
+
 void DispatchVoxelizeComputeShader::call()
 {
 	// use compute program
@@ -397,7 +485,9 @@ VoxelizationManager::VoxelizationManager() {
 	m_activeVoxelizationMethod = SLICEMAP;
 	m_dispatchVoxelizeCompute = 0;
 	m_dispatchVoxelizeTexAtlasCompute = 0;
+	m_dispatchVoxelizePackedTexAtlasCompute = 0;
 	m_dispatchCountFullVoxels = 0;
+	m_countFullVoxelsCPU = true;
 	m_sliceMapRenderPass = 0;
 	m_texAtlasSliceMapRenderPass = 0;
 	m_activeCandidateObject = 0;
@@ -413,10 +503,12 @@ VoxelizationManager::VoxelizationManager() {
 	m_texAtlas_time_mean = -1.0;
 	m_sliceMap_time_mean = -1.0;
 	m_texAtlasUpdate_time_mean = -1.0;
+	m_computePackedTexAtlas_time_mean = -1.0;
 
 	m_iterationCounter = 0;
 	m_compute_times.resize(100,-1000.0);
 	m_computeTexAtlas_times.resize(100,-1000.0);
+	m_computePackedTexAtlas_times.resize(100,-1000.0);
 	m_texAtlas_times.resize(100,-1000.0);
 	m_texAtlasUpdate_times.resize(100,-10000.0);
 	m_sliceMap_times.resize(100,-1000.0);
@@ -481,7 +573,24 @@ void VoxelizationManager::call() {
 		}
 		break;
 	case COMPUTETEXATLAS:
-		if ( m_dispatchVoxelizeTexAtlasCompute != 0)
+		if ( m_dispatchVoxelizePackedTexAtlasCompute != 0 )
+		{
+			// update voxelgrid
+			m_dispatchVoxelizePackedTexAtlasCompute->p_voxelGrid = m_activeVoxelGrid;
+
+			// the packed atlas holds model space positions, moved objects only update the model matrix table
+			startTime();
+			m_dispatchVoxelizePackedTexAtlasCompute->updateModelMatrices();
+			stopTime();
+			m_texAtlasUpdate_times[m_iterationCounter] = m_executionTime;
+
+			// every candidate is voxelized by this dispatch, so the time goes to a column of its own
+			startTime(); // begin time query
+			m_dispatchVoxelizePackedTexAtlasCompute->call();
+			stopTime();		// end time query
+			m_computePackedTexAtlas_times[m_iterationCounter] = m_executionTime; // update time
+		}
+		else if ( m_dispatchVoxelizeTexAtlasCompute != 0)
 		{
 			// update voxelgrid
 			m_dispatchVoxelizeTexAtlasCompute->p_voxelGrid = m_activeVoxelGrid;
@@ -540,9 +649,11 @@ void VoxelizationManager::call() {
 		// update mean times
 		double sumCompute, sumComputeTexAtlas, sumTexAtlasUpdate, sumTexAtlas,
 				sumSliceMap = 0.0;
+		double sumComputePackedTexAtlas = 0.0;
 		for (unsigned int i = 0; i < 100; i++) {
 			sumCompute += m_compute_times[i];
 			sumComputeTexAtlas += m_computeTexAtlas_times[i];
+			sumComputePackedTexAtlas += m_computePackedTexAtlas_times[i];
 			sumTexAtlas += m_texAtlas_times[i];
 			sumTexAtlasUpdate += m_texAtlasUpdate_times[i];
 			sumSliceMap += m_sliceMap_times[i];
@@ -553,6 +664,7 @@ void VoxelizationManager::call() {
 		m_texAtlas_time_mean = sumTexAtlas / 100.0;
 		m_computeTexAtlas_time_mean = sumComputeTexAtlas / 100.0;
 		m_texAtlasUpdate_time_mean = sumTexAtlasUpdate / 100.0;
+		m_computePackedTexAtlas_time_mean = sumComputePackedTexAtlas / 100.0;
 
 	}
 
@@ -563,23 +675,44 @@ void VoxelizationManager::call() {
 		m_dispatchCountFullVoxels->p_voxelGrid = m_activeVoxelGrid;
 
 		m_dispatchCountFullVoxels->call();
-		switch (m_activeVoxelizationMethod) {
-		case SLICEMAP:
-			m_sliceMap_voxels = m_dispatchCountFullVoxels->m_amount;
-			break;
-		case COMPUTETEXATLAS:
-			m_computeTexAtlas_voxels = m_dispatchCountFullVoxels->m_amount;
-			break;
-		case COMPUTE:
-			m_compute_voxels = m_dispatchCountFullVoxels->m_amount;
-			break;
-		case TEXATLAS:
-			m_texAtlas_voxels = m_dispatchCountFullVoxels->m_amount;
-			break;
+		setFillAmount( m_dispatchCountFullVoxels->m_amount );
+	}
+	else if ( m_countFullVoxelsCPU )
+	{
+		// read the voxel grid texture back, a full GPU round trip, instead of counting bits with atomic counters
+		if ( m_countVoxelGrid.getWidth() != m_activeVoxelGrid->resX || m_countVoxelGrid.getHeight() != m_activeVoxelGrid->resY || m_countVoxelGrid.getDepth() != m_activeVoxelGrid->resZ )
+		{
+			m_countVoxelGrid.resize( m_activeVoxelGrid->resX, m_activeVoxelGrid->resY, m_activeVoxelGrid->resZ );
 		}
+		m_countVoxelGrid.setWorldToVoxel( m_activeVoxelGrid->worldToVoxel );
+		m_countVoxelGrid.readFromTexture( m_activeVoxelGrid->handle );
+
+		countFullVoxels( m_countVoxelGrid );
+	}
+}
+
+void VoxelizationManager::setFillAmount(unsigned int amount) {
+	switch (m_activeVoxelizationMethod) {
+	case SLICEMAP:
+		m_sliceMap_voxels = amount;
+		break;
+	case COMPUTETEXATLAS:
+		m_computeTexAtlas_voxels = amount;
+		break;
+	case COMPUTE:
+		m_compute_voxels = amount;
+		break;
+	case TEXATLAS:
+		m_texAtlas_voxels = amount;
+		break;
 	}
 }
 
+void VoxelizationManager::countFullVoxels(const Grid::BitVoxelGrid& voxelGrid) {
+	m_occupancyHistogram = Grid::countOccupiedVoxels( voxelGrid );
+	setFillAmount( m_occupancyHistogram.m_total );
+}
+
 CandidateObject::CandidateObject() {
 	m_object = 0;
 	m_texAtlasRenderPass = 0;
@@ -804,6 +937,7 @@ Listener* VoxelizationManager::getPrintVoxelizationTimesListener() {
 	subjectListener->addListener(new DebugPrintDoubleListener(&m_compute_time_mean,  "Voxelization Times (ms) : Compute          : "));
 	subjectListener->addListener(new DebugPrintDoubleListener(&m_computeTexAtlas_time_mean, "Voxelization Times (ms) : Compute TexAtlas : "));
 	subjectListener->addListener(new DebugPrintDoubleListener(&m_texAtlasUpdate_time_mean, "Voxelization Times (ms) : Update TexAtlas  : "));
+	subjectListener->addListener(new DebugPrintDoubleListener(&m_computePackedTexAtlas_time_mean, "Voxelization Times (ms) : Compute Packed TexAtlas, all candidates : "));
 	subjectListener->addListener(new DebugPrintListener(                        "-----------------------------------------------"));
 
 	return subjectListener;
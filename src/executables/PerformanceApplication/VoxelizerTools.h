@@ -4,7 +4,9 @@
 #include "VoxelGridTools.h"
 
 #include <Voxelization/TextureAtlas.h>
+#include <Voxelization/TextureAtlasPacker.h>
 #include <Voxelization/SliceMapRendering.h>
+#include <Voxelization/VoxelCounting.h>
 #include <Rendering/Shader.h>
 #include <Misc/MiscListeners.h>
 #include <Utility/SubjectListenerPattern.h>
@@ -12,6 +14,7 @@
 
 class DispatchVoxelizeComputeShader;
 class DispatchVoxelizeWithTexAtlasComputeShader;
+class DispatchVoxelizeWithPackedTexAtlasComputeShader;
 class DispatchVoxelGridComputeShaderListener;
 class DispatchCountFullVoxelsComputeShader;
 
@@ -56,12 +59,14 @@ public:
 	double m_sliceMap_time_mean;
 
 	double m_texAtlasUpdate_time_mean;
+	double m_computePackedTexAtlas_time_mean;	// all candidates in one dispatch, not comparable to the per object times
 
 	std::vector<double> m_compute_times;
 	std::vector<double> m_texAtlas_times;
 	std::vector<double> m_texAtlasUpdate_times;
 	std::vector<double> m_sliceMap_times;
 	std::vector<double> m_computeTexAtlas_times;
+	std::vector<double> m_computePackedTexAtlas_times;
 	int m_iterationCounter;
 
 
@@ -74,6 +79,7 @@ public:
 	// Voxelizers
 	DispatchVoxelizeComputeShader* 				m_dispatchVoxelizeCompute;
 	DispatchVoxelizeWithTexAtlasComputeShader* 	m_dispatchVoxelizeTexAtlasCompute;
+	DispatchVoxelizeWithPackedTexAtlasComputeShader* m_dispatchVoxelizePackedTexAtlasCompute;	// if set, COMPUTETEXATLAS voxelizes all candidates at once
 	SliceMap::SliceMapRenderPass*				m_sliceMapRenderPass;
 //	TexAtlas::TextureAtlasRenderPass* 			m_texAtlasRenderPass;
 	SliceMap::SliceMapRenderPass*				m_texAtlasSliceMapRenderPass;
@@ -81,6 +87,12 @@ public:
 	// count voxels dispatcher
 	DispatchCountFullVoxelsComputeShader*       m_dispatchCountFullVoxels;
 
+	// count voxels on CPU instead, if no dispatcher is set : reads the voxel grid texture back every call
+	// callers holding a CPU resident grid already should use countFullVoxels( grid ) instead
+	bool										m_countFullVoxelsCPU;
+	Grid::BitVoxelGrid							m_countVoxelGrid;		// CPU copy of the active voxel grid
+	Grid::OccupancyHistogram					m_occupancyHistogram;	// result of the last CPU count
+
 	VoxelizationMethod 							m_activeVoxelizationMethod;
 	CandidateObject*							m_activeCandidateObject;
 	VoxelGridGPU*								m_activeVoxelGrid;
@@ -97,6 +109,12 @@ public:
 	void startTime();
 	void stopTime();
 
+	// set fill amount of active voxelization method
+	void setFillAmount( unsigned int amount );
+
+	// count voxels of a CPU grid and set fill amount of active voxelization method
+	void countFullVoxels( const Grid::BitVoxelGrid& voxelGrid );
+
 	// silly listeners
 	Listener* getSwitchThroughCandidatesListener();
 	Listener* getSwitchThroughVoxelGridsListener();
@@ -200,4 +218,22 @@ public:
 	void call();
 };
 
+/**
+ * Voxelize all objects of a packed tex atlas with a single dispatch
+ */
+class DispatchVoxelizeWithPackedTexAtlasComputeShader : public DispatchVoxelGridComputeShaderListener
+{
+public:
+	TexAtlas::PackedTextureAtlas* p_packedAtlas;
+	Texture* p_bitMask;
+public:
+	DispatchVoxelizeWithPackedTexAtlasComputeShader(ComputeShader* computeShader, TexAtlas::PackedTextureAtlas* packedAtlas, VoxelGridGPU* voxelGrid, Texture* bitMask, int x= 0, int y= 0, int z = 0 );
+
+	/**
+	 * update and upload the model matrix table of the packed atlas, must be called before call() whenever objects have moved
+	 */
+	void updateModelMatrices();
+	void call();
+};
+
 #endif
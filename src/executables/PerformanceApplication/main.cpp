@@ -1,5 +1,6 @@
 #include <Application/Application.h>
 
+#include <algorithm>
 #include <iostream>
 #include <stdlib.h>
 #include <time.h>
@@ -16,6 +17,9 @@
 #include <Scene/RenderableNode.h>
 #include <Utility/Updatable.h>
 #include <Voxelization/TextureAtlas.h>
+#include <Voxelization/TextureAtlasCache.h>
+#include <Voxelization/TextureAtlasPacker.h>
+#include <Voxelization/TextureAtlasSizing.h>
 #include <Voxelization/SliceMapRendering.h>
 
 #include <Misc/Turntable.h>
@@ -38,6 +42,12 @@ static bool  VOXELIZE_REGULAR_ACTIVE = true;
 static bool  VOXELIZE_ACTIVE = true;
 
 static int   TEXATLAS_RESOLUTION  = 512;
+static bool  TEXATLAS_AUTOMATIC_RESOLUTION = true;	// derive resolution from surface area and cell size instead
+static int   TEXATLAS_MAX_RESOLUTION = 4096;
+static bool  TEXATLAS_USE_CACHE = true;		// load atlas vertices of unchanged meshes from disk
+static bool  TEXATLAS_PACKED = false;		// voxelize all candidate objects with a single dispatch on a shared packed atlas, not yet verified on hardware
+
+static bool  COUNT_VOXELS_ON_CPU = false;	// read the voxel grid back every frame and count on the CPU, stalls the pipeline, for checking the atomic counters only
 
 static bool  ENABLE_VOXELGRID_OVERLAY = true;
 
@@ -346,19 +356,27 @@ public:
 			std::vector<Renderable* > renderables;
 			m_objectsNode = new Node( scene->getSceneGraph()->getRootNode() );
 
-			RenderableNode* blackBox= SimpleScene::loadObject("/blackBox.dae" , this);
+			// load all files at once, so their textures are decoded in parallel
+			std::vector< std::string > objectFiles;
+			objectFiles.push_back( "/blackBox.dae" );
+			objectFiles.push_back( "/testRoom.dae" );
+			objectFiles.push_back( "/stanford/bunny/blender_bunny.dae" );
+//			objectFiles.push_back( "/stanford/buddha/blender_buddha.dae" );
+//			objectFiles.push_back( "/cube2.dae" );
+//			objectFiles.push_back( "/bigQuad11858.dae" );
+//			objectFiles.push_back( "/bigQuad2.dae" );
+			std::vector< RenderableNode* > objectNodes = SimpleScene::loadObjects( objectFiles, this );
+
+			RenderableNode* blackBox= objectNodes[0];
 			blackBox->setParent(scene->getSceneGraph()->getRootNode());
 			renderables.push_back(blackBox);
 
-			RenderableNode* testRoomNode = SimpleScene::loadTestRoomObject( this );
+			RenderableNode* testRoomNode = objectNodes[1];
+			testRoomNode->scale( glm::vec3(0.75f, 0.75f, 0.75f) );
 			testRoomNode->setParent( m_objectsNode );
 //			renderables.push_back(testRoomNode);
 
-			RenderableNode* mainObjectNode= SimpleScene::loadObject("/stanford/bunny/blender_bunny.dae" , this);
-//			RenderableNode* mainObjectNode= SimpleScene::loadObject("/stanford/buddha/blender_buddha.dae" , this);
-//			RenderableNode* mainObjectNode= SimpleScene::loadObject("/cube2.dae" , this);
-//			RenderableNode* mainObjectNode= SimpleScene::loadObject("/bigQuad11858.dae" , this);
-//			RenderableNode* mainObjectNode= SimpleScene::loadObject("/bigQuad2.dae" , this);
+			RenderableNode* mainObjectNode= objectNodes[2];
 
 			Node* scaleNode = new Node(m_objectsNode );
 			mainObjectNode->setParent( scaleNode );
@@ -452,6 +470,16 @@ public:
 		DEBUGLOG->log("Configuring texture atlas objects");
 		DEBUGLOG->indent();
 
+		// atlases are shared by all voxel grids, so the finest grid determines the resolution
+		float finestCellSize = m_voxelizationManager.m_voxelGrids[0]->cellSize;
+		for ( unsigned int i = 1; i < m_voxelizationManager.m_voxelGrids.size(); i++ )
+		{
+			finestCellSize = std::min( finestCellSize, m_voxelizationManager.m_voxelGrids[i]->cellSize );
+		}
+
+		// all candidate objects share one packed atlas, charts are sized like the individual atlases
+		TexAtlas::PackedTextureAtlas* packedTextureAtlas = new TexAtlas::PackedTextureAtlas();
+
 		for ( unsigned int i = 0; i < m_voxelizationManager.m_candidateObjects.size(); i++ )
 		{
 			CandidateObject* currentCandidate = m_voxelizationManager.m_candidateObjects[i];
@@ -463,8 +491,34 @@ public:
 				GLenum internalFormat = FramebufferObject::static_internalFormat;
 				FramebufferObject::static_internalFormat = GL_RGBA32F_ARB;// change this first
 
+				int textureAtlasResolution = TEXATLAS_RESOLUTION;
+				if ( TEXATLAS_AUTOMATIC_RESOLUTION )
+				{
+					TexAtlas::AtlasSizing atlasSizing = TexAtlas::computeAtlasSizing( m_resourceManager, currentObject, finestCellSize, TEXATLAS_MAX_RESOLUTION );
+					textureAtlasResolution = atlasSizing.m_resolution;
+					DEBUGLOG->log("surface area     : ", atlasSizing.m_surfaceArea );
+					DEBUGLOG->log("maximum stretch  : ", atlasSizing.m_maxStretch );
+					DEBUGLOG->log("atlas resolution : ", textureAtlasResolution );
+				}
+
+				if ( TEXATLAS_PACKED )
+				{
+					packedTextureAtlas->addObject( m_resourceManager, currentObject, textureAtlasResolution );
+				}
+
+				// look up the atlas vertices of this mesh, model matrix and resolution
+				Model* currentModel = currentObject->getObject()->getModel();
+				unsigned long long atlasCacheKey = TexAtlas::computeAtlasCacheKey(
+						m_resourceManager.getMeshRecord( currentModel ),
+						currentObject->getAccumulatedModelMatrix(),
+						textureAtlasResolution, textureAtlasResolution );
+				std::string atlasCachePath = TexAtlas::getAtlasCacheFileName( atlasCacheKey );
+
+				TexAtlas::AtlasVertexCache atlasVertexCache;
+				bool atlasCached = TEXATLAS_USE_CACHE && atlasVertexCache.load( atlasCachePath, atlasCacheKey );
+
 				// create renderpass that generates a textureAtlas for models
-				TexAtlas::TextureAtlasRenderPass* textureAtlasRenderPass = new TexAtlas::TextureAtlasRenderPass(currentObject, TEXATLAS_RESOLUTION, TEXATLAS_RESOLUTION );
+				TexAtlas::TextureAtlasRenderPass* textureAtlasRenderPass = new TexAtlas::TextureAtlasRenderPass(currentObject, textureAtlasResolution, textureAtlasResolution );
 
 				FramebufferObject::static_internalFormat = internalFormat;	// restore default
 			DEBUGLOG->outdent();
@@ -474,11 +528,24 @@ public:
 
 				//create texture atlas vertex generator to generate vertices
 				TexAtlas::TextureAtlasVertexGenerator* textureAtlasVertexGenerator = new TexAtlas::TextureAtlasVertexGenerator( textureAtlasRenderPass->getTextureAtlas() );
+
+				// append valid texels on the GPU instead of reading back the texture atlas
+				textureAtlasVertexGenerator->setExtractionMode( TexAtlas::EXTRACT_COMPUTE_SHADER );
 			DEBUGLOG->outdent();
 
 			DEBUGLOG->log("Initializing Texture Atlas functionality");
 			DEBUGLOG->indent();
 
+			if ( atlasCached )
+			{
+				DEBUGLOG->log("Loading Texture Atlas vertices from cache : " + atlasCachePath);
+				// the atlas is rendered before every voxelization anyway
+				textureAtlasVertexGenerator->generateVertexPositions( atlasVertexCache );
+				textureAtlasVertexGenerator->generateVertexArrayObject();
+				atlasVertexCache.close();
+			}
+			else
+			{
 				DEBUGLOG->log("Generating Texture Atlas valid coordinates");
 				// render texture atlas once so it can be validated
 				textureAtlasRenderPass->render();
@@ -487,6 +554,15 @@ public:
 				// generate vertices from texture atlas
 				textureAtlasVertexGenerator->call();
 
+				if ( TEXATLAS_USE_CACHE )
+				{
+					DEBUGLOG->log("Writing Texture Atlas vertices to cache : " + atlasCachePath);
+					TexAtlas::WorldPositionAtlas worldPositionAtlas;
+					worldPositionAtlas.readTexture( textureAtlasRenderPass->getTextureAtlas()->getTextureHandle() );
+					TexAtlas::AtlasVertexCache::write( atlasCachePath, atlasCacheKey, worldPositionAtlas );
+				}
+			}
+
 			DEBUGLOG->outdent();
 
 			// set missing variables
@@ -494,6 +570,25 @@ public:
 			currentCandidate->m_atlas = textureAtlasRenderPass->getTextureAtlas();
 			currentCandidate->m_atlasObject = textureAtlasVertexGenerator->getPixelsObject();
 		}
+
+		if ( TEXATLAS_PACKED )
+		{
+			DEBUGLOG->log("Packing Texture Atlas charts of all candidate objects");
+			DEBUGLOG->indent();
+			if ( packedTextureAtlas->pack( TEXATLAS_MAX_RESOLUTION ) )
+			{
+				packedTextureAtlas->uploadAtlas();
+				DEBUGLOG->log("packed atlas width  : ", packedTextureAtlas->getAtlas().getWidth() );
+				DEBUGLOG->log("packed atlas height : ", packedTextureAtlas->getAtlas().getHeight() );
+				DEBUGLOG->log("valid texels        : ", packedTextureAtlas->getNumTexels() );
+			}
+			else
+			{
+				DEBUGLOG->log("Charts do not fit, falling back to one dispatch per object");
+				TEXATLAS_PACKED = false;
+			}
+			DEBUGLOG->outdent();
+		}
 		DEBUGLOG->outdent();
 
 		/**************************************************************************************
@@ -527,6 +622,18 @@ public:
 
 			DEBUGLOG->outdent();
 
+			ComputeShader* voxelizeWithPackedTexAtlasComputeShader = 0;
+			if ( TEXATLAS_PACKED )
+			{
+				DEBUGLOG->log("Loading and compiling voxel grid filling packed texture atlas enabled compute shader program");
+				DEBUGLOG->indent();
+
+				// shader that voxelizes all objects of the packed texture atlas at once
+				voxelizeWithPackedTexAtlasComputeShader = new ComputeShader(SHADERS_PATH "/compute/voxelizeWithPackedTexAtlasCompute.comp");
+
+				DEBUGLOG->outdent();
+			}
+
 			DEBUGLOG->log("Loading and compiling voxel counting atomic counter enabled compute shader program");
 			DEBUGLOG->indent();
 
@@ -598,6 +705,23 @@ public:
 
 			DEBUGLOG->outdent();
 
+			DispatchVoxelizeWithPackedTexAtlasComputeShader* dispatchVoxelizeWithPackedTexAtlasComputeShader = 0;
+			if ( TEXATLAS_PACKED )
+			{
+				DEBUGLOG->log("Creating voxel grid filling packed tex atlas enabled compute shader dispatcher");
+				DEBUGLOG->indent();
+
+				dispatchVoxelizeWithPackedTexAtlasComputeShader = new DispatchVoxelizeWithPackedTexAtlasComputeShader(
+						voxelizeWithPackedTexAtlasComputeShader,
+						packedTextureAtlas,
+						m_voxelizationManager.m_activeVoxelGrid,
+						SliceMap::get32BitUintMask()
+						);
+				dispatchVoxelizeWithPackedTexAtlasComputeShader->setQueryTime( false );
+
+				DEBUGLOG->outdent();
+			}
+
 //			DEBUGLOG->log("Creating voxel grid mipmapping compute shader dispatcher");
 //			DEBUGLOG->indent();
 //
@@ -653,6 +777,7 @@ public:
 			DEBUGLOG->log("Setting all the Voxelization methods to voxelization manager");
 			m_voxelizationManager.m_dispatchVoxelizeCompute = dispatchVoxelizeComputeShader;
 			m_voxelizationManager.m_dispatchVoxelizeTexAtlasCompute = dispatchVoxelizeWithTexAtlasComputeShader;
+			m_voxelizationManager.m_dispatchVoxelizePackedTexAtlasCompute = dispatchVoxelizeWithPackedTexAtlasComputeShader;
 			m_voxelizationManager.m_sliceMapRenderPass = sliceMapRenderPass;
 
 			m_voxelizationManager.m_texAtlasSliceMapRenderPass = texAtlasSliceMapRenderPass;
@@ -696,7 +821,11 @@ public:
 					0,0,0);
 
 //			attach(dispatchCountFullVoxels, "COUNTVOXELS");
-			m_voxelizationManager.m_dispatchCountFullVoxels = dispatchCountFullVoxels;
+			if ( !COUNT_VOXELS_ON_CPU )
+			{
+				m_voxelizationManager.m_dispatchCountFullVoxels = dispatchCountFullVoxels;
+			}
+			m_voxelizationManager.m_countFullVoxelsCPU = COUNT_VOXELS_ON_CPU;
 
 		DEBUGLOG->outdent();
 
@@ -9,6 +9,10 @@
 #include <Scene/RenderableNode.h>
 #include <Utility/Updatable.h>
 #include <Voxelization/VoxelGrid.h>
+#include <Voxelization/BitVoxelGrid.h>
+#include <Voxelization/GreedyMesher.h>
+#include <Voxelization/VoxelCompaction.h>
+#include <Resources/InstancedObject.h>
 
 #include <Misc/MiscListeners.h>
 #include <Misc/Turntable.h>
@@ -17,6 +21,8 @@
 
 #include <Misc/SimpleSceneTools.h>
 
+static bool LOAD_HEADLESS = true;	// load the scene files without GL calls, the voxelizer only reads the CPU side geometry, then buffer them for display
+
 class GridRenderPass : public CameraRenderPass
 {
 protected:
@@ -41,6 +47,13 @@ public:
 	}
 };
 
+/**
+ * RENDERABLE_NODES : one cube per filled cell
+ * SURFACE_MESH : one mesh of the merged boundary faces of all filled cells
+ * INSTANCED_CUBES : one instanced draw call of the cube for all filled cells, requires grid/instancedVertex.vert
+ */
+enum VoxelDisplayMode { DISPLAY_RENDERABLE_NODES, DISPLAY_SURFACE_MESH, DISPLAY_INSTANCED_CUBES };
+
 /**
  * class that resets and voxelizes a set of objects upon call
  */
@@ -55,6 +68,11 @@ protected:
 	std::vector < std::pair < Grid::GridCell*, glm::vec3 > > m_filledGridCells;	// vector to keep track of filled cells
 	std::vector < RenderableNode* > m_renderableNodes;	// vector consisiting of all generated renderable nodes
 	std::vector < RenderPass* > p_gridCellRenderPasses; 	// renderpasses to be updated with the renderablenodes
+
+	VoxelDisplayMode m_displayMode;
+	Grid::VoxelMesh m_surfaceMesh;		// merged boundary faces of the filled cells
+	Object* m_surfaceMeshObject;		// object displaying the surface mesh, if any
+	InstancedObject* m_instancedCubes;	// object displaying one cube instance per filled cell, if any
 public:
 	CPUVoxelizer(Grid::AxisAlignedVoxelGrid* axisAlignedVoxelGrid, Scene* scene, ResourceManager* resourceManager, const std::vector<Object* >& objects, Node* parentNode, std::vector <RenderPass* > gridCellRenderPasses = std::vector<RenderPass* >())
 	{
@@ -65,6 +83,15 @@ public:
 		p_parentNode = parentNode;
 
 		m_objects = objects;
+
+		m_displayMode = DISPLAY_RENDERABLE_NODES;
+		m_surfaceMeshObject = 0;
+		m_instancedCubes = 0;
+	}
+
+	void setDisplayMode( VoxelDisplayMode displayMode )
+	{
+		m_displayMode = displayMode;
 	}
 
 	void clear()
@@ -89,6 +116,28 @@ public:
 			delete ( m_renderableNodes[i] );
 		}
 		m_renderableNodes.clear();
+
+		// delete surface mesh from previous calls
+		if ( m_surfaceMeshObject )
+		{
+			Model* model = m_surfaceMeshObject->getModel();
+			GLuint buffers[3] = { model->getIndexBufferHandle(), model->getPositionBufferHandle(), model->getNormalBufferHandle() };
+			glDeleteBuffers( 3, buffers );
+			GLuint vertexArrayHandle = model->getVAOHandle();
+			glDeleteVertexArrays( 1, &vertexArrayHandle );
+
+			delete model;
+			delete m_surfaceMeshObject;
+			m_surfaceMeshObject = 0;
+		}
+		m_surfaceMesh.clear();
+
+		// delete instanced cubes from previous calls
+		if ( m_instancedCubes )
+		{
+			delete m_instancedCubes;
+			m_instancedCubes = 0;
+		}
 	}
 
 	void voxelize()
@@ -124,22 +173,22 @@ public:
 			DEBUGLOG->log("ERROR : no model objectNode could be retrieved");
 		}
 
-		const std::vector < glm::vec4 >& assimpMesh = p_resourceManager->getAssimpMeshForModel(model);
-		const std::vector < std::vector <unsigned int> >& assimpMeshFaces = p_resourceManager->getAssimpMeshFacesForModel(model);
+		const MeshRecord& mesh = p_resourceManager->getMeshRecord(model);
 
 		// fill voxel grid by checking faces against grid volume
-		for (unsigned int j = 0; j < assimpMeshFaces.size(); j++)
+		std::vector< glm::vec3 > worldSpaceFaceVertices;
+		for (int j = 0; j < mesh.getNumFaces(); j++)
 		{
-			std::vector< glm::vec3 > worldSpaceFaceVertices;
+			worldSpaceFaceVertices.clear();
 
 			// retrieve current face vertices indices
-			std::vector< unsigned int > currentFace = assimpMeshFaces[j];
+			const unsigned int* currentFace = mesh.getFace(j);
 
 			// retrieve world space face vertices
-			for (unsigned int k = 0; k < currentFace.size(); k++)
+			for (int k = 0; k < mesh.getFaceSize(j); k++)
 			{
 				// retrieve vertex by face index
-				glm::vec4 worldSpaceVertex = modelMatrix * assimpMesh[ currentFace[k] ];
+				glm::vec4 worldSpaceVertex = modelMatrix * glm::vec4( mesh.getPosition( currentFace[k] ), 1.0f );
 				if ( worldSpaceVertex.w != 1.0f )
 				{
 					DEBUGLOG->log("WARNING : Weird homogeneous coordinate detected: ", worldSpaceVertex.w);
@@ -164,8 +213,77 @@ public:
 		return filledCells;
 	}
 
+	void generateSurfaceMesh()
+	{
+		DEBUGLOG->log("Generating surface mesh from filled cells");
+
+		Grid::BitVoxelGrid bitVoxelGrid;
+		bitVoxelGrid.readFromAxisAlignedVoxelGrid( p_axisAlignedVoxelGrid );
+
+		int numQuads = Grid::extractGreedyMesh( bitVoxelGrid, m_surfaceMesh );
+		DEBUGLOG->log("Merged boundary quads: ", numQuads);
+
+		Model* model = m_surfaceMesh.createModel();
+		if ( !model )
+		{
+			return;
+		}
+
+		// share the material of the cell cubes
+		m_surfaceMeshObject = new Object( model, p_resourceManager->getCube()->getMaterial() );
+		m_surfaceMeshObject->setRenderMode( GL_TRIANGLES );
+
+		RenderableNode* surfaceMeshNode = new RenderableNode( p_parentNode );
+		surfaceMeshNode->setObject( m_surfaceMeshObject );
+
+		m_renderableNodes.push_back( surfaceMeshNode );
+	}
+
+	void generateInstancedCubes()
+	{
+		DEBUGLOG->log("Generating cube instances from filled cells");
+
+		Grid::BitVoxelGrid bitVoxelGrid;
+		bitVoxelGrid.readFromAxisAlignedVoxelGrid( p_axisAlignedVoxelGrid );
+
+		// dense, morton sorted list of filled cells
+		std::vector< glm::ivec3 > coordinates;
+		std::vector< glm::vec3 > centers;
+		Grid::compactOccupiedVoxels( bitVoxelGrid, coordinates );
+		Grid::computeVoxelCenters( bitVoxelGrid, coordinates, centers );
+
+		std::vector< glm::vec4 > instances( centers.size() );
+		for ( unsigned int i = 0; i < centers.size(); i++ )
+		{
+			instances[i] = glm::vec4( centers[i], p_axisAlignedVoxelGrid->getCellSize() );
+		}
+		DEBUGLOG->log("Cube instances: ", instances.size());
+
+		// share the model and material of the cell cubes
+		Object* cube = p_resourceManager->getCube();
+		m_instancedCubes = new InstancedObject( cube->getModel(), cube->getMaterial() );
+		m_instancedCubes->setRenderMode( GL_LINES );
+		m_instancedCubes->setInstances( instances );
+
+		RenderableNode* instancedCubesNode = new RenderableNode( p_parentNode );
+		instancedCubesNode->setObject( m_instancedCubes );
+
+		m_renderableNodes.push_back( instancedCubesNode );
+	}
+
 	void generateRenderableNodes()
 	{
+		if ( m_displayMode == DISPLAY_SURFACE_MESH )
+		{
+			generateSurfaceMesh();
+			return;
+		}
+		if ( m_displayMode == DISPLAY_INSTANCED_CUBES )
+		{
+			generateInstancedCubes();
+			return;
+		}
+
 		DEBUGLOG->log("Generating renderable nodes from filled cells");
 		for ( unsigned int i = 0; i < m_filledGridCells.size(); i++)
 		{
@@ -225,6 +343,13 @@ class UniformVoxelGridApp : public Application
 	{
 		DEBUGLOG->log("Loading some objects");
 		DEBUGLOG->indent();
+
+			if ( LOAD_HEADLESS )
+			{
+				DEBUGLOG->log("Loading in headless mode, keeping mesh data for upload");
+				m_resourceManager.setHeadless( true );
+				m_resourceManager.setKeepMeshDataForUpload( true );
+			}
 		
 			DEBUGLOG->log("Loading test room dae file");
 			DEBUGLOG->indent();
@@ -236,6 +361,17 @@ class UniformVoxelGridApp : public Application
 				std::vector< Object* > overlappingGeometry =  m_resourceManager.loadObjectsFromFile( RESOURCES_PATH "/overlappingGeometry.dae" );
 			DEBUGLOG->outdent();
 
+			if ( LOAD_HEADLESS )
+			{
+				DEBUGLOG->log("Buffering objects loaded in headless mode for display");
+				DEBUGLOG->indent();
+					m_resourceManager.setHeadless( false );
+					m_resourceManager.uploadModels();
+					m_resourceManager.uploadTextures();
+					m_resourceManager.setKeepMeshDataForUpload( false );
+				DEBUGLOG->outdent();
+			}
+
 		DEBUGLOG->log("Loading some objects complete");
 		DEBUGLOG->outdent();
 
@@ -329,7 +465,11 @@ class UniformVoxelGridApp : public Application
 
 			DEBUGLOG->log("Creating grid overlay renderpasses");
 			DEBUGLOG->indent();
-				Shader* gridPersp= new Shader(SHADERS_PATH "/grid/simpleVertex.vert", SHADERS_PATH "/grid/simpleColor.frag");
+				// display of voxelization results, instanced cubes need a dedicated vertex shader
+				VoxelDisplayMode displayMode = DISPLAY_INSTANCED_CUBES;
+				Shader* gridPersp= ( displayMode == DISPLAY_INSTANCED_CUBES ) ?
+						new Shader(SHADERS_PATH "/grid/instancedVertex.vert", SHADERS_PATH "/grid/simpleColor.frag") :
+						new Shader(SHADERS_PATH "/grid/simpleVertex.vert", SHADERS_PATH "/grid/simpleColor.frag");
 
 				GridRenderPass* gridPerspectiveRenderPass = new GridRenderPass(gridPersp, fbo2);	// just render on top of that other render pass
 				gridPerspectiveRenderPass->setViewport(0,0,512,512);
@@ -424,6 +564,7 @@ class UniformVoxelGridApp : public Application
 				gridCellRenderPasses.push_back( gridPerspectiveRenderPass );
 				// create voxelizer
 				CPUVoxelizer* voxelizer = new CPUVoxelizer(axisAlignedVoxelGrid, scene, &m_resourceManager, objects, voxelGridNode, gridCellRenderPasses);
+				voxelizer->setDisplayMode( displayMode );
 
 				// configure display of cells
 				m_resourceManager.getCube()->getMaterial()->setAttribute("uniformRed", 0.5f);
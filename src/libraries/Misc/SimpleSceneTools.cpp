@@ -5,6 +5,8 @@
 
 #include <Misc/RotatingNode.h>
 
+#include <Resources/AssetLoader.h>
+
 #include <glm/gtc/matrix_transform.hpp>
 
 RenderableNode* SimpleScene::loadObject( std::string object, Application* app )
@@ -28,6 +30,43 @@ RenderableNode* SimpleScene::loadObject( std::string object, Application* app )
 
 }
 
+std::vector< RenderableNode* > SimpleScene::loadObjects( const std::vector< std::string >& objects, Application* app )
+{
+	AssetLoader assetLoader( &app->getResourceManager() );
+	std::vector< int > handles;
+	for ( unsigned int i = 0; i < objects.size(); i++ )
+	{
+		handles.push_back( assetLoader.requestScene( RESOURCES_PATH + objects[i] ) );
+	}
+
+	DEBUGLOG->log("Loading files : ", (int) objects.size());
+	DEBUGLOG->indent();
+		assetLoader.process();
+		assetLoader.finalize();
+	DEBUGLOG->outdent();
+
+	std::vector< RenderableNode* > objectNodes;
+	for ( unsigned int i = 0; i < objects.size(); i++ )
+	{
+		const std::vector< Object* >& loadedObject = assetLoader.getObjects( handles[i] );
+
+		if ( app->getSceneManager().getActiveScene() != 0 )
+		{
+			app->getSceneManager().getActiveScene()->addObjects( loadedObject );
+		}
+
+		DEBUGLOG->log("Creating renderable node for " + objects[i]);
+		RenderableNode* objectNode = new RenderableNode( );
+		if ( !loadedObject.empty() )
+		{
+			objectNode->setObject( loadedObject[0] );
+		}
+		objectNodes.push_back( objectNode );
+	}
+
+	return objectNodes;
+}
+
 RenderableNode* SimpleScene::loadTestRoomObject( Application* app)
 {
 	DEBUGLOG->log("Loading test room dae file");
@@ -13,6 +13,9 @@ namespace SimpleScene
 	// loads an object, adds it to the scene and returns a node which can be added to the scenegraph
 	RenderableNode* loadObject( std::string object, Application* app);
 
+	// loads several objects at once, decoding their textures in parallel, adds them to the scene and returns a node per file
+	std::vector< RenderableNode* > loadObjects( const std::vector< std::string >& objects, Application* app);
+
 	RenderableNode* loadTestRoomObject( Application* app );
 
 	RenderableNode* loadOverlappingGeometry( Application* app );
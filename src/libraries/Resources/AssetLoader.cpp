@@ -0,0 +1,265 @@
+#include "Resources/AssetLoader.h"
+
+#include "Utility/DebugLog.h"
+
+AssetLoader::AssetLoader(ResourceManager* resourceManager)
+{
+	p_resourceManager = resourceManager;
+}
+
+AssetLoader::~AssetLoader()
+{
+	for ( unsigned int i = 0; i < m_textures.size(); i++ )
+	{
+		TextureTools::freeTextureData( m_textures[i].m_data );
+	}
+}
+
+int AssetLoader::requestScene(std::string path)
+{
+	SceneRequest request;
+	request.m_path = path;
+	request.m_directory = AssimpTools::getDirectoryPath( path );
+	request.m_processed = false;
+	request.m_finalized = false;
+	request.m_failed = false;
+
+	m_scenes.push_back( request );
+	return (int) m_scenes.size() - 1;
+}
+
+int AssetLoader::requestTexture(std::string file, std::string directory)
+{
+	for ( unsigned int i = 0; i < m_textures.size(); i++ )
+	{
+		if ( m_textures[i].m_file == file )
+		{
+			return (int) i;
+		}
+	}
+
+	TextureRequest request;
+	request.m_file = file;
+	request.m_directory = directory;
+	request.p_texture = 0;
+	request.m_processed = false;
+	request.m_finalized = false;
+	request.m_failed = false;
+
+	// adopt a texture the resource manager has loaded before, one referenced in headless mode is still decoded and buffered into it
+	std::map< std::string, Texture* >::const_iterator it = p_resourceManager->getLoadedTextures().find( file );
+	if ( it != p_resourceManager->getLoadedTextures().end() )
+	{
+		request.p_texture = (*it).second;
+		if ( p_resourceManager->isHeadless() || !p_resourceManager->isTexturePending( file ) )
+		{
+			request.m_processed = true;
+			request.m_finalized = true;
+		}
+	}
+
+	m_textures.push_back( request );
+	return (int) m_textures.size() - 1;
+}
+
+void AssetLoader::process()
+{
+	// cooked files of all pending scene files, rejected ones are logged
+	std::vector< int > imports;
+	for ( unsigned int i = 0; i < m_scenes.size(); i++ )
+	{
+		SceneRequest& scene = m_scenes[i];
+		if ( scene.m_processed )
+		{
+			continue;
+		}
+
+		DEBUGLOG->log("Loading file " + scene.m_path);
+		DEBUGLOG->indent();
+		if ( !p_resourceManager->loadCookedMeshData( scene.m_path, scene.m_meshes ) )
+		{
+			imports.push_back( (int) i );
+		}
+		DEBUGLOG->outdent();
+	}
+
+	// import the remaining scene files, every file is imported by a single thread
+	// nothing is logged inside the parallel loop, the outcomes are logged in order of the requests afterwards
+	int numImports = (int) imports.size();
+	std::vector< ResourceManager::MeshImport > results( numImports );
+
+	#pragma omp parallel for schedule(dynamic)
+	for ( int i = 0; i < numImports; i++ )
+	{
+		SceneRequest& scene = m_scenes[ imports[i] ];
+		p_resourceManager->importMeshData( scene.m_path, scene.m_meshes, results[i] );
+	}
+
+	for ( int i = 0; i < numImports; i++ )
+	{
+		SceneRequest& scene = m_scenes[ imports[i] ];
+		DEBUGLOG->log("Importing file " + scene.m_path);
+		DEBUGLOG->indent();
+			scene.m_failed = !p_resourceManager->finishMeshImport( scene.m_path, scene.m_meshes, results[i] );
+		DEBUGLOG->outdent();
+	}
+
+	// textures referenced by the materials
+	for ( unsigned int i = 0; i < m_scenes.size(); i++ )
+	{
+		SceneRequest& scene = m_scenes[i];
+		if ( scene.m_processed )
+		{
+			continue;
+		}
+		scene.m_processed = true;
+
+		for ( unsigned int m = 0; m < scene.m_meshes.size(); m++ )
+		{
+			if ( !scene.m_meshes[m].m_diffuseTexture.empty() )
+			{
+				requestTexture( scene.m_meshes[m].m_diffuseTexture, scene.m_directory );
+			}
+			if ( !scene.m_meshes[m].m_normalTexture.empty() )
+			{
+				requestTexture( scene.m_meshes[m].m_normalTexture, scene.m_directory );
+			}
+		}
+	}
+
+	// decode all pending textures, every file is decoded by a single thread
+	// in headless mode textures are only referenced, so there is nothing to decode
+	int numTextures = (int) m_textures.size();
+	bool decode = !p_resourceManager->isHeadless();
+
+	#pragma omp parallel for schedule(dynamic)
+	for ( int i = 0; i < numTextures; i++ )
+	{
+		TextureRequest& texture = m_textures[i];
+		if ( texture.m_processed )
+		{
+			continue;
+		}
+		texture.m_failed = decode && !TextureTools::decodeTexture( texture.m_directory + texture.m_file, texture.m_data );
+		texture.m_processed = true;
+	}
+
+	for ( int i = 0; i < numTextures; i++ )
+	{
+		if ( m_textures[i].m_failed && !m_textures[i].m_finalized )
+		{
+			DEBUGLOG->log("ERROR : ASSET LOADER : Unable to open image " + m_textures[i].m_file);
+		}
+	}
+}
+
+int AssetLoader::finalize(int maxUploads)
+{
+	int numUploads = 0;
+	int numRemaining = 0;
+
+	// textures first, so materials find them
+	for ( unsigned int i = 0; i < m_textures.size(); i++ )
+	{
+		TextureRequest& texture = m_textures[i];
+		if ( !texture.m_processed || texture.m_finalized )
+		{
+			continue;
+		}
+		if ( maxUploads > 0 && numUploads >= maxUploads )
+		{
+			numRemaining++;
+			continue;
+		}
+
+		// failed textures are left to the resource manager, which reports them once they are referenced
+		if ( p_resourceManager->isHeadless() )
+		{
+			texture.p_texture = p_resourceManager->loadTexture( texture.m_file, texture.m_directory );
+		}
+		else if ( !texture.m_failed )
+		{
+			if ( !texture.p_texture )
+			{
+				texture.p_texture = new Texture( texture.m_file );
+			}
+			texture.p_texture->setTextureHandle( TextureTools::createTexture( texture.m_data ) );
+			TextureTools::freeTextureData( texture.m_data );
+			p_resourceManager->addTexture( texture.m_file, texture.p_texture );
+			numUploads++;
+		}
+		texture.m_finalized = true;
+	}
+
+	for ( unsigned int i = 0; i < m_scenes.size(); i++ )
+	{
+		SceneRequest& scene = m_scenes[i];
+		if ( !scene.m_processed || scene.m_finalized )
+		{
+			continue;
+		}
+
+		while ( scene.m_objects.size() < scene.m_meshes.size() && ( maxUploads <= 0 || numUploads < maxUploads ) )
+		{
+			scene.m_objects.push_back( p_resourceManager->createObject( scene.m_meshes[ scene.m_objects.size() ], scene.m_directory ) );
+			numUploads++;
+		}
+
+		if ( scene.m_objects.size() == scene.m_meshes.size() )
+		{
+			// the resource manager keeps its own copy of the CPU side mesh data
+			scene.m_meshes.clear();
+			scene.m_finalized = true;
+		}
+		else
+		{
+			numRemaining += (int) ( scene.m_meshes.size() - scene.m_objects.size() );
+		}
+	}
+
+	return numRemaining;
+}
+
+bool AssetLoader::isFinished() const
+{
+	for ( unsigned int i = 0; i < m_textures.size(); i++ )
+	{
+		if ( !m_textures[i].m_finalized )
+		{
+			return false;
+		}
+	}
+	for ( unsigned int i = 0; i < m_scenes.size(); i++ )
+	{
+		if ( !m_scenes[i].m_finalized )
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+bool AssetLoader::isSceneReady(int handle) const
+{
+	return handle >= 0 && handle < (int) m_scenes.size() && m_scenes[handle].m_finalized;
+}
+
+const std::vector< Object* >& AssetLoader::getObjects(int handle) const
+{
+	static const std::vector< Object* > noObjects;
+
+	if ( !isSceneReady( handle ) )
+	{
+		return noObjects;
+	}
+	return m_scenes[handle].m_objects;
+}
+
+Texture* AssetLoader::getTexture(int handle) const
+{
+	if ( handle < 0 || handle >= (int) m_textures.size() )
+	{
+		return 0;
+	}
+	return m_textures[handle].p_texture;
+}
@@ -0,0 +1,88 @@
+#ifndef ASSETLOADER_H
+#define ASSETLOADER_H
+
+#include "Resources/ResourceManager.h"
+
+#include <string>
+#include <vector>
+
+/**
+ * This class loads a batch of scene files and textures in two stages
+ * - process() builds the CPU side mesh data of all requested scene files and decodes all requested and referenced textures,
+ *   scene files without a valid cooked file are imported in parallel, textures are decoded in parallel
+ * - finalize() buffers decoded textures and meshes on the thread owning the GL context, optionally only a few per call,
+ *   so uploads can be spread over several frames
+ * - requests are identified by handles, which stay valid for the lifetime of the loader
+ * - if the resource manager is headless, textures are not decoded and finalize() does not make any GL calls
+ */
+class AssetLoader
+{
+protected:
+	struct SceneRequest
+	{
+		std::string m_path;
+		std::string m_directory;
+		std::vector< MeshData > m_meshes;
+		std::vector< Object* > m_objects;
+		bool m_processed;
+		bool m_finalized;
+		bool m_failed;
+	};
+
+	struct TextureRequest
+	{
+		std::string m_file;
+		std::string m_directory;
+		TextureTools::TextureData m_data;
+		Texture* p_texture;
+		bool m_processed;
+		bool m_finalized;
+		bool m_failed;
+	};
+
+	ResourceManager* p_resourceManager;
+
+	std::vector< SceneRequest > m_scenes;
+	std::vector< TextureRequest > m_textures;
+public:
+	AssetLoader( ResourceManager* resourceManager );
+	virtual ~AssetLoader();
+
+	/**
+	 * request the objects of a scene file, the textures referenced by its materials are requested by process()
+	 * @return handle of the request
+	 */
+	int requestScene( std::string path );
+
+	/**
+	 * request a texture, a file which has been requested or loaded by the resource manager before is not decoded again,
+	 * unless it has only been referenced in headless mode
+	 * @param file name, used as key by the resource manager
+	 * @param directory of the file
+	 * @return handle of the request
+	 */
+	int requestTexture( std::string file, std::string directory );
+
+	/**
+	 * CPU stage : load the mesh data of all pending scene files, importing them in parallel, then decode all pending textures in parallel
+	 */
+	void process();
+
+	/**
+	 * GL stage : buffer processed textures, then construct the objects of processed scene files
+	 * @param maxUploads amount of textures and meshes to be buffered by this call, 0 to buffer everything
+	 * @return amount of textures and meshes left to be buffered
+	 */
+	int finalize( int maxUploads = 0 );
+
+	/**
+	 * @return true if every request has been processed and finalized
+	 */
+	bool isFinished() const;
+
+	bool isSceneReady( int handle ) const;
+	const std::vector< Object* >& getObjects( int handle ) const;
+	Texture* getTexture( int handle ) const;
+};
+
+#endif
@@ -0,0 +1,79 @@
+#include "InstancedObject.h"
+
+#include "Utility/DebugLog.h"
+#include "Rendering/RenderState.h"
+
+InstancedObject::InstancedObject( Model* model, Material* material)
+	: Object( model, material )
+{
+	m_vertexArrayHandle = 0;
+	m_instanceBufferHandle = 0;
+	m_numInstances = 0;
+}
+
+InstancedObject::~InstancedObject()
+{
+	if ( m_instanceBufferHandle )
+	{
+		glDeleteBuffers( 1, &m_instanceBufferHandle );
+	}
+	if ( m_vertexArrayHandle )
+	{
+		glDeleteVertexArrays( 1, &m_vertexArrayHandle );
+	}
+}
+
+void InstancedObject::createVertexArrayObject()
+{
+	glGenVertexArrays( 1, &m_vertexArrayHandle );
+	glBindVertexArray( m_vertexArrayHandle );
+
+	glBindBuffer( GL_ELEMENT_ARRAY_BUFFER, m_model->getIndexBufferHandle() );
+
+	glBindBuffer( GL_ARRAY_BUFFER, m_model->getPositionBufferHandle() );
+	glEnableVertexAttribArray( 0 );
+	glVertexAttribPointer( 0, 3, GL_FLOAT, GL_FALSE, 0, 0 );
+
+	glGenBuffers( 1, &m_instanceBufferHandle );
+	glBindBuffer( GL_ARRAY_BUFFER, m_instanceBufferHandle );
+	glEnableVertexAttribArray( 4 );
+	glVertexAttribPointer( 4, 4, GL_FLOAT, GL_FALSE, 0, 0 );
+	glVertexAttribDivisor( 4, 1 );
+
+	glBindVertexArray( 0 );
+}
+
+void InstancedObject::setInstances(const std::vector<glm::vec4>& instances)
+{
+	if ( !m_model )
+	{
+		DEBUGLOG->log("ERROR : INSTANCED OBJECT : no model set");
+		return;
+	}
+
+	if ( m_vertexArrayHandle == 0 )
+	{
+		createVertexArrayObject();
+	}
+
+	m_numInstances = (int) instances.size();
+
+	glBindBuffer( GL_ARRAY_BUFFER, m_instanceBufferHandle );
+	glBufferData( GL_ARRAY_BUFFER, sizeof( glm::vec4 ) * instances.size(), ( instances.empty() ) ? 0 : &instances[0], GL_STATIC_DRAW );
+	glBindBuffer( GL_ARRAY_BUFFER, 0 );
+}
+
+int InstancedObject::getNumInstances() const {
+	return m_numInstances;
+}
+
+void InstancedObject::render()
+{
+	if ( !m_model || m_numInstances == 0 )
+	{
+		return;
+	}
+
+	RenderState::getInstance()->bindVertexArrayObjectIfDifferent( m_vertexArrayHandle );
+	glDrawElementsInstanced( m_renderMode, m_model->getNumIndices(), GL_UNSIGNED_INT, 0, m_numInstances );
+}
@@ -0,0 +1,41 @@
+#ifndef INSTANCEDOBJECT_H
+#define INSTANCEDOBJECT_H
+
+#include <Resources/Object.h>
+
+#include <glm/glm.hpp>
+#include <vector>
+
+/**
+ * an object which draws its model once per instance with a single glDrawElementsInstanced call
+ * every instance is a vec4 bound to attribute location 4 with a divisor of 1, its meaning is up to the shader
+ * the model positions ( vec3, attribute location 0 ) and indices are referenced through a vertex array object of its own,
+ * so the vertex array object of the model stays untouched
+ */
+class InstancedObject : public Object
+{
+protected:
+	GLuint m_vertexArrayHandle;
+	GLuint m_instanceBufferHandle;
+	int m_numInstances;
+
+	/**
+	 * create the vertex array object referencing the model buffers and the instance buffer
+	 */
+	void createVertexArrayObject();
+public:
+	InstancedObject( Model* model = 0, Material* material = 0 );
+	virtual ~InstancedObject();
+
+	/**
+	 * upload the instance attributes, replacing previous ones
+	 * @param instances one vec4 per instance
+	 */
+	void setInstances( const std::vector< glm::vec4 >& instances );
+
+	int getNumInstances() const;
+
+	virtual void render();
+};
+
+#endif
@@ -0,0 +1,28 @@
+#ifndef MESHRECORD_H
+#define MESHRECORD_H
+
+#include <glm/glm.hpp>
+#include <vector>
+
+/**
+ * CPU side geometry of a loaded model in flat arrays
+ * - vertex positions in model space are stored as separate x, y and z arrays
+ * - the indices of all faces are packed into a single array, face f uses the indices m_faceOffsets[f] .. m_faceOffsets[f + 1] - 1
+ */
+struct MeshRecord
+{
+	std::vector< float > m_x;
+	std::vector< float > m_y;
+	std::vector< float > m_z;
+	std::vector< glm::vec2 > m_uvs;				// one per vertex
+	std::vector< unsigned int > m_indices;
+	std::vector< unsigned int > m_faceOffsets;	// amount of faces + 1 entries
+
+	inline int getNumVertices() const { return (int) m_x.size(); }
+	inline int getNumFaces() const { return m_faceOffsets.empty() ? 0 : (int) m_faceOffsets.size() - 1; }
+	inline int getFaceSize( int face ) const { return (int) ( m_faceOffsets[ face + 1 ] - m_faceOffsets[ face ] ); }
+	inline const unsigned int* getFace( int face ) const { return m_indices.empty() ? 0 : &m_indices[0] + m_faceOffsets[ face ]; }
+	inline glm::vec3 getPosition( unsigned int vertex ) const { return glm::vec3( m_x[ vertex ], m_y[ vertex ], m_z[ vertex ] ); }
+};
+
+#endif
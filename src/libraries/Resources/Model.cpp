@@ -13,6 +13,7 @@ Model::Model()
 	m_numFaces = 0;
 	m_path = "";
 	m_numIndices = 0;
+	m_meshHandle = -1;
 }
 
 Model::~Model()
@@ -106,3 +107,11 @@ void Model::setTangentBufferHandle(GLuint tangentBufferHandle) {
 void Model::setVaoHandle(GLuint vaoHandle) {
 	m_VAOHandle = vaoHandle;
 }
+
+int Model::getMeshHandle() const {
+	return m_meshHandle;
+}
+
+void Model::setMeshHandle(int meshHandle) {
+	m_meshHandle = meshHandle;
+}
@@ -19,6 +19,8 @@ private:
 	int m_numFaces;
 	int m_numVertices;
 	int m_numIndices;
+
+	int m_meshHandle;	// index of the CPU side geometry in the resource manager, -1 if there is none
 public:
 	Model();
 	virtual ~Model();
@@ -45,6 +47,8 @@ public:
 	void setVaoHandle(GLuint vaoHandle);
 	GLuint getTangentBufferHandle() const;
 	void setTangentBufferHandle(GLuint tangentBufferHandle);
+	int getMeshHandle() const;
+	void setMeshHandle(int meshHandle);
 };
 
 #endif
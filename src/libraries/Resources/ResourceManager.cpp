@@ -1,9 +1,14 @@
 #include "ResourceManager.h"
 
 #include "Utility/DebugLog.h"
+#include "Utility/MeshOptimizer.h"
 
 ResourceManager::ResourceManager()
 {
+	m_useMeshCache = true;
+	m_headless = false;
+	m_optimizeMeshes = false;
+	m_keepMeshDataForUpload = false;
 	m_screenFillingTriangle = 0;
 	m_cube = 0;
 	m_quad = 0;
@@ -25,51 +30,179 @@ std::vector<Object* > ResourceManager::loadObjectsFromFile(std::string path)
 		return loadedObjects;
 	}
 	else{
-		DEBUGLOG->log("Importing scene");
-		Assimp::Importer importer;
-		const aiScene* scene = AssimpTools::loadScene(path, importer);
-
-		if (!scene)
- 		{
- 			return loadedObjects;
+		std::vector< MeshData > meshes;
+		if ( !loadMeshData( path, meshes ) )
+		{
+			return loadedObjects;
 		}
 
-		DEBUGLOG->log("Extracting assimp meshes");
-
-		std::vector< const aiMesh* > meshes = AssimpTools::extractMeshesFromScene( scene);
-
-		DEBUGLOG->log("Constructing objects from found meshes : ", meshes.size());
+		DEBUGLOG->log("Constructing objects from found meshes : ", (int) meshes.size());
 		DEBUGLOG->indent();
+		std::string directory = AssimpTools::getDirectoryPath( path );
 		for (unsigned int i = 0; i < meshes.size(); i++)
 		{
-			DEBUGLOG->log(std::string("Constructing model    from mesh" ));
-			Model* model = loadModel( scene, meshes[i] );
-			DEBUGLOG->log(std::string("Constructing material from mesh" ));
-		
-			std::string directory = AssimpTools::getDirectoryPath( path );
-			Material* mat= loadMaterial(scene, meshes[i], directory);
-
-			Object* object= new Object(model, mat);
-		
-			loadedObjects.push_back(object);
-			DEBUGLOG->log(std::string("Constructing object complete."));
+			loadedObjects.push_back( createObject( meshes[i], directory ) );
 		}
 
 		DEBUGLOG->outdent();
 		DEBUGLOG->log("Importing scene complete");
-		
+
 		return loadedObjects;
 	}
 }
 
+bool ResourceManager::loadMeshData(std::string path, std::vector< MeshData >& meshes)
+{
+	if ( loadCookedMeshData( path, meshes ) )
+	{
+		return true;
+	}
+
+	DEBUGLOG->log("Importing scene");
+	MeshImport result;
+	importMeshData( path, meshes, result );
+	return finishMeshImport( path, meshes, result );
+}
+
+bool ResourceManager::loadCookedMeshData(std::string path, std::vector< MeshData >& meshes)
+{
+	std::string cachePath = MeshCache::getCacheFileName( path );
+	unsigned int cacheFlags = ( m_optimizeMeshes ) ? MeshCache::OPTIMIZED : 0;
+
+	if ( m_useMeshCache && MeshCache::load( cachePath, path, meshes, cacheFlags, AssimpTools::getImportFlags() ) )
+	{
+		DEBUGLOG->log("Loaded cooked meshes : " + cachePath);
+		return true;
+	}
+	return false;
+}
+
+bool ResourceManager::importMeshData(std::string path, std::vector< MeshData >& meshes, MeshImport& result) const
+{
+	// record the files read besides the scene file, so the cooked file is outdated once one of them changes
+	Assimp::Importer importer;
+	AssimpTools::RecordingIOSystem* ioSystem = new AssimpTools::RecordingIOSystem();
+	importer.SetIOHandler( ioSystem );
+	const aiScene* scene = importer.ReadFile( path, AssimpTools::getImportFlags() );
+
+	if (!scene)
+	{
+		result.m_error = importer.GetErrorString();
+		return false;
+	}
+	result.m_dependencies = ioSystem->getOpenedFiles( path );
+
+	std::vector< const aiMesh* > sceneMeshes = AssimpTools::extractMeshesFromScene( scene);
+	meshes.resize( sceneMeshes.size() );
+
+	int numMeshes = (int) sceneMeshes.size();
+	#pragma omp parallel for schedule(dynamic)
+	for (int i = 0; i < numMeshes; i++)
+	{
+		AssimpTools::extractMeshData( scene, sceneMeshes[i], meshes[i] );
+	}
+
+	if ( m_optimizeMeshes )
+	{
+		float acmrBefore = 0.0f;
+		float acmrAfter = 0.0f;
+		int numOptimized = 0;
+
+		#pragma omp parallel for schedule(dynamic)
+		for (int i = 0; i < numMeshes; i++)
+		{
+			float before = MeshOptimizer::computeACMR( meshes[i] );
+			if ( MeshOptimizer::optimize( meshes[i] ) )
+			{
+				float after = MeshOptimizer::computeACMR( meshes[i] );
+				#pragma omp critical
+				{
+					acmrBefore += before;
+					acmrAfter += after;
+					numOptimized++;
+				}
+			}
+		}
+
+		result.m_numOptimized = numOptimized;
+		result.m_acmrBefore = acmrBefore;
+		result.m_acmrAfter = acmrAfter;
+	}
+
+	result.m_imported = true;
+	return true;
+}
+
+bool ResourceManager::finishMeshImport(std::string path, const std::vector< MeshData >& meshes, const MeshImport& result)
+{
+	if ( !result.m_imported )
+	{
+		DEBUGLOG->log("ERROR : import of scene failed : " + result.m_error);
+		return false;
+	}
+
+	DEBUGLOG->log("Extracted assimp meshes : ", (int) meshes.size());
+
+	if ( m_optimizeMeshes )
+	{
+		DEBUGLOG->log("Optimized triangle meshes : ", result.m_numOptimized);
+		if ( result.m_numOptimized > 0 )
+		{
+			DEBUGLOG->indent();
+			DEBUGLOG->log("average ACMR before : ", result.m_acmrBefore / (float) result.m_numOptimized);
+			DEBUGLOG->log("average ACMR after  : ", result.m_acmrAfter / (float) result.m_numOptimized);
+			DEBUGLOG->outdent();
+		}
+	}
+
+	std::string cachePath = MeshCache::getCacheFileName( path );
+	unsigned int cacheFlags = ( m_optimizeMeshes ) ? MeshCache::OPTIMIZED : 0;
+
+	if ( m_useMeshCache && MeshCache::write( cachePath, path, meshes, cacheFlags, AssimpTools::getImportFlags(), result.m_dependencies ) )
+	{
+		DEBUGLOG->log("Cooked meshes : " + cachePath);
+	}
+	return true;
+}
+
+Object* ResourceManager::createObject(const MeshData& meshData, std::string directory)
+{
+	DEBUGLOG->log(std::string("Constructing model    from mesh" ));
+	Model* model = loadModel( meshData );
+	DEBUGLOG->log(std::string("Constructing material from mesh" ));
+	Material* mat= loadMaterial( meshData, directory );
+
+	Object* object= new Object(model, mat);
+	DEBUGLOG->log(std::string("Constructing object complete."));
+
+	return object;
+}
+
 Texture* ResourceManager::loadTexture(std::string file, std::string directory)
 {
-	if ( checkTexture(file) )
+	if ( checkTexture(file) && !m_headless && isTexturePending(file) )
+	{
+		// texture has been referenced in headless mode and is buffered now
+		DEBUGLOG->log("File has been referenced in headless mode and will be buffered: " + file);
+		Texture* texture = m_loadedTextures[file];
+		texture->setTextureHandle( TextureTools::loadTexture( m_pendingTextures[file] + file ) );
+		m_pendingTextures.erase(file);
+		return texture;
+	}
+	else if ( checkTexture(file) )
 	{
 		// texture exists already
 		DEBUGLOG->log("File has already been loaded: " + file);
 		return m_loadedTextures[file];
 	}
+	else if ( m_headless ){
+		// texture is only referenced by its file name
+		DEBUGLOG->log("File will NOT be buffered in headless mode: " + file);
+		Texture* texture = new Texture(file);
+		m_loadedTextures[file] = texture;
+		m_pendingTextures[file] = directory;
+		return texture;
+	}
 	else{
 		// texture does not yet exist and must be buffered
 		DEBUGLOG->log("File has NOT been loaded and will be buffered: " + file);
@@ -102,33 +235,84 @@ Material* ResourceManager::loadMaterial(const aiScene* scene, const aiMesh* mesh
 	return mat;
 }
 
-/*save the vertex list of a mesh in the map as a corresponding vector to the model*/
-void ResourceManager::saveVertexList(Model* model, const aiMesh* mesh)
+Material* ResourceManager::loadMaterial(const MeshData& meshData, std::string directory)
 {
-	for (unsigned int i = 0; i < mesh->mNumVertices; i++)
-	{
-		m_loadedMeshes[model].push_back(glm::vec4 ( mesh->mVertices[i].x, mesh->mVertices[i].y, mesh->mVertices[i].z, 1.0f));
+	Material* mat = new Material();
+
+	if( !meshData.m_diffuseTexture.empty() ){
+		Texture* diffuseTex = loadTexture( meshData.m_diffuseTexture, directory );
+		mat->setTexture( "diffuseTexture", diffuseTex );
 	}
+
+	if( !meshData.m_normalTexture.empty() ){
+		Texture* normalTex = loadTexture( meshData.m_normalTexture, directory );
+		mat->setTexture( "normalTexture", normalTex );
+	}
+
+	return mat;
 }
 
-/*save the vertex list of a mesh in the map as a corresponding vector to the model*/
-void ResourceManager::saveFacesList(Model* model, const aiMesh* mesh)
+/*save the vertices, faces and uv coordinates of a mesh as a new record, generating the uv coordinates the same way as the buffered ones if missing*/
+void ResourceManager::saveMeshRecord(Model* model, const aiMesh* mesh)
 {
-	// for every face
-	for (unsigned int i = 0; i < mesh->mNumFaces; i++)
+	model->setMeshHandle( (int) m_meshRecords.size() );
+	m_meshRecords.push_back( MeshRecord() );
+	MeshRecord& record = m_meshRecords.back();
+
+	float uv_steps = 1.0f / mesh->mNumVertices;
+	record.m_x.resize( mesh->mNumVertices );
+	record.m_y.resize( mesh->mNumVertices );
+	record.m_z.resize( mesh->mNumVertices );
+	record.m_uvs.resize( mesh->mNumVertices );
+	for (unsigned int i = 0; i < mesh->mNumVertices; i++)
 	{
-		// current Face
-		aiFace currentFace = mesh->mFaces[i];
+		record.m_x[i] = mesh->mVertices[i].x;
+		record.m_y[i] = mesh->mVertices[i].y;
+		record.m_z[i] = mesh->mVertices[i].z;
+		record.m_uvs[i] = ( mesh->HasTextureCoords(0) ) ? glm::vec2( mesh->mTextureCoords[0][i].x, mesh->mTextureCoords[0][i].y ) : glm::vec2( i * uv_steps, i * uv_steps );
+	}
 
-		// read face vertices indices
-		std::vector< unsigned int > faceIndices;
-		for (unsigned int k = 0; k < currentFace.mNumIndices; k++)
+	record.m_faceOffsets.resize( mesh->mNumFaces + 1 );
+	record.m_faceOffsets[0] = 0;
+	for (unsigned int i = 0; i < mesh->mNumFaces; i++)
+	{
+		record.m_faceOffsets[ i + 1 ] = record.m_faceOffsets[i] + mesh->mFaces[i].mNumIndices;
+	}
+	record.m_indices.resize( record.m_faceOffsets.back() );
+	for (unsigned int i = 0; i < mesh->mNumFaces; i++)
+	{
+		for (unsigned int k = 0; k < mesh->mFaces[i].mNumIndices; k++)
 		{
-			faceIndices.push_back( currentFace.mIndices[k] );
+			record.m_indices[ record.m_faceOffsets[i] + k ] = mesh->mFaces[i].mIndices[k];
 		}
+	}
+}
 
-		// push back a vector of indices for this face
-		m_loadedMeshesFaces[model].push_back( faceIndices );
+/*save the vertices, faces and uv coordinates of extracted or cached mesh data as a new record*/
+void ResourceManager::saveMeshRecord(Model* model, const MeshData& meshData)
+{
+	model->setMeshHandle( (int) m_meshRecords.size() );
+	m_meshRecords.push_back( MeshRecord() );
+	MeshRecord& record = m_meshRecords.back();
+
+	unsigned int numVertices = (unsigned int) meshData.m_positions.size();
+	record.m_x.resize( numVertices );
+	record.m_y.resize( numVertices );
+	record.m_z.resize( numVertices );
+	for (unsigned int i = 0; i < numVertices; i++)
+	{
+		record.m_x[i] = meshData.m_positions[i].x;
+		record.m_y[i] = meshData.m_positions[i].y;
+		record.m_z[i] = meshData.m_positions[i].z;
+	}
+	record.m_uvs = meshData.m_uvs;
+	record.m_indices = meshData.m_indices;
+
+	record.m_faceOffsets.resize( meshData.m_faceSizes.size() + 1 );
+	record.m_faceOffsets[0] = 0;
+	for (unsigned int i = 0; i < meshData.m_faceSizes.size(); i++)
+	{
+		record.m_faceOffsets[ i + 1 ] = record.m_faceOffsets[i] + meshData.m_faceSizes[i];
 	}
 }
 
@@ -147,42 +331,140 @@ Model* ResourceManager::loadModel( const aiScene* scene, const aiMesh* mesh )
 		Model* model = AssimpTools::createModelFromMesh( mesh );
 		m_loadedModels[mesh] = model;
 
-		saveVertexList ( model, mesh );
-		saveFacesList	(model, mesh );
+		saveMeshRecord( model, mesh );
 
 		DEBUGLOG->outdent();
 		return model;
 //	}
 }
 
-const std::vector<glm::vec4>& ResourceManager::getAssimpMeshForModel(Model* model)
+/* load a single model object from extracted or cached mesh data*/
+Model* ResourceManager::loadModel( const MeshData& meshData )
 {
-	if( m_loadedMeshes.find(model) != m_loadedMeshes.end())
-		{
-			return m_loadedMeshes[model];
-		}
-	else{
-		return std::vector<glm::vec4>();
+	DEBUGLOG->log( ( m_headless ) ? "Mesh will NOT be buffered in headless mode... " : "Mesh will be buffered... " );
+	Model* model = AssimpTools::createModelFromMeshData( meshData, !m_headless );
+
+	saveMeshRecord( model, meshData );
+	if ( m_headless && m_keepMeshDataForUpload )
+	{
+		// the record lacks normals and tangents, so keep everything needed to buffer the model later on
+		m_pendingModels[model] = meshData;
+	}
+
+	return model;
+}
+
+bool ResourceManager::uploadModel(Model* model)
+{
+	if ( m_headless )
+	{
+		DEBUGLOG->log("ERROR : RESOURCE MANAGER : models can not be buffered in headless mode");
+		return false;
+	}
+
+	std::map< Model*, MeshData >::iterator it = m_pendingModels.find( model );
+	if ( it == m_pendingModels.end() )
+	{
+		DEBUGLOG->log("ERROR : RESOURCE MANAGER : mesh data of model was not kept for upload or model has been buffered before");
+		return false;
+	}
+	AssimpTools::uploadMeshData( model, (*it).second );
+	m_pendingModels.erase( it );
+	return true;
+}
+
+int ResourceManager::uploadModels()
+{
+	if ( m_headless )
+	{
+		DEBUGLOG->log("ERROR : RESOURCE MANAGER : models can not be buffered in headless mode");
+		return 0;
 	}
+
+	int numUploads = 0;
+	for ( std::map< Model*, MeshData >::iterator it = m_pendingModels.begin(); it != m_pendingModels.end(); ++it )
+	{
+		AssimpTools::uploadMeshData( (*it).first, (*it).second );
+		numUploads++;
+	}
+	m_pendingModels.clear();
+
+	DEBUGLOG->log("Buffered models referenced in headless mode : ", numUploads);
+	return numUploads;
 }
 
-const std::vector<std::vector< unsigned int > >& ResourceManager::getAssimpMeshFacesForModel(Model* model)
+int ResourceManager::uploadTextures()
 {
-	if( m_loadedMeshesFaces.find(model) != m_loadedMeshesFaces.end())
+	if ( m_headless )
+	{
+		DEBUGLOG->log("ERROR : RESOURCE MANAGER : textures can not be buffered in headless mode");
+		return 0;
+	}
+
+	std::vector< std::string > files;
+	std::vector< std::string > paths;
+	for ( std::map< std::string, std::string >::const_iterator it = m_pendingTextures.begin(); it != m_pendingTextures.end(); ++it )
+	{
+		files.push_back( (*it).first );
+		paths.push_back( (*it).second + (*it).first );
+	}
+
+	// every file is decoded by a single thread, buffering requires the thread owning the context
+	int numTextures = (int) files.size();
+	std::vector< TextureTools::TextureData > textureData( numTextures );
+	std::vector< int > decoded( numTextures, 0 );
+
+	#pragma omp parallel for schedule(dynamic)
+	for ( int i = 0; i < numTextures; i++ )
+	{
+		decoded[i] = TextureTools::decodeTexture( paths[i], textureData[i] ) ? 1 : 0;
+	}
+
+	int numUploads = 0;
+	for ( int i = 0; i < numTextures; i++ )
+	{
+		if ( !decoded[i] )
 		{
-			return m_loadedMeshesFaces[model];
+			DEBUGLOG->log("ERROR : RESOURCE MANAGER : Unable to open image " + files[i]);
+			continue;
 		}
-	else{
-		return std::vector< std::vector< unsigned int> >();
+		m_loadedTextures[ files[i] ]->setTextureHandle( TextureTools::createTexture( textureData[i] ) );
+		TextureTools::freeTextureData( textureData[i] );
+		numUploads++;
+	}
+	m_pendingTextures.clear();
+
+	DEBUGLOG->log("Buffered textures referenced in headless mode : ", numUploads);
+	return numUploads;
+}
+
+bool ResourceManager::isTexturePending(std::string file) const
+{
+	return m_pendingTextures.find( file ) != m_pendingTextures.end();
+}
+
+const MeshRecord& ResourceManager::getMeshRecord(const Model* model) const
+{
+	return getMeshRecord( ( model ) ? model->getMeshHandle() : -1 );
+}
+
+const MeshRecord& ResourceManager::getMeshRecord(int meshHandle) const
+{
+	static const MeshRecord noMesh;
+
+	if ( meshHandle < 0 || meshHandle >= (int) m_meshRecords.size() )
+	{
+		return noMesh;
 	}
+	return m_meshRecords[meshHandle];
 }
 
 const std::map<std::string, std::string>& ResourceManager::getLoadedFiles() const {
 	return m_loadedFiles;
 }
 
-const std::map<Model*, std::vector <glm::vec4> >& ResourceManager::getLoadedMeshes() const {
-	return m_loadedMeshes;
+const std::deque<MeshRecord>& ResourceManager::getMeshRecords() const {
+	return m_meshRecords;
 }
 
 const std::map<const aiMesh*, Model*>& ResourceManager::getLoadedModels() const {
@@ -198,6 +480,44 @@ void ResourceManager::setScreenFillingTriangle(
 	m_screenFillingTriangle = screenFillingTriangle;
 }
 
+void ResourceManager::addTexture(std::string file, Texture* texture)
+{
+	m_loadedTextures[file] = texture;
+	m_pendingTextures.erase(file);
+}
+
+bool ResourceManager::getUseMeshCache() const {
+	return m_useMeshCache;
+}
+
+void ResourceManager::setUseMeshCache(bool useMeshCache) {
+	m_useMeshCache = useMeshCache;
+}
+
+bool ResourceManager::isHeadless() const {
+	return m_headless;
+}
+
+void ResourceManager::setHeadless(bool headless) {
+	m_headless = headless;
+}
+
+bool ResourceManager::getOptimizeMeshes() const {
+	return m_optimizeMeshes;
+}
+
+void ResourceManager::setOptimizeMeshes(bool optimizeMeshes) {
+	m_optimizeMeshes = optimizeMeshes;
+}
+
+bool ResourceManager::getKeepMeshDataForUpload() const {
+	return m_keepMeshDataForUpload;
+}
+
+void ResourceManager::setKeepMeshDataForUpload(bool keepMeshDataForUpload) {
+	m_keepMeshDataForUpload = keepMeshDataForUpload;
+}
+
 void ResourceManager::deleteAll()
 {
 	//TODO delete everything
@@ -3,8 +3,10 @@
 
 #include "Resources/Object.h"
 #include "Resources/Texture.h"
+#include "Resources/MeshRecord.h"
 
 #include <string>
+#include <deque>
 #include <map>
 #include <vector>
 
@@ -15,10 +17,16 @@ class ResourceManager
 {
 protected:
 	std::map<const aiMesh*, Model* > m_loadedModels;
-	std::map<Model*, std::vector< glm::vec4 > > m_loadedMeshes;
-	std::map<Model*, std::vector< std::vector <unsigned int> > > m_loadedMeshesFaces;
+	std::deque< MeshRecord > m_meshRecords;	// CPU side geometry, indexed by the mesh handle of a model, records never move
 	std::map<std::string, Texture* > m_loadedTextures;
 	std::map<std::string, std::string > m_loadedFiles;
+	std::map<Model*, MeshData > m_pendingModels;			// mesh data of models created in headless mode while m_keepMeshDataForUpload is set, until buffered
+	std::map<std::string, std::string > m_pendingTextures;	// directory of every texture referenced in headless mode by file name, until it is buffered
+
+	bool m_useMeshCache;	// cook imported meshes into binary files in the cache directory and load them instead of importing again
+	bool m_headless;		// load meshes and materials without any GL calls, i.e. without a context
+	bool m_optimizeMeshes;	// reorder imported triangle meshes for vertex cache, vertex fetch and spatial locality
+	bool m_keepMeshDataForUpload;	// keep the mesh data of models created in headless mode, so they can be buffered later on
 
 	Renderable* m_screenFillingTriangle;
 	Object* m_cube;
@@ -28,18 +36,95 @@ public:
 	~ResourceManager();
 
 	std::vector< Object* > loadObjectsFromFile(std::string path);
+
+	/**
+	 * outcome of importMeshData, which is logged and cooked by finishMeshImport
+	 */
+	struct MeshImport
+	{
+		bool m_imported;
+		std::string m_error;						// importer error if the scene could not be imported
+		std::vector< std::string > m_dependencies;	// files read besides the scene file, e.g. material libraries
+		int m_numOptimized;
+		float m_acmrBefore;							// summed over the optimized meshes
+		float m_acmrAfter;
+
+		MeshImport() : m_imported( false ), m_numOptimized( 0 ), m_acmrBefore( 0.0f ), m_acmrAfter( 0.0f ) {}
+	};
+
+	/**
+	 * load the meshes of a scene file from its cooked file or import them, without any GL calls
+	 * same as loadCookedMeshData, then importMeshData and finishMeshImport if there is no valid cooked file
+	 * @return false if the file could not be imported
+	 */
+	bool loadMeshData(std::string path, std::vector< MeshData >& meshes);
+
+	/**
+	 * @return false if the mesh cache is disabled or the cooked file of the scene file is missing or rejected
+	 */
+	bool loadCookedMeshData(std::string path, std::vector< MeshData >& meshes);
+
+	/**
+	 * import the meshes of a scene file without any GL calls or logging, so several files may be imported in parallel
+	 * @param result to be passed to finishMeshImport
+	 * @return false if the file could not be imported
+	 */
+	bool importMeshData(std::string path, std::vector< MeshData >& meshes, MeshImport& result) const;
+
+	/**
+	 * log the outcome of importMeshData and cook the imported meshes, must not be called from several threads at once
+	 * @return false if the file could not be imported
+	 */
+	bool finishMeshImport(std::string path, const std::vector< MeshData >& meshes, const MeshImport& result);
+
+	/**
+	 * buffer a mesh and construct an object with its material, textures are loaded unless they have been before
+	 */
+	Object* createObject(const MeshData& meshData, std::string directory);
+
+	/**
+	 * GPU stage of a model created in headless mode, requires a context and headless mode to be disabled
+	 * the mesh data of the model is only kept until then if setKeepMeshDataForUpload( true ) was set when it was created
+	 * @return false if the mesh data of the model was not kept or the model has been buffered before
+	 */
+	bool uploadModel(Model* model);
+
+	/**
+	 * buffer every model created in headless mode, see uploadModel
+	 * @return amount of models buffered
+	 */
+	int uploadModels();
+
+	/**
+	 * decode the textures referenced in headless mode in parallel and buffer them, requires a context and headless mode to be disabled
+	 * loadTexture also buffers such a texture once it is loaded again without headless mode
+	 * @return amount of textures buffered
+	 */
+	int uploadTextures();
+
+	/**
+	 * @return true if the texture has been referenced in headless mode and has not been buffered yet
+	 */
+	bool isTexturePending(std::string file) const;
+
 	Model* loadModel(const aiScene* scene, const aiMesh* mesh);
+	Model* loadModel(const MeshData& meshData);
 	Material* loadMaterial(const aiScene* scene, const aiMesh* mesh, std::string directory);
+	Material* loadMaterial(const MeshData& meshData, std::string directory);
 	Texture* loadTexture(std::string file, std::string directory);
-	void saveVertexList(Model* model, const aiMesh* mesh);
-	void saveFacesList(Model* model, const aiMesh* mesh);
+	void addTexture(std::string file, Texture* texture);
+	void saveMeshRecord(Model* model, const aiMesh* mesh);
+	void saveMeshRecord(Model* model, const MeshData& meshData);
 
 	bool checkModel(const aiMesh* mesh);
 	bool checkTexture(std::string path);
 	bool checkFile(std::string file);
 
-	const std::vector<glm::vec4>& getAssimpMeshForModel(Model* model);
-	const std::vector<std::vector <unsigned int> >& getAssimpMeshFacesForModel(Model* model);
+	/**
+	 * @return CPU side geometry of a model in constant time, an empty record if the model was not loaded by this resource manager
+	 */
+	const MeshRecord& getMeshRecord(const Model* model) const;
+	const MeshRecord& getMeshRecord(int meshHandle) const;
 
 	Renderable* getScreenFillingTriangle();
 	Object* getQuad();
@@ -47,11 +132,35 @@ public:
 
 	void deleteAll();
 	const std::map<std::string, std::string>& getLoadedFiles() const;
-	const std::map<Model*, std::vector <glm::vec4> >& getLoadedMeshes() const;
+	const std::deque<MeshRecord>& getMeshRecords() const;
 	const std::map<const aiMesh*, Model*>& getLoadedModels() const;
 	const std::map<std::string, Texture*>& getLoadedTextures() const;
 
 	void setScreenFillingTriangle(Renderable* screenFillingTriangle);
+	bool getUseMeshCache() const;
+	void setUseMeshCache(bool useMeshCache);
+
+	/**
+	 * in headless mode models are not buffered and textures are not loaded, materials only reference them by file name
+	 * the CPU side geometry of every model is available through getMeshRecord as usual
+	 * after disabling headless mode, uploadTextures buffers the referenced textures and uploadModels the models whose mesh data was kept
+	 */
+	bool isHeadless() const;
+	void setHeadless(bool headless);
+
+	/**
+	 * reorder imported triangle meshes by MeshOptimizer::optimize before they are cooked
+	 * cooked files remember whether their meshes were reordered, so toggling this causes the scene files to be imported again
+	 */
+	bool getOptimizeMeshes() const;
+	void setOptimizeMeshes(bool optimizeMeshes);
+
+	/**
+	 * keep the full mesh data of models created in headless mode until uploadModel or uploadModels buffers them, off by default
+	 * the mesh records lack normals and tangents, so this roughly doubles the memory of headless models while enabled
+	 */
+	bool getKeepMeshDataForUpload() const;
+	void setKeepMeshDataForUpload(bool keepMeshDataForUpload);
 
 	Model* generateVoxelGridModel(int width, int height, int depth, float cellSize);
 };
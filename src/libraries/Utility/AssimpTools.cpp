@@ -1,5 +1,6 @@
 #include "Utility/AssimpTools.h"
 
+#include <algorithm>
 #include <iostream>
 #include <fstream>
 
@@ -23,6 +24,40 @@ namespace AssimpTools
 		return directory;
 	}
 
+	Assimp::IOStream* RecordingIOSystem::Open(const char* file, const char* mode)
+	{
+		Assimp::IOStream* stream = DefaultIOSystem::Open( file, mode );
+		if ( stream )
+		{
+			m_openedFiles.push_back( file );
+		}
+		return stream;
+	}
+
+	std::vector< std::string > RecordingIOSystem::getOpenedFiles(const std::string& excluded) const
+	{
+		std::vector< std::string > openedFiles;
+		for ( unsigned int i = 0; i < m_openedFiles.size(); i++ )
+		{
+			if ( m_openedFiles[i] != excluded && std::find( openedFiles.begin(), openedFiles.end(), m_openedFiles[i] ) == openedFiles.end() )
+			{
+				openedFiles.push_back( m_openedFiles[i] );
+			}
+		}
+		return openedFiles;
+	}
+
+	unsigned int getImportFlags()
+	{
+		return	aiProcess_Triangulate |
+				aiProcess_GenSmoothNormals|
+//				aiProcess_GenNormals|
+				aiProcess_GenUVCoords |
+				aiProcess_FlipUVs|
+				aiProcess_ValidateDataStructure |
+				aiProcess_CalcTangentSpace;
+	}
+
 	/**
 	 *	load an assimp scene from a file
 	 *  @param path to the file
@@ -50,15 +85,7 @@ namespace AssimpTools
 		}
 
 		// load "scene" from file
-		const aiScene* pScene = Importer.ReadFile( path,
-				aiProcess_Triangulate |
-				aiProcess_GenSmoothNormals|
-//				aiProcess_GenNormals|
-				aiProcess_GenUVCoords |
-				aiProcess_FlipUVs|
-				aiProcess_ValidateDataStructure |
-				aiProcess_CalcTangentSpace
-		);
+		const aiScene* pScene = Importer.ReadFile( path, getImportFlags() );
 
 		if( !pScene)
 		{
@@ -254,6 +281,168 @@ namespace AssimpTools
 			return model;
 	}
 
+	/**
+	 * copy the vertex data and texture references of an assimp mesh object
+	 */
+	void extractMeshData(const aiScene* scene, const aiMesh* mesh, MeshData& meshData)
+	{
+		meshData = MeshData();
+
+		float uv_steps = 1.0f / mesh->mNumVertices;
+		for (unsigned int k = 0; k < mesh->mNumVertices; ++k)
+		{
+			if (mesh->HasPositions())
+			{
+				meshData.m_positions.push_back( glm::vec3( mesh->mVertices[k].x, mesh->mVertices[k].y, mesh->mVertices[k].z ) );
+			}
+			if (mesh->HasTextureCoords(0))
+			{
+				meshData.m_uvs.push_back( glm::vec2( mesh->mTextureCoords[0][k].x, mesh->mTextureCoords[0][k].y ) );
+			}
+			else
+			{
+				meshData.m_uvs.push_back( glm::vec2( k * uv_steps, k * uv_steps ) );
+			}
+			if (mesh->HasNormals())
+			{
+				meshData.m_normals.push_back( glm::vec3( mesh->mNormals[k].x, mesh->mNormals[k].y, mesh->mNormals[k].z ) );
+			}
+			if (mesh->HasTangentsAndBitangents())
+			{
+				meshData.m_tangents.push_back( glm::vec3( mesh->mTangents[k].x, mesh->mTangents[k].y, mesh->mTangents[k].z ) );
+			}
+		}
+
+		for (unsigned int t = 0; t < mesh->mNumFaces; ++t)
+		{
+			meshData.m_faceSizes.push_back( mesh->mFaces[t].mNumIndices );
+			for (unsigned int i = 0; i < mesh->mFaces[t].mNumIndices; ++i)
+			{
+				meshData.m_indices.push_back( mesh->mFaces[t].mIndices[i] );
+			}
+		}
+
+		aiMaterial* mtl = loadMaterial( scene, mesh );
+		aiString texPath;
+		if ( materialHasTexture( mtl, aiTextureType_DIFFUSE, &texPath ) )
+		{
+			meshData.m_diffuseTexture = texPath.C_Str();
+		}
+		if ( materialHasTexture( mtl, aiTextureType_NORMALS, &texPath ) )
+		{
+			meshData.m_normalTexture = texPath.C_Str();
+		}
+	}
+
+	/**
+	 * create a model object from extracted or cached mesh data
+	 */
+	Model* createModelFromMeshData(const MeshData& meshData, bool upload)
+	{
+			Model* model = new Model();
+
+			model->setNumVertices(	(int) meshData.m_uvs.size() );
+			model->setNumIndices(	meshData.m_faceSizes.size() * 3 );
+			model->setNumFaces(		meshData.m_faceSizes.size() );
+
+			if ( upload )
+			{
+				uploadMeshData( model, meshData );
+			}
+
+			return model;
+	}
+
+	/**
+	 * buffer mesh data into a vertex array object of a model, the same way as createModelFromMesh
+	 */
+	void uploadMeshData(Model* model, const MeshData& meshData)
+	{
+			// buffer handle
+			GLuint buffer = 0;
+
+			int numVertices = (int) meshData.m_uvs.size();
+
+			// generate vertex array buffer
+			glGenVertexArrays(1,   &buffer );
+			glBindVertexArray(		buffer );
+			model->setVAOHandle(	buffer );
+
+			// generate index buffer
+			buffer = 0;
+			glGenBuffers(1, &buffer);
+			glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, buffer);
+			glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof( GLuint ) * meshData.m_indices.size(), meshData.m_indices.empty() ? 0 : &meshData.m_indices[0], GL_STATIC_DRAW);
+			model->setIndexBufferHandle( buffer );
+
+			DEBUGLOG->log("Buffered indices        : " , (int) meshData.m_indices.size());
+			DEBUGLOG->log("Buffered faces          : " , (int) meshData.m_faceSizes.size());
+
+			// generate vertex position buffer
+			buffer = 0;
+			if ( !meshData.m_positions.empty() ) {
+				glGenBuffers(1, &buffer);
+				glBindBuffer(GL_ARRAY_BUFFER, buffer);
+				glBufferData(GL_ARRAY_BUFFER, sizeof(glm::vec3) * numVertices, &meshData.m_positions[0], GL_STATIC_DRAW);
+
+				glEnableVertexAttribArray(0);
+				glVertexAttribPointer(0, 3, GL_FLOAT, 0, 0, 0);
+				model->setVertexBufferHandle( buffer );
+				DEBUGLOG->log("Buffered vertices       : " , numVertices);
+			}
+			else
+			{
+				DEBUGLOG->log("WARNING : Object has no VERTICES");
+			}
+
+			// generate texture coordinates buffer
+			buffer = 0;
+			if ( !meshData.m_uvs.empty() ) {
+				glGenBuffers(1, &buffer);
+				glBindBuffer(GL_ARRAY_BUFFER, buffer);
+				glBufferData(GL_ARRAY_BUFFER, sizeof(glm::vec2) * numVertices, &meshData.m_uvs[0], GL_STATIC_DRAW);
+
+				glEnableVertexAttribArray(1);
+				glVertexAttribPointer(1, 2, GL_FLOAT, 0, 0, 0);
+				model->setUvBufferHandle( buffer );
+			}
+
+			// generate vertex normals buffer
+			buffer = 0;
+			if ( !meshData.m_normals.empty() ) {
+				glGenBuffers(1, &buffer);
+				glBindBuffer(GL_ARRAY_BUFFER, buffer);
+				glBufferData(GL_ARRAY_BUFFER, sizeof(glm::vec3) * numVertices, &meshData.m_normals[0], GL_STATIC_DRAW);
+
+				glEnableVertexAttribArray(2);
+				glVertexAttribPointer(2, 3, GL_FLOAT, 0, 0, 0);
+				model->setNormalBufferHandle( buffer );
+			}
+			else
+			{
+				DEBUGLOG->log("WARNING : Object has no NORMALS");
+			}
+
+			// generate tangent buffer
+			buffer = 0;
+			if ( !meshData.m_tangents.empty() ) {
+				glGenBuffers(1, &buffer);
+				glBindBuffer(GL_ARRAY_BUFFER, buffer);
+				glBufferData(GL_ARRAY_BUFFER, sizeof(glm::vec3) * numVertices, &meshData.m_tangents[0], GL_STATIC_DRAW);
+
+				glEnableVertexAttribArray(3);
+				glVertexAttribPointer(3, 3, GL_FLOAT, 0, 0, 0);
+				model->setTangentBufferHandle( buffer );
+			}
+			else
+			{
+				DEBUGLOG->log("WARNING : Object has no TANGENTS AND BITANGENTS");
+			}
+
+			// unbind buffers
+			glBindVertexArray(0);
+	}
+
 	/**
 	 *	load Objects from a file
 	 */
@@ -4,9 +4,12 @@
 #include "GL/glew.h"
 
 #include "assimp/Importer.hpp"
+#include "assimp/DefaultIOSystem.h"
 #include "assimp/scene.h"
 #include "assimp/postprocess.h"
 
+#include "Utility/MeshCache.h"
+
 #include <vector>
 
 class Model;
@@ -17,6 +20,29 @@ namespace AssimpTools
 
 	std::string getDirectoryPath( std::string file );
 
+	/**
+	 * file system of an importer which records every file opened during an import, i.e. the material libraries of an OBJ file
+	 * the importer takes ownership once it is set by Assimp::Importer::SetIOHandler
+	 */
+	class RecordingIOSystem : public Assimp::DefaultIOSystem
+	{
+	protected:
+		std::vector< std::string > m_openedFiles;
+	public:
+		Assimp::IOStream* Open( const char* file, const char* mode = "rb" );
+
+		/**
+		 * @param excluded file not to be listed, i.e. the scene file itself
+		 * @return every opened file once, in the order they were opened first
+		 */
+		std::vector< std::string > getOpenedFiles( const std::string& excluded = std::string() ) const;
+	};
+
+	/**
+	 * @return post processing steps applied by loadScene, cooked meshes imported with different steps are outdated
+	 */
+	unsigned int getImportFlags();
+
 	/**
 	 *	load an assimp scene from a file
 	 */
@@ -43,6 +69,22 @@ namespace AssimpTools
 	 */	
 	Model* createModelFromMesh(const aiMesh* mesh);
 
+	/**
+	 * copy the vertex data and texture references of an assimp mesh object
+	 */
+	void extractMeshData(const aiScene* scene, const aiMesh* mesh, MeshData& meshData);
+
+	/**
+	 * create a model object from extracted or cached mesh data
+	 * @param upload buffer the mesh the same way as createModelFromMesh, false to create a model without any GL calls
+	 */
+	Model* createModelFromMeshData(const MeshData& meshData, bool upload = true);
+
+	/**
+	 * buffer mesh data into a vertex array object of a model, which must not have been buffered before
+	 */
+	void uploadMeshData(Model* model, const MeshData& meshData);
+
 	/**
 	 *	load Objects from a file
 	 */
@@ -0,0 +1,123 @@
+#ifndef BITTOOLS_H
+#define BITTOOLS_H
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+/** \brief A collection of bit manipulation functions on 32 bit words, mapped to hardware instructions where available
+ *
+ */
+namespace BitTools {
+	/**
+	 * count the set bits of a word
+	 * @param word
+	 * @return amount of set bits
+	 */
+	inline int popCount( unsigned int word )
+	{
+#if defined(_MSC_VER)
+		return (int) __popcnt( word );
+#else
+		return __builtin_popcount( word );
+#endif
+	}
+
+	/**
+	 * index of the lowest set bit
+	 * @param word
+	 * @return index of lowest set bit, 32 if no bit is set
+	 */
+	inline int countTrailingZeros( unsigned int word )
+	{
+		if ( word == 0 )
+		{
+			return 32;
+		}
+#if defined(_MSC_VER)
+		unsigned long index;
+		_BitScanForward( &index, word );
+		return (int) index;
+#else
+		return __builtin_ctz( word );
+#endif
+	}
+
+	/**
+	 * amount of unset bits above the highest set bit
+	 * @param word
+	 * @return 31 - index of highest set bit, 32 if no bit is set
+	 */
+	inline int countLeadingZeros( unsigned int word )
+	{
+		if ( word == 0 )
+		{
+			return 32;
+		}
+#if defined(_MSC_VER)
+		unsigned long index;
+		_BitScanReverse( &index, word );
+		return 31 - (int) index;
+#else
+		return __builtin_clz( word );
+#endif
+	}
+
+	/**
+	 * mask with all bits from first up to (excluding) first + count set
+	 * @param first bit index of the lowest bit
+	 * @param count amount of bits
+	 * @return mask
+	 */
+	inline unsigned int getRangeMask( int first, int count )
+	{
+		if ( count <= 0 || first >= 32 )
+		{
+			return 0u;
+		}
+		unsigned int upper = ( count >= 32 ) ? 0xFFFFFFFFu : ( ( 1u << count ) - 1u );
+		return upper << first;
+	}
+
+	/**
+	 * move the lower 10 bits of a word to every third bit, i.e. bit i to bit 3 * i
+	 * @param word
+	 * @return spread bits
+	 */
+	inline unsigned int spreadBits3( unsigned int word )
+	{
+		word &= 0x000003FFu;
+		word = ( word | ( word << 16 ) ) & 0x030000FFu;
+		word = ( word | ( word << 8 ) ) & 0x0300F00Fu;
+		word = ( word | ( word << 4 ) ) & 0x030C30C3u;
+		word = ( word | ( word << 2 ) ) & 0x09249249u;
+		return word;
+	}
+
+	/**
+	 * inverse of spreadBits3, move every third bit into the lower 10 bits
+	 * @param word
+	 * @return compacted bits
+	 */
+	inline unsigned int compactBits3( unsigned int word )
+	{
+		word &= 0x09249249u;
+		word = ( word | ( word >> 2 ) ) & 0x030C30C3u;
+		word = ( word | ( word >> 4 ) ) & 0x0300F00Fu;
+		word = ( word | ( word >> 8 ) ) & 0x030000FFu;
+		word = ( word | ( word >> 16 ) ) & 0x000003FFu;
+		return word;
+	}
+
+	/**
+	 * interleave the bits of three coordinates, x in the lowest bit
+	 * @param x,y,z coordinates, only the lower 10 bits are used
+	 * @return 30 bit morton code
+	 */
+	inline unsigned int encodeMorton3( unsigned int x, unsigned int y, unsigned int z )
+	{
+		return spreadBits3( x ) | ( spreadBits3( y ) << 1 ) | ( spreadBits3( z ) << 2 );
+	}
+}
+
+#endif
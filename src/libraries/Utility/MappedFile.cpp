@@ -0,0 +1,98 @@
+#include "Utility/MappedFile.h"
+
+#include <cstdio>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::MappedFile()
+{
+	p_data = 0;
+	m_size = 0;
+	m_mappedData = 0;
+}
+
+MappedFile::~MappedFile()
+{
+	close();
+}
+
+bool MappedFile::open(const std::string& path)
+{
+	close();
+
+#ifndef _WIN32
+	int fileDescriptor = ::open( path.c_str(), O_RDONLY );
+	if ( fileDescriptor < 0 )
+	{
+		return false;
+	}
+	struct stat fileStatus;
+	if ( fstat( fileDescriptor, &fileStatus ) == 0 && fileStatus.st_size > 0 )
+	{
+		void* mapped = mmap( 0, (size_t) fileStatus.st_size, PROT_READ, MAP_PRIVATE, fileDescriptor, 0 );
+		if ( mapped != MAP_FAILED )
+		{
+			m_mappedData = mapped;
+			m_size = (size_t) fileStatus.st_size;
+			p_data = (const char*) mapped;
+		}
+	}
+	::close( fileDescriptor );
+#else
+	FILE* file = fopen( path.c_str(), "rb" );
+	if ( !file )
+	{
+		return false;
+	}
+	fseek( file, 0, SEEK_END );
+	long fileSize = ftell( file );
+	fseek( file, 0, SEEK_SET );
+	if ( fileSize > 0 )
+	{
+		m_fileData.resize( (size_t) fileSize );
+		if ( fread( &m_fileData[0], 1, m_fileData.size(), file ) == m_fileData.size() )
+		{
+			m_size = m_fileData.size();
+			p_data = &m_fileData[0];
+		}
+		else
+		{
+			m_fileData.clear();
+		}
+	}
+	fclose( file );
+#endif
+
+	return p_data != 0;
+}
+
+void MappedFile::close()
+{
+#ifndef _WIN32
+	if ( m_mappedData )
+	{
+		munmap( m_mappedData, m_size );
+	}
+#endif
+	m_mappedData = 0;
+	m_fileData.clear();
+	p_data = 0;
+	m_size = 0;
+}
+
+bool MappedFile::isOpen() const {
+	return p_data != 0;
+}
+
+const char* MappedFile::getData() const {
+	return p_data;
+}
+
+size_t MappedFile::getSize() const {
+	return m_size;
+}
@@ -0,0 +1,39 @@
+#ifndef MAPPEDFILE_H
+#define MAPPEDFILE_H
+
+#include <string>
+#include <vector>
+
+/**
+ * This class represents a read only file in memory
+ * the file is memory mapped, on Windows it is read into memory instead
+ */
+class MappedFile
+{
+protected:
+	const char* p_data;
+	size_t m_size;
+
+	void* m_mappedData;				// memory mapped file, 0 if the file was read
+	std::vector< char > m_fileData;	// file contents if the file was read
+public:
+	MappedFile();
+	virtual ~MappedFile();
+
+	/**
+	 * map a file, releasing the previous one
+	 * @return false if the file does not exist or is empty
+	 */
+	bool open( const std::string& path );
+
+	/**
+	 * release the file
+	 */
+	void close();
+
+	bool isOpen() const;
+	const char* getData() const;
+	size_t getSize() const;
+};
+
+#endif
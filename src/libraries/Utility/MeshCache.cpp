@@ -0,0 +1,437 @@
+#include "Utility/MeshCache.h"
+
+#include "Utility/DebugLog.h"
+#include "Utility/MappedFile.h"
+
+#include <cstdio>
+#include <cstring>
+
+#include <sys/types.h>
+#include <sys/stat.h>
+
+static const unsigned int CACHE_VERSION = 2;
+static const size_t CACHE_ALIGNMENT = 16;
+
+/**
+ * header of a cooked file
+ */
+struct MeshCacheHeader
+{
+	char m_magic[4];	// "MSHC"
+	unsigned int m_version;
+	unsigned int m_numMeshes;
+	unsigned int m_flags;	// how the meshes were processed after importing, 0 if they are stored as imported
+	unsigned int m_importFlags;
+	unsigned int m_numDependencies;
+	unsigned long long m_sourceSize;
+	long long m_sourceTime;
+	unsigned long long m_sourceHash;
+};
+
+/**
+ * record of a file read during the import besides the scene file, i.e. a material library
+ */
+struct MeshCacheDependency
+{
+	unsigned long long m_size;
+	long long m_time;
+	unsigned long long m_hash;
+	unsigned long long m_pathOffset;
+	unsigned int m_pathLength;
+	unsigned int m_reserved;
+};
+
+/**
+ * record of a single mesh, offsets are relative to the beginning of the file
+ */
+struct MeshCacheRecord
+{
+	unsigned int m_numVertices;
+	unsigned int m_numNormals;
+	unsigned int m_numTangents;
+	unsigned int m_numIndices;
+	unsigned int m_numFaces;
+	unsigned int m_diffuseTextureLength;
+	unsigned int m_normalTextureLength;
+	unsigned int m_reserved;
+
+	unsigned long long m_positionsOffset;
+	unsigned long long m_normalsOffset;
+	unsigned long long m_uvsOffset;
+	unsigned long long m_tangentsOffset;
+	unsigned long long m_indicesOffset;
+	unsigned long long m_faceSizesOffset;
+	unsigned long long m_diffuseTextureOffset;
+	unsigned long long m_normalTextureOffset;
+};
+
+/**
+ * FNV-1a hash of the scene file contents
+ */
+static unsigned long long hashFile( const MappedFile& file )
+{
+	unsigned long long hash = 14695981039346656037ULL;
+	const unsigned char* bytes = (const unsigned char*) file.getData();
+	for ( size_t i = 0; i < file.getSize(); i++ )
+	{
+		hash ^= bytes[i];
+		hash *= 1099511628211ULL;
+	}
+	return hash;
+}
+
+/**
+ * @return false if the file does not exist
+ */
+static bool getFileStatus( const std::string& path, unsigned long long& size, long long& time )
+{
+	struct stat fileStatus;
+	if ( stat( path.c_str(), &fileStatus ) != 0 )
+	{
+		return false;
+	}
+	size = (unsigned long long) fileStatus.st_size;
+	time = (long long) fileStatus.st_mtime;
+	return true;
+}
+
+/**
+ * read size, modification time and hash of a file
+ * @return false if the file does not exist or is empty
+ */
+static bool getFileIdentity( const std::string& path, unsigned long long& size, long long& time, unsigned long long& hash )
+{
+	MappedFile file;
+	if ( !getFileStatus( path, size, time ) || !file.open( path ) )
+	{
+		return false;
+	}
+	hash = hashFile( file );
+	return true;
+}
+
+/**
+ * a file is unchanged if it has the same size and either the same modification time or, if it was only touched, the same hash
+ */
+static bool isFileUnchanged( const std::string& path, unsigned long long size, long long time, unsigned long long hash )
+{
+	unsigned long long currentSize = 0;
+	long long currentTime = 0;
+	if ( !getFileStatus( path, currentSize, currentTime ) || currentSize != size )
+	{
+		return false;
+	}
+	if ( currentTime == time )
+	{
+		return true;
+	}
+	MappedFile file;
+	return file.open( path ) && hashFile( file ) == hash;
+}
+
+/**
+ * @return false if the face sizes do not add up to the amount of indices or an index refers to a vertex out of range
+ */
+static bool isConsistent( const MeshData& mesh )
+{
+	unsigned long long numIndices = 0;
+	for ( unsigned int f = 0; f < mesh.m_faceSizes.size(); f++ )
+	{
+		numIndices += mesh.m_faceSizes[f];
+	}
+	if ( numIndices != mesh.m_indices.size() )
+	{
+		return false;
+	}
+	for ( unsigned int i = 0; i < mesh.m_indices.size(); i++ )
+	{
+		if ( mesh.m_indices[i] >= mesh.m_positions.size() )
+		{
+			return false;
+		}
+	}
+	return ( mesh.m_normals.empty() || mesh.m_normals.size() == mesh.m_positions.size() )
+		&& ( mesh.m_tangents.empty() || mesh.m_tangents.size() == mesh.m_positions.size() );
+}
+
+static inline unsigned long long align( unsigned long long offset )
+{
+	return ( offset + CACHE_ALIGNMENT - 1 ) & ~( (unsigned long long) CACHE_ALIGNMENT - 1 );
+}
+
+/**
+ * reserve an aligned block behind the current end of the file
+ * @return offset of the block
+ */
+static unsigned long long reserveBlock( unsigned long long& fileSize, size_t numBytes )
+{
+	unsigned long long offset = align( fileSize );
+	fileSize = offset + numBytes;
+	return offset;
+}
+
+static void copyBlock( std::vector< char >& buffer, unsigned long long offset, const void* data, size_t numBytes )
+{
+	if ( numBytes > 0 )
+	{
+		memcpy( &buffer[ (size_t) offset ], data, numBytes );
+	}
+}
+
+/**
+ * @return true if a block of the file lies completely inside of it
+ */
+static inline bool isInside( unsigned long long offset, unsigned long long numBytes, size_t fileSize )
+{
+	return offset <= fileSize && numBytes <= fileSize - offset;
+}
+
+template< class T >
+static inline void copyArray( const char* data, unsigned long long offset, unsigned int count, std::vector< T >& array )
+{
+	const T* begin = (const T*) ( data + offset );
+	array.assign( begin, begin + count );
+}
+
+std::string MeshCache::getCacheFileName(const std::string& path)
+{
+	// keep cooked files out of the resources tree
+	std::string fileName = path;
+	for ( unsigned int i = 0; i < fileName.size(); i++ )
+	{
+		if ( fileName[i] == '/' || fileName[i] == '\\' || fileName[i] == ':' )
+		{
+			fileName[i] = '_';
+		}
+	}
+	return std::string( CACHE_PATH ) + "/" + fileName + ".meshcache";
+}
+
+bool MeshCache::write(const std::string& cachePath, const std::string& sourcePath, const std::vector< MeshData >& meshes, unsigned int flags, unsigned int importFlags, const std::vector< std::string >& dependencies)
+{
+	MeshCacheHeader header;
+	memcpy( header.m_magic, "MSHC", 4 );
+	header.m_version = CACHE_VERSION;
+	header.m_numMeshes = (unsigned int) meshes.size();
+	header.m_flags = flags;
+	header.m_importFlags = importFlags;
+	header.m_numDependencies = (unsigned int) dependencies.size();
+
+	if ( !getFileIdentity( sourcePath, header.m_sourceSize, header.m_sourceTime, header.m_sourceHash ) )
+	{
+		DEBUGLOG->log("ERROR : MESH CACHE : could not read " + sourcePath);
+		return false;
+	}
+
+	// lay out the dependency paths and arrays behind the records
+	std::vector< MeshCacheDependency > dependencyRecords( dependencies.size() );
+	std::vector< MeshCacheRecord > records( meshes.size() );
+	unsigned long long recordsOffset = sizeof( header ) + sizeof( MeshCacheDependency ) * dependencies.size();
+	unsigned long long fileSize = recordsOffset + sizeof( MeshCacheRecord ) * meshes.size();
+	for ( unsigned int i = 0; i < dependencies.size(); i++ )
+	{
+		MeshCacheDependency& dependency = dependencyRecords[i];
+		memset( &dependency, 0, sizeof( dependency ) );
+		if ( !getFileIdentity( dependencies[i], dependency.m_size, dependency.m_time, dependency.m_hash ) )
+		{
+			DEBUGLOG->log("ERROR : MESH CACHE : could not read " + dependencies[i]);
+			return false;
+		}
+		dependency.m_pathLength = (unsigned int) dependencies[i].size();
+		dependency.m_pathOffset = reserveBlock( fileSize, dependencies[i].size() );
+	}
+	for ( unsigned int i = 0; i < meshes.size(); i++ )
+	{
+		const MeshData& mesh = meshes[i];
+		MeshCacheRecord& record = records[i];
+		memset( &record, 0, sizeof( record ) );
+
+		record.m_numVertices = (unsigned int) mesh.m_positions.size();
+		record.m_numNormals = (unsigned int) mesh.m_normals.size();
+		record.m_numTangents = (unsigned int) mesh.m_tangents.size();
+		record.m_numIndices = (unsigned int) mesh.m_indices.size();
+		record.m_numFaces = (unsigned int) mesh.m_faceSizes.size();
+		record.m_diffuseTextureLength = (unsigned int) mesh.m_diffuseTexture.size();
+		record.m_normalTextureLength = (unsigned int) mesh.m_normalTexture.size();
+
+		record.m_positionsOffset = reserveBlock( fileSize, sizeof( glm::vec3 ) * mesh.m_positions.size() );
+		record.m_normalsOffset = reserveBlock( fileSize, sizeof( glm::vec3 ) * mesh.m_normals.size() );
+		record.m_uvsOffset = reserveBlock( fileSize, sizeof( glm::vec2 ) * mesh.m_positions.size() );
+		record.m_tangentsOffset = reserveBlock( fileSize, sizeof( glm::vec3 ) * mesh.m_tangents.size() );
+		record.m_indicesOffset = reserveBlock( fileSize, sizeof( unsigned int ) * mesh.m_indices.size() );
+		record.m_faceSizesOffset = reserveBlock( fileSize, sizeof( unsigned int ) * mesh.m_faceSizes.size() );
+		record.m_diffuseTextureOffset = reserveBlock( fileSize, mesh.m_diffuseTexture.size() );
+		record.m_normalTextureOffset = reserveBlock( fileSize, mesh.m_normalTexture.size() );
+
+		if ( mesh.m_uvs.size() != mesh.m_positions.size() )
+		{
+			DEBUGLOG->log("ERROR : MESH CACHE : mesh has a different amount of uvs than vertices : ", (int) i);
+			return false;
+		}
+	}
+
+	std::vector< char > buffer( (size_t) fileSize, 0 );
+	copyBlock( buffer, 0, &header, sizeof( header ) );
+	for ( unsigned int i = 0; i < dependencies.size(); i++ )
+	{
+		copyBlock( buffer, sizeof( header ) + sizeof( MeshCacheDependency ) * i, &dependencyRecords[i], sizeof( MeshCacheDependency ) );
+		copyBlock( buffer, dependencyRecords[i].m_pathOffset, dependencies[i].data(), dependencies[i].size() );
+	}
+	for ( unsigned int i = 0; i < meshes.size(); i++ )
+	{
+		const MeshData& mesh = meshes[i];
+		const MeshCacheRecord& record = records[i];
+		copyBlock( buffer, recordsOffset + sizeof( MeshCacheRecord ) * i, &record, sizeof( record ) );
+
+		if ( !mesh.m_positions.empty() )
+		{
+			copyBlock( buffer, record.m_positionsOffset, &mesh.m_positions[0], sizeof( glm::vec3 ) * mesh.m_positions.size() );
+			copyBlock( buffer, record.m_uvsOffset, &mesh.m_uvs[0], sizeof( glm::vec2 ) * mesh.m_uvs.size() );
+		}
+		if ( !mesh.m_normals.empty() )
+		{
+			copyBlock( buffer, record.m_normalsOffset, &mesh.m_normals[0], sizeof( glm::vec3 ) * mesh.m_normals.size() );
+		}
+		if ( !mesh.m_tangents.empty() )
+		{
+			copyBlock( buffer, record.m_tangentsOffset, &mesh.m_tangents[0], sizeof( glm::vec3 ) * mesh.m_tangents.size() );
+		}
+		if ( !mesh.m_indices.empty() )
+		{
+			copyBlock( buffer, record.m_indicesOffset, &mesh.m_indices[0], sizeof( unsigned int ) * mesh.m_indices.size() );
+		}
+		if ( !mesh.m_faceSizes.empty() )
+		{
+			copyBlock( buffer, record.m_faceSizesOffset, &mesh.m_faceSizes[0], sizeof( unsigned int ) * mesh.m_faceSizes.size() );
+		}
+		copyBlock( buffer, record.m_diffuseTextureOffset, mesh.m_diffuseTexture.data(), mesh.m_diffuseTexture.size() );
+		copyBlock( buffer, record.m_normalTextureOffset, mesh.m_normalTexture.data(), mesh.m_normalTexture.size() );
+	}
+
+	FILE* file = fopen( cachePath.c_str(), "wb" );
+	if ( !file )
+	{
+		DEBUGLOG->log("ERROR : MESH CACHE : could not open " + cachePath);
+		return false;
+	}
+	bool success = fwrite( &buffer[0], 1, buffer.size(), file ) == buffer.size();
+	fclose( file );
+
+	if ( !success )
+	{
+		DEBUGLOG->log("ERROR : MESH CACHE : could not write " + cachePath);
+		remove( cachePath.c_str() );
+	}
+	return success;
+}
+
+bool MeshCache::load(const std::string& cachePath, const std::string& sourcePath, std::vector< MeshData >& meshes, unsigned int flags, unsigned int importFlags)
+{
+	meshes.clear();
+
+	MappedFile file;
+	if ( !file.open( cachePath ) )
+	{
+		return false;
+	}
+	const char* data = file.getData();
+	size_t size = file.getSize();
+
+	MeshCacheHeader header;
+	if ( size < sizeof( header ) )
+	{
+		DEBUGLOG->log("MESH CACHE : rejected truncated file " + cachePath);
+		return false;
+	}
+	memcpy( &header, data, sizeof( header ) );
+
+	unsigned long long recordsOffset = sizeof( header ) + (unsigned long long) sizeof( MeshCacheDependency ) * header.m_numDependencies;
+	if ( memcmp( header.m_magic, "MSHC", 4 ) != 0 || header.m_version != CACHE_VERSION
+		|| !isInside( sizeof( header ), (unsigned long long) sizeof( MeshCacheDependency ) * header.m_numDependencies, size )
+		|| !isInside( recordsOffset, (unsigned long long) sizeof( MeshCacheRecord ) * header.m_numMeshes, size ) )
+	{
+		DEBUGLOG->log("MESH CACHE : rejected outdated or foreign file " + cachePath);
+		return false;
+	}
+
+	if ( header.m_flags != flags || header.m_importFlags != importFlags )
+	{
+		DEBUGLOG->log("MESH CACHE : rejected file cooked with different settings " + cachePath);
+		return false;
+	}
+
+	// files are only hashed if they were touched since the scene was cooked
+	if ( !isFileUnchanged( sourcePath, header.m_sourceSize, header.m_sourceTime, header.m_sourceHash ) )
+	{
+		DEBUGLOG->log("MESH CACHE : rejected outdated file " + cachePath);
+		return false;
+	}
+
+	for ( unsigned int i = 0; i < header.m_numDependencies; i++ )
+	{
+		MeshCacheDependency dependency;
+		memcpy( &dependency, data + sizeof( header ) + sizeof( MeshCacheDependency ) * i, sizeof( dependency ) );
+		if ( !isInside( dependency.m_pathOffset, dependency.m_pathLength, size ) )
+		{
+			DEBUGLOG->log("MESH CACHE : rejected corrupt file " + cachePath);
+			return false;
+		}
+
+		std::string dependencyPath( data + dependency.m_pathOffset, dependency.m_pathLength );
+		if ( !isFileUnchanged( dependencyPath, dependency.m_size, dependency.m_time, dependency.m_hash ) )
+		{
+			DEBUGLOG->log("MESH CACHE : rejected outdated file " + cachePath + ", changed : " + dependencyPath);
+			return false;
+		}
+	}
+
+	std::vector< MeshCacheRecord > records( header.m_numMeshes );
+	if ( !records.empty() )
+	{
+		memcpy( &records[0], data + recordsOffset, sizeof( MeshCacheRecord ) * records.size() );
+	}
+
+	for ( unsigned int i = 0; i < records.size(); i++ )
+	{
+		const MeshCacheRecord& record = records[i];
+		if ( !isInside( record.m_positionsOffset, (unsigned long long) sizeof( glm::vec3 ) * record.m_numVertices, size )
+			|| !isInside( record.m_normalsOffset, (unsigned long long) sizeof( glm::vec3 ) * record.m_numNormals, size )
+			|| !isInside( record.m_uvsOffset, (unsigned long long) sizeof( glm::vec2 ) * record.m_numVertices, size )
+			|| !isInside( record.m_tangentsOffset, (unsigned long long) sizeof( glm::vec3 ) * record.m_numTangents, size )
+			|| !isInside( record.m_indicesOffset, (unsigned long long) sizeof( unsigned int ) * record.m_numIndices, size )
+			|| !isInside( record.m_faceSizesOffset, (unsigned long long) sizeof( unsigned int ) * record.m_numFaces, size )
+			|| !isInside( record.m_diffuseTextureOffset, record.m_diffuseTextureLength, size )
+			|| !isInside( record.m_normalTextureOffset, record.m_normalTextureLength, size ) )
+		{
+			DEBUGLOG->log("MESH CACHE : rejected corrupt file " + cachePath);
+			meshes.clear();
+			return false;
+		}
+	}
+
+	meshes.resize( records.size() );
+	for ( unsigned int i = 0; i < records.size(); i++ )
+	{
+		const MeshCacheRecord& record = records[i];
+		MeshData& mesh = meshes[i];
+
+		copyArray( data, record.m_positionsOffset, record.m_numVertices, mesh.m_positions );
+		copyArray( data, record.m_normalsOffset, record.m_numNormals, mesh.m_normals );
+		copyArray( data, record.m_uvsOffset, record.m_numVertices, mesh.m_uvs );
+		copyArray( data, record.m_tangentsOffset, record.m_numTangents, mesh.m_tangents );
+		copyArray( data, record.m_indicesOffset, record.m_numIndices, mesh.m_indices );
+		copyArray( data, record.m_faceSizesOffset, record.m_numFaces, mesh.m_faceSizes );
+		mesh.m_diffuseTexture.assign( data + record.m_diffuseTextureOffset, record.m_diffuseTextureLength );
+		mesh.m_normalTexture.assign( data + record.m_normalTextureOffset, record.m_normalTextureLength );
+
+		// the blocks may be intact while their contents are not
+		if ( !isConsistent( mesh ) )
+		{
+			DEBUGLOG->log("MESH CACHE : rejected corrupt file " + cachePath);
+			meshes.clear();
+			return false;
+		}
+	}
+
+	return true;
+}
@@ -0,0 +1,71 @@
+#ifndef MESHCACHE_H
+#define MESHCACHE_H
+
+#include <glm/glm.hpp>
+
+#include <string>
+#include <vector>
+
+/**
+ * vertex data and material references of a single imported mesh
+ */
+struct MeshData
+{
+	std::vector< glm::vec3 > m_positions;
+	std::vector< glm::vec3 > m_normals;		// empty if the mesh has no normals
+	std::vector< glm::vec2 > m_uvs;			// generated the same way as the buffered ones if the mesh has none
+	std::vector< glm::vec3 > m_tangents;	// empty if the mesh has no tangents
+	std::vector< unsigned int > m_indices;	// indices of all faces, one after another
+	std::vector< unsigned int > m_faceSizes;	// amount of indices per face
+
+	std::string m_diffuseTexture;	// texture file relative to the scene file, empty if there is none
+	std::string m_normalTexture;	// texture file relative to the scene file, empty if there is none
+};
+
+namespace MeshCache
+{
+	/**
+	 * processing steps applied to the meshes after importing, stored in the header of a cooked file
+	 */
+	enum Flags
+	{
+		OPTIMIZED = 1	// reordered by MeshOptimizer::optimize
+	};
+
+	/**
+	 * @return file name of the cooked meshes of a scene file in the cache directory,
+	 *         i.e. CACHE_PATH "/<path with separators replaced by '_'>.meshcache", so scene files of the same name do not collide
+	 */
+	std::string getCacheFileName( const std::string& path );
+
+	/**
+	 * write the meshes of a scene file into a cooked binary file
+	 * - the file holds a header identifying the scene file by its size, modification time and hash,
+	 *   a record per dependency identifying it the same way, a record per mesh and the vertex arrays, every array starts 16 byte aligned
+	 * @param cachePath of the cooked file
+	 * @param sourcePath of the scene file the meshes were imported from
+	 * @param meshes to be written
+	 * @param flags processing steps the meshes went through
+	 * @param importFlags post processing steps of the importer
+	 * @param dependencies other files read during the import, i.e. the material libraries of an OBJ file
+	 * @return true on success
+	 */
+	bool write( const std::string& cachePath, const std::string& sourcePath, const std::vector< MeshData >& meshes, unsigned int flags = 0,
+			unsigned int importFlags = 0, const std::vector< std::string >& dependencies = std::vector< std::string >() );
+
+	/**
+	 * load the meshes of a cooked file, the file is memory mapped and the arrays are copied without any parsing
+	 * the file is only accepted if the scene file and every dependency have the size they were cooked from and either the same
+	 * modification time or, if they were only touched, the same hash
+	 * faces and indices are validated, so a corrupt file is rejected instead of producing faces out of range
+	 * @param cachePath of the cooked file
+	 * @param sourcePath of the scene file
+	 * @param meshes will be filled with the cooked meshes
+	 * @param flags processing steps the meshes must have gone through, a file cooked with different flags is rejected
+	 * @param importFlags post processing steps of the importer, a file cooked with different steps is rejected
+	 * @return true if the file exists and is up to date
+	 */
+	bool load( const std::string& cachePath, const std::string& sourcePath, std::vector< MeshData >& meshes, unsigned int flags = 0, unsigned int importFlags = 0 );
+}
+
+#endif
@@ -0,0 +1,300 @@
+#include "Utility/MeshOptimizer.h"
+
+#include <Utility/BitTools.h>
+
+#include <algorithm>
+#include <utility>
+
+/**
+ * @return true if every face is a triangle and every index refers to an existing vertex
+ */
+static bool isTriangleMesh( const MeshData& meshData )
+{
+	if ( meshData.m_indices.size() != meshData.m_faceSizes.size() * 3 )
+	{
+		return false;
+	}
+	for ( unsigned int i = 0; i < meshData.m_faceSizes.size(); i++ )
+	{
+		if ( meshData.m_faceSizes[i] != 3 )
+		{
+			return false;
+		}
+	}
+	for ( unsigned int i = 0; i < meshData.m_indices.size(); i++ )
+	{
+		if ( meshData.m_indices[i] >= meshData.m_positions.size() )
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+/**
+ * @return 30 bit Morton code of a position normalized to [0,1]
+ */
+static unsigned int computeMortonCode( const glm::vec3& position )
+{
+	unsigned int x = (unsigned int) std::min( std::max( position.x * 1024.0f, 0.0f ), 1023.0f );
+	unsigned int y = (unsigned int) std::min( std::max( position.y * 1024.0f, 0.0f ), 1023.0f );
+	unsigned int z = (unsigned int) std::min( std::max( position.z * 1024.0f, 0.0f ), 1023.0f );
+	// z in the lowest bit, x in the highest
+	return BitTools::encodeMorton3( z, y, x );
+}
+
+/**
+ * move the entries of a per vertex array to their new indices, arrays of a different size are left untouched
+ */
+template < typename T >
+static void remapVertexArray( std::vector< T >& array, const std::vector< unsigned int >& remap )
+{
+	if ( array.size() != remap.size() )
+	{
+		return;
+	}
+	std::vector< T > remapped( array.size() );
+	for ( unsigned int i = 0; i < array.size(); i++ )
+	{
+		remapped[ remap[i] ] = array[i];
+	}
+	array.swap( remapped );
+}
+
+bool MeshOptimizer::sortTrianglesSpatially(MeshData& meshData)
+{
+	if ( !isTriangleMesh( meshData ) )
+	{
+		return false;
+	}
+
+	int numTriangles = (int) meshData.m_faceSizes.size();
+	if ( numTriangles == 0 )
+	{
+		return true;
+	}
+
+	glm::vec3 min = meshData.m_positions[ meshData.m_indices[0] ];
+	glm::vec3 max = min;
+	for ( unsigned int i = 0; i < meshData.m_indices.size(); i++ )
+	{
+		min = glm::min( min, meshData.m_positions[ meshData.m_indices[i] ] );
+		max = glm::max( max, meshData.m_positions[ meshData.m_indices[i] ] );
+	}
+	glm::vec3 extent = max - min;
+	glm::vec3 scale(	( extent.x > 0.0f ) ? 1.0f / extent.x : 0.0f,
+						( extent.y > 0.0f ) ? 1.0f / extent.y : 0.0f,
+						( extent.z > 0.0f ) ? 1.0f / extent.z : 0.0f );
+
+	// ties keep the original order, since pairs are compared by triangle index second
+	std::vector< std::pair< unsigned int, int > > keys( numTriangles );
+	for ( int t = 0; t < numTriangles; t++ )
+	{
+		const unsigned int* triangle = &meshData.m_indices[ t * 3 ];
+		glm::vec3 centroid = ( meshData.m_positions[ triangle[0] ] + meshData.m_positions[ triangle[1] ] + meshData.m_positions[ triangle[2] ] ) / 3.0f;
+		keys[t] = std::make_pair( computeMortonCode( ( centroid - min ) * scale ), t );
+	}
+	std::sort( keys.begin(), keys.end() );
+
+	std::vector< unsigned int > indices( meshData.m_indices.size() );
+	for ( int t = 0; t < numTriangles; t++ )
+	{
+		const unsigned int* triangle = &meshData.m_indices[ keys[t].second * 3 ];
+		indices[ t * 3 + 0 ] = triangle[0];
+		indices[ t * 3 + 1 ] = triangle[1];
+		indices[ t * 3 + 2 ] = triangle[2];
+	}
+	meshData.m_indices.swap( indices );
+
+	return true;
+}
+
+bool MeshOptimizer::optimizeVertexCache(MeshData& meshData, int cacheSize)
+{
+	if ( !isTriangleMesh( meshData ) )
+	{
+		return false;
+	}
+
+	int numVertices = (int) meshData.m_positions.size();
+	int numTriangles = (int) meshData.m_faceSizes.size();
+	if ( numTriangles == 0 )
+	{
+		return true;
+	}
+
+	// triangles adjacent to every vertex
+	std::vector< int > liveTriangles( numVertices, 0 );
+	for ( unsigned int i = 0; i < meshData.m_indices.size(); i++ )
+	{
+		liveTriangles[ meshData.m_indices[i] ]++;
+	}
+	std::vector< int > adjacencyOffsets( numVertices + 1, 0 );
+	for ( int v = 0; v < numVertices; v++ )
+	{
+		adjacencyOffsets[ v + 1 ] = adjacencyOffsets[v] + liveTriangles[v];
+	}
+	std::vector< int > adjacency( meshData.m_indices.size() );
+	std::vector< int > fill( adjacencyOffsets.begin(), adjacencyOffsets.end() - 1 );
+	for ( int t = 0; t < numTriangles; t++ )
+	{
+		for ( int c = 0; c < 3; c++ )
+		{
+			adjacency[ fill[ meshData.m_indices[ t * 3 + c ] ]++ ] = t;
+		}
+	}
+
+	std::vector< int > cacheTime( numVertices, 0 );
+	std::vector< bool > emitted( numTriangles, false );
+	std::vector< int > deadEnds;
+	std::vector< int > candidates;
+	std::vector< unsigned int > indices;
+	indices.reserve( meshData.m_indices.size() );
+
+	int time = cacheSize + 1;
+	int cursor = 0;
+	int fanning = 0;
+	while ( fanning >= 0 )
+	{
+		// emit every remaining triangle around the fanning vertex
+		candidates.clear();
+		for ( int a = adjacencyOffsets[ fanning ]; a < adjacencyOffsets[ fanning + 1 ]; a++ )
+		{
+			int t = adjacency[a];
+			if ( emitted[t] )
+			{
+				continue;
+			}
+			for ( int c = 0; c < 3; c++ )
+			{
+				int v = (int) meshData.m_indices[ t * 3 + c ];
+				indices.push_back( (unsigned int) v );
+				deadEnds.push_back( v );
+				candidates.push_back( v );
+				liveTriangles[v]--;
+				if ( time - cacheTime[v] > cacheSize )
+				{
+					cacheTime[v] = time++;
+				}
+			}
+			emitted[t] = true;
+		}
+
+		// continue at the candidate which stays in the cache longest without being evicted by its own triangles
+		fanning = -1;
+		int bestPriority = -1;
+		for ( unsigned int i = 0; i < candidates.size(); i++ )
+		{
+			int v = candidates[i];
+			if ( liveTriangles[v] <= 0 )
+			{
+				continue;
+			}
+			int priority = 0;
+			if ( time - cacheTime[v] + 2 * liveTriangles[v] <= cacheSize )
+			{
+				priority = time - cacheTime[v];
+			}
+			if ( priority > bestPriority )
+			{
+				bestPriority = priority;
+				fanning = v;
+			}
+		}
+
+		// dead end : recently used vertices first, then the lowest unfinished vertex index
+		while ( fanning < 0 && !deadEnds.empty() )
+		{
+			int v = deadEnds.back();
+			deadEnds.pop_back();
+			if ( liveTriangles[v] > 0 )
+			{
+				fanning = v;
+			}
+		}
+		while ( fanning < 0 && cursor < numVertices )
+		{
+			if ( liveTriangles[ cursor ] > 0 )
+			{
+				fanning = cursor;
+			}
+			cursor++;
+		}
+	}
+
+	meshData.m_indices.swap( indices );
+
+	return true;
+}
+
+bool MeshOptimizer::optimizeVertexFetch(MeshData& meshData)
+{
+	if ( !isTriangleMesh( meshData ) )
+	{
+		return false;
+	}
+
+	unsigned int numVertices = (unsigned int) meshData.m_positions.size();
+	const unsigned int unused = (unsigned int) -1;
+
+	std::vector< unsigned int > remap( numVertices, unused );
+	unsigned int next = 0;
+	for ( unsigned int i = 0; i < meshData.m_indices.size(); i++ )
+	{
+		unsigned int& vertex = remap[ meshData.m_indices[i] ];
+		if ( vertex == unused )
+		{
+			vertex = next++;
+		}
+		meshData.m_indices[i] = vertex;
+	}
+	for ( unsigned int v = 0; v < numVertices; v++ )
+	{
+		if ( remap[v] == unused )
+		{
+			remap[v] = next++;
+		}
+	}
+
+	remapVertexArray( meshData.m_positions, remap );
+	remapVertexArray( meshData.m_normals, remap );
+	remapVertexArray( meshData.m_uvs, remap );
+	remapVertexArray( meshData.m_tangents, remap );
+
+	return true;
+}
+
+bool MeshOptimizer::optimize(MeshData& meshData, int cacheSize)
+{
+	if ( !sortTrianglesSpatially( meshData ) )
+	{
+		return false;
+	}
+	optimizeVertexFetch( meshData );
+	optimizeVertexCache( meshData, cacheSize );
+	optimizeVertexFetch( meshData );
+
+	return true;
+}
+
+float MeshOptimizer::computeACMR(const MeshData& meshData, int cacheSize)
+{
+	if ( !isTriangleMesh( meshData ) || meshData.m_faceSizes.empty() )
+	{
+		return 0.0f;
+	}
+
+	std::vector< int > cacheTime( meshData.m_positions.size(), 0 );
+	int time = cacheSize + 1;
+	int misses = 0;
+	for ( unsigned int i = 0; i < meshData.m_indices.size(); i++ )
+	{
+		int& vertexTime = cacheTime[ meshData.m_indices[i] ];
+		if ( time - vertexTime > cacheSize )
+		{
+			vertexTime = time++;
+			misses++;
+		}
+	}
+	return (float) misses / (float) meshData.m_faceSizes.size();
+}
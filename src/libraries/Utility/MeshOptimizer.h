@@ -0,0 +1,47 @@
+#ifndef MESHOPTIMIZER_H
+#define MESHOPTIMIZER_H
+
+#include "Utility/MeshCache.h"
+
+/**
+ * import time reordering of triangle meshes, none of the functions changes the geometry itself
+ * - only meshes consisting of triangles are reordered, any other mesh is left untouched
+ * - the functions make no GL calls and do not log, so several meshes may be optimized in parallel
+ */
+namespace MeshOptimizer
+{
+	/**
+	 * sort the triangles along a Morton curve through the centroids, so consecutive triangles are spatially close
+	 * @return false if the mesh does not consist of triangles
+	 */
+	bool sortTrianglesSpatially( MeshData& meshData );
+
+	/**
+	 * reorder the triangles for the post transform vertex cache (Tipsify, Sander et al. 2007)
+	 * - the traversal continues at vertices of recently emitted triangles and restarts at the lowest unfinished vertex index,
+	 *   so a spatial vertex order is preserved to a large extent
+	 * @param cacheSize amount of vertices the reordering is tuned for
+	 * @return false if the mesh does not consist of triangles
+	 */
+	bool optimizeVertexCache( MeshData& meshData, int cacheSize = 16 );
+
+	/**
+	 * renumber the vertices in order of their first use by the triangles, unused vertices are moved to the end
+	 * @return false if the mesh does not consist of triangles
+	 */
+	bool optimizeVertexFetch( MeshData& meshData );
+
+	/**
+	 * spatial triangle order, then vertex cache order, then vertex fetch order
+	 * - the vertices are renumbered along the spatial order first, so Tipsify restarts close to where it left off
+	 * @return false if the mesh does not consist of triangles and was left untouched
+	 */
+	bool optimize( MeshData& meshData, int cacheSize = 16 );
+
+	/**
+	 * @return average amount of vertex shader invocations per triangle with a FIFO cache of the given size, 0 if the mesh does not consist of triangles
+	 */
+	float computeACMR( const MeshData& meshData, int cacheSize = 16 );
+}
+
+#endif
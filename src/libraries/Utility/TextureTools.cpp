@@ -10,39 +10,53 @@ namespace TextureTools {
     	std::string fileString = std::string(fileName);
     	fileString = fileString.substr(fileString.find_last_of("/"));
 
-    	std::string fileContent;
-    	std::string line;
-
-    	int width, height, bytesPerPixel;
-        unsigned char *data = stbi_load(fileName.c_str(), &width, &height, &bytesPerPixel, 0);
-
-        if(data == NULL){
+    	TextureData textureData;
+        if( !decodeTexture( fileName, textureData ) ){
 //        	std::cout << "ERROR: Unable to open image "  << fileName << std::endl;
 //        	DEBUGLOG->log("ERROR : Unable to open image " + fileName);
         	DEBUGLOG->log("ERROR : Unable to open image " + fileString);
         	  return -1;}
 
+        GLuint textureHandle = createTexture( textureData );
+
+        freeTextureData( textureData );
+//        DEBUGLOG->log("SUCCESS: image loaded from " + fileName );
+        DEBUGLOG->log( "SUCCESS: image loaded from " + fileString );
+//        std::cout << "SUCCESS: image loaded from " << fileName << std::endl;
+        return textureHandle;
+    }
+
+    bool decodeTexture(std::string fileName, TextureData& textureData){
+        textureData.p_data = stbi_load(fileName.c_str(), &textureData.m_width, &textureData.m_height, &textureData.m_bytesPerPixel, 0);
+
+        if(textureData.p_data == NULL){
+            return false;
+        }
+
+        if (textureData.m_bytesPerPixel < 3) {
+            freeTextureData( textureData );
+            return false;
+        }
+        return true;
+    }
+
+    GLuint createTexture(const TextureData& textureData){
         //create new texture
         GLuint textureHandle;
         glGenTextures(1, &textureHandle);
-     
+
         //bind the texture
         glBindTexture(GL_TEXTURE_2D, textureHandle);
-     
+
         //send image data to the new texture
-        if (bytesPerPixel < 3) {
-        	DEBUGLOG->log("ERROR : Unable to open image " + fileString);
-//        	DEBUGLOG->log("ERROR : Unable to open image " + fileName);
-//            std::cout << "ERROR: Unable to open image"  << fileName << std::endl;
-            return -1;
-        } else if (bytesPerPixel == 3){
-            glTexImage2D(GL_TEXTURE_2D, 0,GL_RGB, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, data);
-        } else if (bytesPerPixel == 4) {
-            glTexImage2D(GL_TEXTURE_2D, 0,GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, data);
+        if (textureData.m_bytesPerPixel == 3){
+            glTexImage2D(GL_TEXTURE_2D, 0,GL_RGB, textureData.m_width, textureData.m_height, 0, GL_RGB, GL_UNSIGNED_BYTE, textureData.p_data);
+        } else if (textureData.m_bytesPerPixel == 4) {
+            glTexImage2D(GL_TEXTURE_2D, 0,GL_RGBA, textureData.m_width, textureData.m_height, 0, GL_RGBA, GL_UNSIGNED_BYTE, textureData.p_data);
         } else {
         	DEBUGLOG->log("Unknown format for bytes per pixel... Changed to \"4\"");
 //            std::cout << "Unknown format for bytes per pixel... Changed to \"4\"" << std::endl;
-            glTexImage2D(GL_TEXTURE_2D, 0,GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, data);
+            glTexImage2D(GL_TEXTURE_2D, 0,GL_RGBA, textureData.m_width, textureData.m_height, 0, GL_RGBA, GL_UNSIGNED_BYTE, textureData.p_data);
         }
 
         //texture settings
@@ -53,10 +67,13 @@ namespace TextureTools {
 
         glBindTexture(GL_TEXTURE_2D, 0);
 
-        stbi_image_free(data);
-//        DEBUGLOG->log("SUCCESS: image loaded from " + fileName );
-        DEBUGLOG->log( "SUCCESS: image loaded from " + fileString );
-//        std::cout << "SUCCESS: image loaded from " << fileName << std::endl;
         return textureHandle;
     }
+
+    void freeTextureData(TextureData& textureData){
+        if (textureData.p_data) {
+            stbi_image_free(textureData.p_data);
+        }
+        textureData.p_data = 0;
+    }
 }
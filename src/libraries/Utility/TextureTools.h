@@ -1,12 +1,51 @@
+#ifndef TEXTURETOOLS_H
+#define TEXTURETOOLS_H
+
 #include <string>
 #include <GL/glew.h>
 #include <GLFW/glfw3.h>
 
 namespace TextureTools {
+	/**
+	 * decoded image data of a texture file
+	 */
+	struct TextureData
+	{
+		int m_width;
+		int m_height;
+		int m_bytesPerPixel;
+		unsigned char* p_data;	// 0 if nothing is decoded
+
+		TextureData() : m_width( 0 ), m_height( 0 ), m_bytesPerPixel( 0 ), p_data( 0 ) {}
+	};
+
 	/** \brief !docu pls!
  	 *
  	 * @param fileName
  	 * @return GLuint
  	 */
     GLuint loadTexture(std::string fileName);
+
+	/**
+	 * decode an image file without any GL calls or logging, so it may be called from several threads at once
+	 * - the bundled stb_image is built without failure strings and with static zlib tables, so decoding writes no globals,
+	 *   do not enable partial PNG loading or change the stbi_* settings while decoding
+	 * @param fileName of the image
+	 * @param textureData will hold the decoded image, which has to be released by freeTextureData
+	 * @return false if the image could not be decoded or has less than 3 channels
+	 */
+	bool decodeTexture(std::string fileName, TextureData& textureData);
+
+	/**
+	 * create a mip mapped texture from decoded image data, must be called on the thread owning the GL context
+	 * @return texture handle
+	 */
+	GLuint createTexture(const TextureData& textureData);
+
+	/**
+	 * release decoded image data
+	 */
+	void freeTextureData(TextureData& textureData);
 }
+
+#endif
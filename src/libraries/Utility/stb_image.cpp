@@ -334,6 +334,10 @@ extern void stbi_install_YCbCr_to_RGB(stbi_YCbCr_to_RGB_run func);
 
 #ifndef STBI_HEADER_FILE_ONLY
 
+// TextureTools decodes several images in parallel and never reads stbi_failure_reason(),
+// so failures are not recorded in the global failure_reason
+#define STBI_NO_FAILURE_STRINGS
+
 #ifndef STBI_NO_HDR
 #include <math.h>  // ldexp
 #include <string.h> // strcmp, strtok
@@ -2246,18 +2250,27 @@ static int parse_zlib_header(zbuf *a)
    return 1;
 }
 
-// @TODO: should statically initialize these for optimal thread safety
-static uint8 default_length[288], default_distance[32];
-static void init_defaults(void)
+// statically initialized for thread safety, the lengths are given by the spec :
+// 0..143 : 8, 144..255 : 9, 256..279 : 7, 280..287 : 8
+static uint8 default_length[288] =
+{
+   8,8,8,8,8,8,8,8,8,8,8,8,8,8,8,8,8,8,8,8,8,8,8,8,
+   8,8,8,8,8,8,8,8,8,8,8,8,8,8,8,8,8,8,8,8,8,8,8,8,
+   8,8,8,8,8,8,8,8,8,8,8,8,8,8,8,8,8,8,8,8,8,8,8,8,
+   8,8,8,8,8,8,8,8,8,8,8,8,8,8,8,8,8,8,8,8,8,8,8,8,
+   8,8,8,8,8,8,8,8,8,8,8,8,8,8,8,8,8,8,8,8,8,8,8,8,
+   8,8,8,8,8,8,8,8,8,8,8,8,8,8,8,8,8,8,8,8,8,8,8,8,
+   9,9,9,9,9,9,9,9,9,9,9,9,9,9,9,9,9,9,9,9,9,9,9,9,
+   9,9,9,9,9,9,9,9,9,9,9,9,9,9,9,9,9,9,9,9,9,9,9,9,
+   9,9,9,9,9,9,9,9,9,9,9,9,9,9,9,9,9,9,9,9,9,9,9,9,
+   9,9,9,9,9,9,9,9,9,9,9,9,9,9,9,9,9,9,9,9,9,9,9,9,
+   9,9,9,9,9,9,9,9,9,9,9,9,9,9,9,9,7,7,7,7,7,7,7,7,
+   7,7,7,7,7,7,7,7,7,7,7,7,7,7,7,7,8,8,8,8,8,8,8,8,
+};
+static uint8 default_distance[32] =
 {
-   int i;   // use <= to match clearly with spec
-   for (i=0; i <= 143; ++i)     default_length[i]   = 8;
-   for (   ; i <= 255; ++i)     default_length[i]   = 9;
-   for (   ; i <= 279; ++i)     default_length[i]   = 7;
-   for (   ; i <= 287; ++i)     default_length[i]   = 8;
-
-   for (i=0; i <=  31; ++i)     default_distance[i] = 5;
-}
+   5,5,5,5,5,5,5,5,5,5,5,5,5,5,5,5,5,5,5,5,5,5,5,5,5,5,5,5,5,5,5,5
+};
 
 int stbi_png_partial; // a quick hack to only allow decoding some of a PNG... I should implement real streaming support instead
 static int parse_zlib(zbuf *a, int parse_header)
@@ -2277,7 +2290,6 @@ static int parse_zlib(zbuf *a, int parse_header)
       } else {
          if (type == 1) {
             // use fixed code lengths
-            if (!default_distance[31]) init_defaults();
             if (!zbuild_huffman(&a->z_length  , default_length  , 288)) return 0;
             if (!zbuild_huffman(&a->z_distance, default_distance,  32)) return 0;
          } else {
@@ -2525,8 +2537,9 @@ static int create_png_image(png *a, uint8 *raw, uint32 raw_len, int out_n, int i
    int save;
    if (!interlaced)
       return create_png_image_raw(a, raw, raw_len, out_n, a->s->img_x, a->s->img_y);
+   // only written if set, so concurrent decodes with partial loading disabled do not race on it
    save = stbi_png_partial;
-   stbi_png_partial = 0;
+   if (save) stbi_png_partial = 0;
 
    // de-interlacing
    final = (uint8 *) malloc(a->s->img_x * a->s->img_y * out_n);
@@ -2555,7 +2568,7 @@ static int create_png_image(png *a, uint8 *raw, uint32 raw_len, int out_n, int i
    }
    a->out = final;
 
-   stbi_png_partial = save;
+   if (save) stbi_png_partial = save;
    return 1;
 }
 
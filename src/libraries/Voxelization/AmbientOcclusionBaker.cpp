@@ -0,0 +1,194 @@
+#include "AmbientOcclusionBaker.h"
+
+#include <Utility/DebugLog.h>
+
+#include <cmath>
+
+using namespace Grid;
+
+// one cone along the normal, five cones tilted by 60 degrees around it, each with an aperture of 60 degrees
+static const int NUM_CONES = 6;
+static const float CONE_TAN_HALF_ANGLE = 0.577f;
+static const float CONE_TILT_COS = 0.5f;
+static const float CONE_TILT_SIN = 0.866f;
+static const float CONE_WEIGHTS[NUM_CONES] = { 0.25f, 0.15f, 0.15f, 0.15f, 0.15f, 0.15f };
+
+AmbientOcclusionBaker::AmbientOcclusionBaker()
+{
+	m_worldToVoxel = glm::mat4( 1.0f );
+	m_worldToVoxelNormal = glm::mat3( 1.0f );
+
+	m_maxDistance = 16.0f;
+	m_selfOcclusionOffset = 1.0f;
+	m_falloff = 0.1f;
+}
+
+AmbientOcclusionBaker::~AmbientOcclusionBaker()
+{
+}
+
+void AmbientOcclusionBaker::setVoxelGrid(const BitVoxelGrid& voxelGrid)
+{
+	m_worldToVoxel = voxelGrid.getWorldToVoxel();
+	m_worldToVoxelNormal = glm::transpose( glm::inverse( glm::mat3( m_worldToVoxel ) ) );
+
+	m_densityPyramid.update( voxelGrid );
+}
+
+float AmbientOcclusionBaker::traceCone(const glm::vec3& origin, const glm::vec3& direction, float tanHalfAngle) const
+{
+	float occlusion = 0.0f;
+	float distance = 1.0f;
+
+	while ( distance < m_maxDistance && occlusion < 1.0f )
+	{
+		// sample the level whose voxels match the cone diameter
+		float diameter = 2.0f * tanHalfAngle * distance;
+		if ( diameter < 1.0f )
+		{
+			diameter = 1.0f;
+		}
+		float level = std::log( diameter ) / std::log( 2.0f );
+
+		float density = m_densityPyramid.sampleLevel( level, origin + direction * distance );
+		float attenuation = 1.0f / ( 1.0f + m_falloff * distance );
+
+		occlusion += ( 1.0f - occlusion ) * density * attenuation;
+		distance += diameter * 0.5f;
+	}
+
+	return ( occlusion < 1.0f ) ? occlusion : 1.0f;
+}
+
+float AmbientOcclusionBaker::computeAmbientOcclusion(const glm::vec3& position, const glm::vec3& normal) const
+{
+	glm::vec3 gridPosition = glm::vec3( m_worldToVoxel * glm::vec4( position, 1.0f ) );
+	glm::vec3 gridNormal = m_worldToVoxelNormal * normal;
+
+	float normalLength = glm::length( gridNormal );
+	if ( normalLength <= 0.0f )
+	{
+		return 1.0f;
+	}
+	gridNormal /= normalLength;
+
+	// tangent frame around the normal
+	glm::vec3 helper = ( std::fabs( gridNormal.x ) < 0.9f ) ? glm::vec3( 1.0f, 0.0f, 0.0f ) : glm::vec3( 0.0f, 1.0f, 0.0f );
+	glm::vec3 tangent = glm::normalize( glm::cross( helper, gridNormal ) );
+	glm::vec3 bitangent = glm::cross( gridNormal, tangent );
+
+	glm::vec3 origin = gridPosition + gridNormal * m_selfOcclusionOffset;
+
+	float occlusion = CONE_WEIGHTS[0] * traceCone( origin, gridNormal, CONE_TAN_HALF_ANGLE );
+	for ( int i = 1; i < NUM_CONES; i++ )
+	{
+		float angle = 2.0f * 3.14159265f * (float) ( i - 1 ) / (float) ( NUM_CONES - 1 );
+		glm::vec3 direction = gridNormal * CONE_TILT_COS + ( tangent * std::cos( angle ) + bitangent * std::sin( angle ) ) * CONE_TILT_SIN;
+		occlusion += CONE_WEIGHTS[i] * traceCone( origin, direction, CONE_TAN_HALF_ANGLE );
+	}
+
+	return 1.0f - occlusion;
+}
+
+void AmbientOcclusionBaker::bakeVertices(const std::vector<glm::vec3>& positions, const std::vector<glm::vec3>& normals, std::vector<float>& ambientOcclusion, int tileSize) const
+{
+	if ( positions.size() != normals.size() )
+	{
+		DEBUGLOG->log("ERROR : AMBIENT OCCLUSION BAKER : amount of positions and normals differs");
+		ambientOcclusion.clear();
+		return;
+	}
+
+	ambientOcclusion.assign( positions.size(), 1.0f );
+	if ( m_densityPyramid.getNumLevels() == 0 )
+	{
+		DEBUGLOG->log("ERROR : AMBIENT OCCLUSION BAKER : no voxel grid set");
+		return;
+	}
+
+	tileSize = ( tileSize > 0 ) ? tileSize : 256;
+	int numSamples = (int) positions.size();
+	int numTiles = ( numSamples + tileSize - 1 ) / tileSize;
+
+	#pragma omp parallel for schedule(dynamic)
+	for ( int tile = 0; tile < numTiles; tile++ )
+	{
+		int end = ( ( tile + 1 ) * tileSize < numSamples ) ? ( tile + 1 ) * tileSize : numSamples;
+		for ( int i = tile * tileSize; i < end; i++ )
+		{
+			ambientOcclusion[i] = computeAmbientOcclusion( positions[i], normals[i] );
+		}
+	}
+}
+
+void AmbientOcclusionBaker::bakeLightmap(const std::vector<glm::vec4>& texelPositions, const std::vector<glm::vec3>& texelNormals, int width, int height, std::vector<float>& ambientOcclusion, int tileSize) const
+{
+	if ( (int) texelPositions.size() != width * height || (int) texelNormals.size() != width * height )
+	{
+		DEBUGLOG->log("ERROR : AMBIENT OCCLUSION BAKER : amount of texels does not match lightmap resolution");
+		ambientOcclusion.clear();
+		return;
+	}
+
+	ambientOcclusion.assign( texelPositions.size(), 1.0f );
+	if ( m_densityPyramid.getNumLevels() == 0 )
+	{
+		DEBUGLOG->log("ERROR : AMBIENT OCCLUSION BAKER : no voxel grid set");
+		return;
+	}
+
+	// square tiles, so neighbouring texels of a thread sample the same pyramid region
+	tileSize = ( tileSize > 0 ) ? tileSize : 16;
+	int numTilesX = ( width + tileSize - 1 ) / tileSize;
+	int numTilesY = ( height + tileSize - 1 ) / tileSize;
+	int numTiles = numTilesX * numTilesY;
+
+	#pragma omp parallel for schedule(dynamic)
+	for ( int tile = 0; tile < numTiles; tile++ )
+	{
+		int startX = ( tile % numTilesX ) * tileSize;
+		int startY = ( tile / numTilesX ) * tileSize;
+		int endX = ( startX + tileSize < width ) ? startX + tileSize : width;
+		int endY = ( startY + tileSize < height ) ? startY + tileSize : height;
+
+		for ( int y = startY; y < endY; y++ )
+		{
+			for ( int x = startX; x < endX; x++ )
+			{
+				int i = y * width + x;
+				if ( texelPositions[i].w != 0.0f )
+				{
+					ambientOcclusion[i] = computeAmbientOcclusion( glm::vec3( texelPositions[i] ), texelNormals[i] );
+				}
+			}
+		}
+	}
+}
+
+const DensityPyramid& AmbientOcclusionBaker::getDensityPyramid() const {
+	return m_densityPyramid;
+}
+
+float AmbientOcclusionBaker::getMaxDistance() const {
+	return m_maxDistance;
+}
+
+void AmbientOcclusionBaker::setMaxDistance(float maxDistance) {
+	m_maxDistance = maxDistance;
+}
+
+float AmbientOcclusionBaker::getSelfOcclusionOffset() const {
+	return m_selfOcclusionOffset;
+}
+
+void AmbientOcclusionBaker::setSelfOcclusionOffset(float selfOcclusionOffset) {
+	m_selfOcclusionOffset = selfOcclusionOffset;
+}
+
+float AmbientOcclusionBaker::getFalloff() const {
+	return m_falloff;
+}
+
+void AmbientOcclusionBaker::setFalloff(float falloff) {
+	m_falloff = falloff;
+}
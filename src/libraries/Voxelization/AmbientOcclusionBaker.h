@@ -0,0 +1,80 @@
+#ifndef AMBIENTOCCLUSIONBAKER_H
+#define AMBIENTOCCLUSIONBAKER_H
+
+#include <Voxelization/BitVoxelGrid.h>
+#include <Voxelization/DensityPyramid.h>
+
+#include <glm/glm.hpp>
+#include <vector>
+
+namespace Grid
+{
+	/**
+	 * This class bakes ambient occlusion from a voxel grid by tracing a few cones over the hemisphere of every sample
+	 * Cones sample the density pyramid of the grid on the level matching their diameter and accumulate occlusion front to back
+	 */
+	class AmbientOcclusionBaker
+	{
+	protected:
+		DensityPyramid m_densityPyramid;
+		glm::mat4 m_worldToVoxel;
+		glm::mat3 m_worldToVoxelNormal;	// inverse transpose of the upper 3x3 of m_worldToVoxel
+
+		float m_maxDistance;	// cone length in voxels
+		float m_selfOcclusionOffset;	// distance in voxels a cone starts away from the surface
+		float m_falloff;		// attenuation of occlusion with distance
+
+		/**
+		 * trace one cone through the density pyramid
+		 * @param origin in grid coordinates
+		 * @param direction normalized, in grid coordinates
+		 * @param tanHalfAngle tangent of half the cone aperture
+		 * @return occlusion in 0..1
+		 */
+		float traceCone( const glm::vec3& origin, const glm::vec3& direction, float tanHalfAngle ) const;
+
+		/**
+		 * compute ambient occlusion for a world position with a world normal
+		 */
+		float computeAmbientOcclusion( const glm::vec3& position, const glm::vec3& normal ) const;
+	public:
+		AmbientOcclusionBaker();
+		virtual ~AmbientOcclusionBaker();
+
+		/**
+		 * build the density pyramid of a voxel grid, must be called before baking and whenever the grid has changed
+		 * @param voxelGrid level 0 of the pyramid, must outlive the baker
+		 */
+		void setVoxelGrid( const BitVoxelGrid& voxelGrid );
+
+		/**
+		 * bake ambient occlusion at mesh vertices
+		 * @param positions in world coordinates
+		 * @param normals in world coordinates, one per position
+		 * @param ambientOcclusion will be resized and filled with one value per position, 1 means unoccluded
+		 * @param tileSize amount of consecutive vertices processed by a thread at once
+		 */
+		void bakeVertices( const std::vector< glm::vec3 >& positions, const std::vector< glm::vec3 >& normals, std::vector< float >& ambientOcclusion, int tileSize = 256 ) const;
+
+		/**
+		 * bake ambient occlusion into a lightmap, i.e. a texture atlas
+		 * @param texelPositions world position per texel, texels with w == 0 are not covered by the mesh
+		 * @param texelNormals world normal per texel
+		 * @param width of the lightmap
+		 * @param height of the lightmap
+		 * @param ambientOcclusion will be resized and filled with one value per texel, 1 for uncovered texels
+		 * @param tileSize side length of the square texel tiles processed by a thread at once
+		 */
+		void bakeLightmap( const std::vector< glm::vec4 >& texelPositions, const std::vector< glm::vec3 >& texelNormals, int width, int height, std::vector< float >& ambientOcclusion, int tileSize = 16 ) const;
+
+		const DensityPyramid& getDensityPyramid() const;
+		float getMaxDistance() const;
+		void setMaxDistance( float maxDistance );
+		float getSelfOcclusionOffset() const;
+		void setSelfOcclusionOffset( float selfOcclusionOffset );
+		float getFalloff() const;
+		void setFalloff( float falloff );
+	};
+}
+
+#endif
@@ -0,0 +1,199 @@
+#include "BitVoxelGrid.h"
+
+#include <Voxelization/VoxelGrid.h>
+#include <Utility/BitTools.h>
+#include <Utility/DebugLog.h>
+
+#include <glm/gtc/matrix_transform.hpp>
+
+using namespace Grid;
+
+BitVoxelGrid::BitVoxelGrid(int width, int height, int depth, glm::mat4 worldToVoxel)
+{
+	m_width = 0;
+	m_height = 0;
+	m_depth = 0;
+	m_numWordLayers = 0;
+	m_worldToVoxel = worldToVoxel;
+
+	resize( width, height, depth );
+}
+
+BitVoxelGrid::~BitVoxelGrid()
+{
+}
+
+void BitVoxelGrid::resize(int width, int height, int depth)
+{
+	if ( width < 0 || height < 0 || depth < 0 )
+	{
+		DEBUGLOG->log("ERROR : BIT VOXEL GRID : invalid resolution, grid will be empty");
+		width = 0;
+		height = 0;
+		depth = 0;
+	}
+
+	m_width = width;
+	m_height = height;
+	m_depth = depth;
+	m_numWordLayers = ( depth + 31 ) / 32;
+
+	m_words.assign( m_width * m_height * m_numWordLayers, 0u );
+}
+
+void BitVoxelGrid::clear()
+{
+	m_words.assign( m_words.size(), 0u );
+}
+
+bool BitVoxelGrid::checkCoordinates(int x, int y, int z) const
+{
+	return ( ( x >= 0 && x < m_width ) && ( y >= 0 && y < m_height ) && ( z >= 0 && z < m_depth ) );
+}
+
+bool BitVoxelGrid::isOccupied(int x, int y, int z) const
+{
+	if ( !checkCoordinates(x,y,z) )
+	{
+		return false;
+	}
+	return ( m_words[ getWordIndex( x, y, z >> 5 ) ] >> ( z & 31 ) ) & 1u;
+}
+
+void BitVoxelGrid::setOccupied(int x, int y, int z, bool occupied)
+{
+	if ( !checkCoordinates(x,y,z) )
+	{
+		return;
+	}
+
+	unsigned int& word = m_words[ getWordIndex( x, y, z >> 5 ) ];
+	if ( occupied )
+	{
+		word |= ( 1u << ( z & 31 ) );
+	}
+	else
+	{
+		word &= ~( 1u << ( z & 31 ) );
+	}
+}
+
+unsigned int BitVoxelGrid::getWord(int x, int y, int layer) const
+{
+	return m_words[ getWordIndex( x, y, layer ) ];
+}
+
+void BitVoxelGrid::setWord(int x, int y, int layer, unsigned int word)
+{
+	m_words[ getWordIndex( x, y, layer ) ] = word & getLayerMask( layer );
+}
+
+unsigned int BitVoxelGrid::getLayerMask(int layer) const
+{
+	return BitTools::getRangeMask( 0, m_depth - layer * 32 );
+}
+
+bool BitVoxelGrid::isCompatible(const BitVoxelGrid& other) const
+{
+	return ( m_width == other.m_width && m_height == other.m_height && m_depth == other.m_depth && m_worldToVoxel == other.m_worldToVoxel );
+}
+
+void BitVoxelGrid::setWordLayer(const unsigned int* words, int layer)
+{
+	if ( layer < 0 || layer >= m_numWordLayers )
+	{
+		DEBUGLOG->log("ERROR : BIT VOXEL GRID : word layer out of range : ", layer);
+		return;
+	}
+
+	unsigned int layerMask = getLayerMask( layer );
+	unsigned int* target = &m_words[ getWordIndex( 0, 0, layer ) ];
+	for ( int i = 0; i < m_width * m_height; i++ )
+	{
+		target[i] = words[i] & layerMask;
+	}
+}
+
+void BitVoxelGrid::readFromTexture(GLuint textureHandle, int layer, int level)
+{
+	GLint width = 0;
+	GLint height = 0;
+
+	glBindTexture( GL_TEXTURE_2D, textureHandle );
+	glGetTexLevelParameteriv( GL_TEXTURE_2D, level, GL_TEXTURE_WIDTH, &width );
+	glGetTexLevelParameteriv( GL_TEXTURE_2D, level, GL_TEXTURE_HEIGHT, &height );
+
+	if ( width != m_width || height != m_height )
+	{
+		DEBUGLOG->log("ERROR : BIT VOXEL GRID : texture resolution does not match grid resolution");
+		glBindTexture( GL_TEXTURE_2D, 0 );
+		return;
+	}
+
+	std::vector< GLuint > texels( width * height, 0 );
+	glGetTexImage( GL_TEXTURE_2D, level, GL_RED_INTEGER, GL_UNSIGNED_INT, &texels[0] );
+	glBindTexture( GL_TEXTURE_2D, 0 );
+
+	setWordLayer( &texels[0], layer );
+}
+
+void BitVoxelGrid::readFromAxisAlignedVoxelGrid(AxisAlignedVoxelGrid* axisAlignedVoxelGrid)
+{
+	resize( axisAlignedVoxelGrid->getWidth(), axisAlignedVoxelGrid->getHeight(), axisAlignedVoxelGrid->getDepth() );
+
+	float cellSize = axisAlignedVoxelGrid->getCellSize();
+	m_worldToVoxel =
+			glm::scale( glm::mat4( 1.0f ), glm::vec3( 1.0f / cellSize ) ) *
+			glm::translate( glm::mat4( 1.0f ), glm::vec3( - axisAlignedVoxelGrid->getX(), - axisAlignedVoxelGrid->getY(), - axisAlignedVoxelGrid->getZ() ) );
+
+	for ( int x = 0; x < m_width; x++ )
+	{
+		for ( int y = 0; y < m_height; y++ )
+		{
+			for ( int z = 0; z < m_depth; z++ )
+			{
+				GridCell* gridCell = axisAlignedVoxelGrid->VoxelGridCPU::getGridCell( x, y, z );
+				if ( gridCell && gridCell->isOccupied() )
+				{
+					m_words[ getWordIndex( x, y, z >> 5 ) ] |= ( 1u << ( z & 31 ) );
+				}
+			}
+		}
+	}
+}
+
+int BitVoxelGrid::getWidth() const {
+	return m_width;
+}
+
+int BitVoxelGrid::getHeight() const {
+	return m_height;
+}
+
+int BitVoxelGrid::getDepth() const {
+	return m_depth;
+}
+
+int BitVoxelGrid::getNumWordLayers() const {
+	return m_numWordLayers;
+}
+
+int BitVoxelGrid::getNumWords() const {
+	return (int) m_words.size();
+}
+
+const glm::mat4& BitVoxelGrid::getWorldToVoxel() const {
+	return m_worldToVoxel;
+}
+
+void BitVoxelGrid::setWorldToVoxel(const glm::mat4& worldToVoxel) {
+	m_worldToVoxel = worldToVoxel;
+}
+
+std::vector<unsigned int>& BitVoxelGrid::getWords() {
+	return m_words;
+}
+
+const std::vector<unsigned int>& BitVoxelGrid::getWords() const {
+	return m_words;
+}
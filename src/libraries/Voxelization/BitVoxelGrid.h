@@ -0,0 +1,105 @@
+#ifndef BITVOXELGRID_H
+#define BITVOXELGRID_H
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+#include <vector>
+
+namespace Grid
+{
+	class AxisAlignedVoxelGrid;
+
+	/**
+	 * This class represents a bit packed voxel grid on the CPU, laid out like a slice map
+	 * - every (x,y) column consists of depth bits, packed into 32 bit words ( bit i of word w represents z = w * 32 + i )
+	 * - word layer w of all columns is stored contiguously, just like one R32UI slice map texture
+	 */
+	class BitVoxelGrid
+	{
+	protected:
+		int m_width;			// amount of voxels in x direction
+		int m_height;			// amount of voxels in y direction
+		int m_depth;			// amount of voxels in z direction
+		int m_numWordLayers;	// amount of 32 bit words per column
+
+		glm::mat4 m_worldToVoxel;	// maps world coordinates to grid coordinates ( 0..width, 0..height, 0..depth )
+
+		std::vector< unsigned int > m_words;
+	public:
+		/**
+		 * @param width amount of voxels in x direction
+		 * @param height amount of voxels in y direction
+		 * @param depth amount of voxels in z direction
+		 * @param worldToVoxel transformation from world coordinates to grid coordinates
+		 */
+		BitVoxelGrid( int width = 0, int height = 0, int depth = 32, glm::mat4 worldToVoxel = glm::mat4( 1.0f ) );
+		virtual ~BitVoxelGrid();
+
+		/**
+		 * resize the grid, all voxels will be empty afterwards
+		 */
+		void resize( int width, int height, int depth );
+
+		/**
+		 * set all voxels to empty
+		 */
+		void clear();
+
+		bool checkCoordinates( int x, int y, int z ) const;
+
+		bool isOccupied( int x, int y, int z ) const;
+		void setOccupied( int x, int y, int z, bool occupied = true );
+
+		/**
+		 * @return index of the word containing voxels layer * 32 .. layer * 32 + 31 of column (x,y)
+		 */
+		inline int getWordIndex( int x, int y, int layer ) const { return ( layer * m_height + y ) * m_width + x; }
+
+		unsigned int getWord( int x, int y, int layer ) const;
+		void setWord( int x, int y, int layer, unsigned int word );
+
+		/**
+		 * @return mask of the bits in a word of this layer which lie inside the grid depth
+		 */
+		unsigned int getLayerMask( int layer ) const;
+
+		/**
+		 * @return true if both grids have the same resolution and the same mapping from world to voxel coordinates
+		 */
+		bool isCompatible( const BitVoxelGrid& other ) const;
+
+		/**
+		 * copy a word layer from a buffer laid out like a R32UI texture ( width * height words )
+		 * @param words to be copied
+		 * @param layer to be overwritten
+		 */
+		void setWordLayer( const unsigned int* words, int layer = 0 );
+
+		/**
+		 * read back a R32UI slice map texture into a word layer of this grid
+		 * @param textureHandle of a GL_TEXTURE_2D with GL_R32UI format and the same resolution as this grid
+		 * @param layer to be overwritten
+		 * @param level mipmap level to read back
+		 */
+		void readFromTexture( GLuint textureHandle, int layer = 0, int level = 0 );
+
+		/**
+		 * copy occupancy from a grid cell based voxel grid, adopting its resolution and world mapping
+		 */
+		void readFromAxisAlignedVoxelGrid( AxisAlignedVoxelGrid* axisAlignedVoxelGrid );
+
+		int getWidth() const;
+		int getHeight() const;
+		int getDepth() const;
+		int getNumWordLayers() const;
+		int getNumWords() const;
+
+		const glm::mat4& getWorldToVoxel() const;
+		void setWorldToVoxel( const glm::mat4& worldToVoxel );
+
+		std::vector< unsigned int >& getWords();
+		const std::vector< unsigned int >& getWords() const;
+	};
+}
+
+#endif
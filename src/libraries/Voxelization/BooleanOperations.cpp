@@ -0,0 +1,117 @@
+#include "BooleanOperations.h"
+
+#include <Utility/DebugLog.h>
+
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+using namespace Grid;
+
+static const int WORDS_PER_TASK = 4096;	// amount of words combined by a thread at once
+
+static inline unsigned int combineWord( unsigned int first, unsigned int second, BooleanOperation operation )
+{
+	switch ( operation )
+	{
+	case BOOLEAN_UNION:
+		return first | second;
+	case BOOLEAN_INTERSECTION:
+		return first & second;
+	case BOOLEAN_DIFFERENCE:
+		return first & ~second;
+	default:
+		return first ^ second;
+	}
+}
+
+#ifdef __AVX2__
+static inline __m256i combineWords( __m256i first, __m256i second, BooleanOperation operation )
+{
+	switch ( operation )
+	{
+	case BOOLEAN_UNION:
+		return _mm256_or_si256( first, second );
+	case BOOLEAN_INTERSECTION:
+		return _mm256_and_si256( first, second );
+	case BOOLEAN_DIFFERENCE:
+		return _mm256_andnot_si256( second, first );
+	default:
+		return _mm256_xor_si256( first, second );
+	}
+}
+#endif
+
+/**
+ * combine numWords words, result may alias first or second
+ */
+static void combine( const unsigned int* first, const unsigned int* second, unsigned int* result, int numWords, BooleanOperation operation )
+{
+	int numTasks = ( numWords + WORDS_PER_TASK - 1 ) / WORDS_PER_TASK;
+
+	#pragma omp parallel for schedule(static)
+	for ( int task = 0; task < numTasks; task++ )
+	{
+		int i = task * WORDS_PER_TASK;
+		int end = ( i + WORDS_PER_TASK < numWords ) ? i + WORDS_PER_TASK : numWords;
+
+#ifdef __AVX2__
+		for ( ; i + 8 <= end; i += 8 )
+		{
+			__m256i a = _mm256_loadu_si256( (const __m256i*) ( first + i ) );
+			__m256i b = _mm256_loadu_si256( (const __m256i*) ( second + i ) );
+			_mm256_storeu_si256( (__m256i*) ( result + i ), combineWords( a, b, operation ) );
+		}
+#endif
+		for ( ; i < end; i++ )
+		{
+			result[i] = combineWord( first[i], second[i], operation );
+		}
+	}
+}
+
+bool Grid::applyBooleanOperation(BitVoxelGrid& target, const BitVoxelGrid& other, BooleanOperation operation)
+{
+	if ( !target.isCompatible( other ) )
+	{
+		DEBUGLOG->log("ERROR : BOOLEAN OPERATION : grids differ in resolution or world mapping");
+		return false;
+	}
+	if ( target.getNumWords() == 0 )
+	{
+		return true;
+	}
+
+	combine( &target.getWords()[0], &other.getWords()[0], &target.getWords()[0], target.getNumWords(), operation );
+
+	return true;
+}
+
+bool Grid::applyBooleanOperation(const BitVoxelGrid& first, const BitVoxelGrid& second, BitVoxelGrid& result, BooleanOperation operation)
+{
+	if ( !first.isCompatible( second ) )
+	{
+		DEBUGLOG->log("ERROR : BOOLEAN OPERATION : grids differ in resolution or world mapping");
+		return false;
+	}
+
+	if ( &result == &first )
+	{
+		return applyBooleanOperation( result, second, operation );
+	}
+
+	if ( result.getWidth() != first.getWidth() || result.getHeight() != first.getHeight() || result.getDepth() != first.getDepth() )
+	{
+		result.resize( first.getWidth(), first.getHeight(), first.getDepth() );
+	}
+	result.setWorldToVoxel( first.getWorldToVoxel() );
+
+	if ( first.getNumWords() == 0 )
+	{
+		return true;
+	}
+
+	combine( &first.getWords()[0], &second.getWords()[0], &result.getWords()[0], first.getNumWords(), operation );
+
+	return true;
+}
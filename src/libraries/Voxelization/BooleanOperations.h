@@ -0,0 +1,31 @@
+#ifndef BOOLEANOPERATIONS_H
+#define BOOLEANOPERATIONS_H
+
+#include <Voxelization/BitVoxelGrid.h>
+
+namespace Grid
+{
+	enum BooleanOperation { BOOLEAN_UNION, BOOLEAN_INTERSECTION, BOOLEAN_DIFFERENCE, BOOLEAN_XOR };
+
+	/**
+	 * combine two compatible grids voxel by voxel, in place
+	 * the word array is split into chunks of 4096 words which are distributed over threads, within a chunk words are combined 8 at a time using AVX2 if available
+	 * @param target first operand, will be overwritten with the result
+	 * @param other second operand, must have the same resolution and world mapping as target
+	 * @param operation BOOLEAN_DIFFERENCE keeps voxels of target which are not occupied in other
+	 * @return false if the grids are not compatible
+	 */
+	bool applyBooleanOperation( BitVoxelGrid& target, const BitVoxelGrid& other, BooleanOperation operation );
+
+	/**
+	 * combine two compatible grids voxel by voxel, out of place
+	 * @param first operand
+	 * @param second operand, must have the same resolution and world mapping as first
+	 * @param result will be resized if necessary and overwritten with the result
+	 * @param operation BOOLEAN_DIFFERENCE keeps voxels of first which are not occupied in second
+	 * @return false if the grids are not compatible
+	 */
+	bool applyBooleanOperation( const BitVoxelGrid& first, const BitVoxelGrid& second, BitVoxelGrid& result, BooleanOperation operation );
+}
+
+#endif
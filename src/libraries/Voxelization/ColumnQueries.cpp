@@ -0,0 +1,118 @@
+#include "ColumnQueries.h"
+
+#include <Utility/BitTools.h>
+
+using namespace Grid;
+
+int Grid::findFirstOccupied(const unsigned int* words, int width, int height, int numLayers, int x, int y, int startDepth, ColumnDirection direction)
+{
+	if ( x < 0 || y < 0 || x >= width || y >= height )
+	{
+		return -1;
+	}
+
+	int layerSize = width * height;
+	const unsigned int* column = words + y * width + x;
+	int depth = numLayers * 32;
+
+	if ( direction == COLUMN_POSITIVE_Z )
+	{
+		if ( startDepth >= depth )
+		{
+			return -1;
+		}
+		startDepth = ( startDepth < 0 ) ? 0 : startDepth;
+
+		// ignore bits below the start depth in the first word
+		unsigned int word = column[ ( startDepth >> 5 ) * layerSize ] & ( 0xFFFFFFFFu << ( startDepth & 31 ) );
+		for ( int layer = startDepth >> 5; ; )
+		{
+			if ( word )
+			{
+				return layer * 32 + BitTools::countTrailingZeros( word );
+			}
+			if ( ++layer >= numLayers )
+			{
+				return -1;
+			}
+			word = column[ layer * layerSize ];
+		}
+	}
+
+	if ( startDepth < 0 )
+	{
+		return -1;
+	}
+	startDepth = ( startDepth >= depth ) ? depth - 1 : startDepth;
+
+	// ignore bits above the start depth in the first word
+	unsigned int word = column[ ( startDepth >> 5 ) * layerSize ] & ( 0xFFFFFFFFu >> ( 31 - ( startDepth & 31 ) ) );
+	for ( int layer = startDepth >> 5; ; )
+	{
+		if ( word )
+		{
+			return layer * 32 + 31 - BitTools::countLeadingZeros( word );
+		}
+		if ( --layer < 0 )
+		{
+			return -1;
+		}
+		word = column[ layer * layerSize ];
+	}
+}
+
+int Grid::findFirstOccupied(const BitVoxelGrid& voxelGrid, int x, int y, int startDepth, ColumnDirection direction)
+{
+	if ( voxelGrid.getNumWords() == 0 )
+	{
+		return -1;
+	}
+	return findFirstOccupied( &voxelGrid.getWords()[0], voxelGrid.getWidth(), voxelGrid.getHeight(), voxelGrid.getNumWordLayers(), x, y, startDepth, direction );
+}
+
+void Grid::findFirstOccupied(const unsigned int* words, int width, int height, int numLayers, const glm::ivec2* columns, const int* startDepths, int numQueries, ColumnDirection direction, int* results)
+{
+	#pragma omp parallel for schedule(static)
+	for ( int i = 0; i < numQueries; i++ )
+	{
+		results[i] = findFirstOccupied( words, width, height, numLayers, columns[i].x, columns[i].y, startDepths[i], direction );
+	}
+}
+
+void Grid::findFirstOccupied(const BitVoxelGrid& voxelGrid, const glm::ivec2* columns, const int* startDepths, int numQueries, ColumnDirection direction, int* results)
+{
+	if ( voxelGrid.getNumWords() == 0 )
+	{
+		for ( int i = 0; i < numQueries; i++ )
+		{
+			results[i] = -1;
+		}
+		return;
+	}
+	findFirstOccupied( &voxelGrid.getWords()[0], voxelGrid.getWidth(), voxelGrid.getHeight(), voxelGrid.getNumWordLayers(), columns, startDepths, numQueries, direction, results );
+}
+
+void Grid::extractHeightmap(const BitVoxelGrid& voxelGrid, std::vector<int>& heights, ColumnDirection direction)
+{
+	int width = voxelGrid.getWidth();
+	int height = voxelGrid.getHeight();
+	heights.assign( width * height, -1 );
+
+	if ( voxelGrid.getNumWords() == 0 )
+	{
+		return;
+	}
+
+	const unsigned int* words = &voxelGrid.getWords()[0];
+	int numLayers = voxelGrid.getNumWordLayers();
+	int startDepth = ( direction == COLUMN_POSITIVE_Z ) ? 0 : voxelGrid.getDepth() - 1;
+
+	#pragma omp parallel for schedule(static)
+	for ( int y = 0; y < height; y++ )
+	{
+		for ( int x = 0; x < width; x++ )
+		{
+			heights[ y * width + x ] = findFirstOccupied( words, width, height, numLayers, x, y, startDepth, direction );
+		}
+	}
+}
@@ -0,0 +1,66 @@
+#ifndef COLUMNQUERIES_H
+#define COLUMNQUERIES_H
+
+#include <Voxelization/BitVoxelGrid.h>
+
+#include <glm/glm.hpp>
+#include <vector>
+
+namespace Grid
+{
+	/**
+	 * direction in which a column is searched
+	 */
+	enum ColumnDirection { COLUMN_POSITIVE_Z, COLUMN_NEGATIVE_Z };
+
+	/**
+	 * find the first occupied voxel of a column, starting at a depth
+	 * every word of the column is masked to the bits at or beyond the start depth and scanned with a single
+	 * count trailing zeros ( +z ) or count leading zeros ( -z ) instruction
+	 * @param words slice map words laid out like a BitVoxelGrid, i.e. read back R32UI textures of width * height words each
+	 * @param width amount of columns in x direction
+	 * @param height amount of columns in y direction
+	 * @param numLayers amount of words per column
+	 * @param x column
+	 * @param y column
+	 * @param startDepth first voxel to be tested, clamped to the column
+	 * @param direction to search in
+	 * @return depth of the first occupied voxel, -1 if there is none
+	 */
+	int findFirstOccupied( const unsigned int* words, int width, int height, int numLayers, int x, int y, int startDepth, ColumnDirection direction );
+
+	/**
+	 * @see findFirstOccupied, padding bits beyond the grid depth are always empty
+	 */
+	int findFirstOccupied( const BitVoxelGrid& voxelGrid, int x, int y, int startDepth, ColumnDirection direction );
+
+	/**
+	 * answer a batch of column queries in parallel
+	 * @param words slice map words laid out like a BitVoxelGrid
+	 * @param width amount of columns in x direction
+	 * @param height amount of columns in y direction
+	 * @param numLayers amount of words per column
+	 * @param columns (x,y) of every query, columns outside of the grid yield -1
+	 * @param startDepths first voxel to be tested per query
+	 * @param numQueries amount of queries
+	 * @param direction to search in
+	 * @param results will be filled with the depth of the first occupied voxel per query, -1 if there is none
+	 */
+	void findFirstOccupied( const unsigned int* words, int width, int height, int numLayers, const glm::ivec2* columns, const int* startDepths, int numQueries, ColumnDirection direction, int* results );
+
+	/**
+	 * @see findFirstOccupied
+	 */
+	void findFirstOccupied( const BitVoxelGrid& voxelGrid, const glm::ivec2* columns, const int* startDepths, int numQueries, ColumnDirection direction, int* results );
+
+	/**
+	 * find the first occupied voxel of every column, searching from the grid border in a direction
+	 * i.e. COLUMN_NEGATIVE_Z yields the highest occupied voxel of every column
+	 * @param voxelGrid to be searched
+	 * @param heights will be resized to width * height and filled with the depth per column ( index y * width + x ), -1 for empty columns
+	 * @param direction to search in
+	 */
+	void extractHeightmap( const BitVoxelGrid& voxelGrid, std::vector< int >& heights, ColumnDirection direction = COLUMN_NEGATIVE_Z );
+}
+
+#endif
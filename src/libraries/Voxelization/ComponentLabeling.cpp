@@ -0,0 +1,427 @@
+#include "ComponentLabeling.h"
+
+#include <Utility/BitTools.h>
+#include <Utility/DebugLog.h>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+using namespace Grid;
+
+/**
+ * find the runs of a column
+ * @param runs to be filled, may be 0 to only count the runs
+ * @return amount of runs
+ */
+static int findRuns( const BitVoxelGrid& voxelGrid, int x, int y, VoxelRun* runs )
+{
+	int numRuns = 0;
+	int runBegin = -1;
+
+	for ( int layer = 0; layer < voxelGrid.getNumWordLayers(); layer++ )
+	{
+		unsigned int word = voxelGrid.getWords()[ voxelGrid.getWordIndex( x, y, layer ) ];
+		int bit = 0;
+		while ( bit < 32 )
+		{
+			if ( runBegin < 0 )
+			{
+				unsigned int remaining = word >> bit;
+				if ( remaining == 0 )
+				{
+					break;
+				}
+				bit += BitTools::countTrailingZeros( remaining );
+				runBegin = layer * 32 + bit;
+			}
+			else
+			{
+				unsigned int remaining = ( ~word ) >> bit;
+				if ( remaining == 0 )
+				{
+					// run continues in the next layer
+					break;
+				}
+				bit += BitTools::countTrailingZeros( remaining );
+				if ( runs )
+				{
+					runs[ numRuns ].m_begin = runBegin;
+					runs[ numRuns ].m_end = layer * 32 + bit;
+				}
+				numRuns++;
+				runBegin = -1;
+			}
+		}
+	}
+
+	if ( runBegin >= 0 )
+	{
+		if ( runs )
+		{
+			runs[ numRuns ].m_begin = runBegin;
+			runs[ numRuns ].m_end = voxelGrid.getDepth();
+		}
+		numRuns++;
+	}
+
+	return numRuns;
+}
+
+static inline int findRoot( int* parent, int i )
+{
+	while ( parent[i] != i )
+	{
+		parent[i] = parent[ parent[i] ];
+		i = parent[i];
+	}
+	return i;
+}
+
+/**
+ * merge the sets of two runs, the lower index always becomes the root
+ */
+static inline void unite( int* parent, int a, int b )
+{
+	a = findRoot( parent, a );
+	b = findRoot( parent, b );
+	if ( a < b )
+	{
+		parent[b] = a;
+	}
+	else if ( b < a )
+	{
+		parent[a] = b;
+	}
+}
+
+/**
+ * merge all runs of two columns which touch each other
+ * @param reach 0 if runs must overlap in z, 1 if touching diagonally is sufficient
+ */
+static void connectColumns( const VoxelRun* runs, const int* columnRunStart, int* parent, int column, int neighbourColumn, int reach )
+{
+	int i = columnRunStart[ column ];
+	int iEnd = columnRunStart[ column + 1 ];
+	int j = columnRunStart[ neighbourColumn ];
+	int jEnd = columnRunStart[ neighbourColumn + 1 ];
+
+	while ( i < iEnd && j < jEnd )
+	{
+		if ( runs[i].m_begin < runs[j].m_end + reach && runs[j].m_begin < runs[i].m_end + reach )
+		{
+			unite( parent, i, j );
+		}
+
+		if ( runs[i].m_end < runs[j].m_end )
+		{
+			i++;
+		}
+		else
+		{
+			j++;
+		}
+	}
+}
+
+/**
+ * merge all runs of column (x,y) with the runs of its preceding neighbours
+ * @param sameRow whether to merge with the neighbour in row y
+ * @param previousRow whether to merge with the neighbours in row y - 1
+ */
+static void connectNeighbours( const VoxelRun* runs, const int* columnRunStart, int* parent, int width, int x, int y, bool sameRow, bool previousRow, Connectivity connectivity )
+{
+	int column = y * width + x;
+	int reach = ( connectivity == CONNECTIVITY_26 ) ? 1 : 0;
+
+	if ( sameRow && x > 0 )
+	{
+		connectColumns( runs, columnRunStart, parent, column, column - 1, reach );
+	}
+	if ( !previousRow )
+	{
+		return;
+	}
+
+	connectColumns( runs, columnRunStart, parent, column, column - width, reach );
+	if ( connectivity == CONNECTIVITY_26 )
+	{
+		if ( x > 0 )
+		{
+			connectColumns( runs, columnRunStart, parent, column, column - width - 1, reach );
+		}
+		if ( x + 1 < width )
+		{
+			connectColumns( runs, columnRunStart, parent, column, column - width + 1, reach );
+		}
+	}
+}
+
+ConnectedComponent::ConnectedComponent()
+{
+	m_numVoxels = 0;
+	m_min = glm::ivec3( 0 );
+	m_max = glm::ivec3( 0 );
+}
+
+ComponentLabeling::ComponentLabeling()
+{
+	m_width = 0;
+	m_height = 0;
+	m_depth = 0;
+	m_worldToVoxel = glm::mat4( 1.0f );
+}
+
+ComponentLabeling::~ComponentLabeling()
+{
+}
+
+int ComponentLabeling::compute(const BitVoxelGrid& voxelGrid, Connectivity connectivity)
+{
+	m_width = voxelGrid.getWidth();
+	m_height = voxelGrid.getHeight();
+	m_depth = voxelGrid.getDepth();
+	m_worldToVoxel = voxelGrid.getWorldToVoxel();
+
+	m_runs.clear();
+	m_runLabels.clear();
+	m_components.clear();
+	m_columnRunStart.assign( m_width * m_height + 1, 0 );
+
+	if ( voxelGrid.getNumWords() == 0 )
+	{
+		return 0;
+	}
+
+	int width = m_width;
+	int height = m_height;
+	int numColumns = width * height;
+
+	// count runs per column, then fill them at their prefix sum offsets
+	#pragma omp parallel for schedule(static)
+	for ( int y = 0; y < height; y++ )
+	{
+		for ( int x = 0; x < width; x++ )
+		{
+			m_columnRunStart[ y * width + x + 1 ] = findRuns( voxelGrid, x, y, 0 );
+		}
+	}
+	for ( int i = 0; i < numColumns; i++ )
+	{
+		m_columnRunStart[ i + 1 ] += m_columnRunStart[i];
+	}
+
+	int numRuns = m_columnRunStart[ numColumns ];
+	if ( numRuns == 0 )
+	{
+		return 0;
+	}
+	m_runs.resize( numRuns );
+
+	#pragma omp parallel for schedule(static)
+	for ( int y = 0; y < height; y++ )
+	{
+		for ( int x = 0; x < width; x++ )
+		{
+			findRuns( voxelGrid, x, y, &m_runs[ m_columnRunStart[ y * width + x ] ] );
+		}
+	}
+
+	std::vector< int > parents( numRuns );
+	for ( int i = 0; i < numRuns; i++ )
+	{
+		parents[i] = i;
+	}
+
+	const VoxelRun* runs = &m_runs[0];
+	const int* columnRunStart = &m_columnRunStart[0];
+	int* parent = &parents[0];
+
+	// blocks of rows only touch the union find entries of their own runs
+	int numBlocks = 1;
+#ifdef _OPENMP
+	numBlocks = omp_get_max_threads() * 4;
+#endif
+	numBlocks = ( numBlocks < height ) ? numBlocks : height;
+	int rowsPerBlock = ( height + numBlocks - 1 ) / numBlocks;
+	numBlocks = ( height + rowsPerBlock - 1 ) / rowsPerBlock;
+
+	#pragma omp parallel for schedule(dynamic)
+	for ( int block = 0; block < numBlocks; block++ )
+	{
+		int yBegin = block * rowsPerBlock;
+		int yEnd = ( yBegin + rowsPerBlock < height ) ? yBegin + rowsPerBlock : height;
+		for ( int y = yBegin; y < yEnd; y++ )
+		{
+			for ( int x = 0; x < width; x++ )
+			{
+				connectNeighbours( runs, columnRunStart, parent, width, x, y, true, y > yBegin, connectivity );
+			}
+		}
+	}
+
+	// merge across block boundaries
+	for ( int block = 1; block < numBlocks; block++ )
+	{
+		int y = block * rowsPerBlock;
+		for ( int x = 0; x < width; x++ )
+		{
+			connectNeighbours( runs, columnRunStart, parent, width, x, y, false, true, connectivity );
+		}
+	}
+
+	// roots are the lowest run of their set, so they are labeled before any other run of the set
+	m_runLabels.resize( numRuns );
+	for ( int i = 0; i < numRuns; i++ )
+	{
+		int root = findRoot( parent, i );
+		if ( root == i )
+		{
+			m_runLabels[i] = (int) m_components.size();
+			m_components.push_back( ConnectedComponent() );
+		}
+		else
+		{
+			m_runLabels[i] = m_runLabels[ root ];
+		}
+	}
+
+	// component statistics
+	for ( int column = 0; column < numColumns; column++ )
+	{
+		int x = column % width;
+		int y = column / width;
+		for ( int i = m_columnRunStart[ column ]; i < m_columnRunStart[ column + 1 ]; i++ )
+		{
+			ConnectedComponent& component = m_components[ m_runLabels[i] ];
+			glm::ivec3 runMin( x, y, m_runs[i].m_begin );
+			glm::ivec3 runMax( x, y, m_runs[i].m_end - 1 );
+			if ( component.m_numVoxels == 0 )
+			{
+				component.m_min = runMin;
+				component.m_max = runMax;
+			}
+			else
+			{
+				component.m_min = glm::min( component.m_min, runMin );
+				component.m_max = glm::max( component.m_max, runMax );
+			}
+			component.m_numVoxels += m_runs[i].m_end - m_runs[i].m_begin;
+		}
+	}
+
+	return (int) m_components.size();
+}
+
+int ComponentLabeling::getNumComponents() const {
+	return (int) m_components.size();
+}
+
+const std::vector<ConnectedComponent>& ComponentLabeling::getComponents() const {
+	return m_components;
+}
+
+int ComponentLabeling::getLabel(int x, int y, int z) const
+{
+	if ( x < 0 || x >= m_width || y < 0 || y >= m_height || m_runs.empty() )
+	{
+		return -1;
+	}
+
+	int column = y * m_width + x;
+	for ( int i = m_columnRunStart[ column ]; i < m_columnRunStart[ column + 1 ]; i++ )
+	{
+		if ( z >= m_runs[i].m_begin && z < m_runs[i].m_end )
+		{
+			return m_runLabels[i];
+		}
+	}
+	return -1;
+}
+
+int ComponentLabeling::getLargestComponent() const
+{
+	int largest = -1;
+	for ( unsigned int i = 0; i < m_components.size(); i++ )
+	{
+		if ( largest < 0 || m_components[i].m_numVoxels > m_components[ largest ].m_numVoxels )
+		{
+			largest = (int) i;
+		}
+	}
+	return largest;
+}
+
+void ComponentLabeling::extractRuns(const std::vector<char>& keepComponent, BitVoxelGrid& target) const
+{
+	target.resize( m_width, m_height, m_depth );
+	target.setWorldToVoxel( m_worldToVoxel );
+
+	if ( m_runs.empty() )
+	{
+		return;
+	}
+
+	unsigned int* words = &target.getWords()[0];
+	int width = m_width;
+	int height = m_height;
+
+	#pragma omp parallel for schedule(static)
+	for ( int y = 0; y < height; y++ )
+	{
+		for ( int x = 0; x < width; x++ )
+		{
+			int column = y * width + x;
+			for ( int i = m_columnRunStart[ column ]; i < m_columnRunStart[ column + 1 ]; i++ )
+			{
+				if ( !keepComponent[ m_runLabels[i] ] )
+				{
+					continue;
+				}
+
+				// set the bits of the run word by word
+				int z = m_runs[i].m_begin;
+				while ( z < m_runs[i].m_end )
+				{
+					int layer = z >> 5;
+					int count = ( ( layer + 1 ) * 32 < m_runs[i].m_end ) ? ( layer + 1 ) * 32 - z : m_runs[i].m_end - z;
+					words[ target.getWordIndex( x, y, layer ) ] |= BitTools::getRangeMask( z & 31, count );
+					z += count;
+				}
+			}
+		}
+	}
+}
+
+void ComponentLabeling::extractComponent(int label, BitVoxelGrid& target) const
+{
+	if ( label < 0 || label >= (int) m_components.size() )
+	{
+		DEBUGLOG->log("ERROR : COMPONENT LABELING : no such component : ", label);
+		return;
+	}
+
+	std::vector< char > keepComponent( m_components.size(), 0 );
+	keepComponent[ label ] = 1;
+
+	extractRuns( keepComponent, target );
+}
+
+void ComponentLabeling::extractComponents(unsigned int minNumVoxels, BitVoxelGrid& target) const
+{
+	std::vector< char > keepComponent( m_components.size(), 0 );
+	for ( unsigned int i = 0; i < m_components.size(); i++ )
+	{
+		keepComponent[i] = ( m_components[i].m_numVoxels >= minNumVoxels ) ? 1 : 0;
+	}
+
+	extractRuns( keepComponent, target );
+}
+
+const std::vector<VoxelRun>& ComponentLabeling::getRuns() const {
+	return m_runs;
+}
+
+const std::vector<int>& ComponentLabeling::getRunLabels() const {
+	return m_runLabels;
+}
@@ -0,0 +1,100 @@
+#ifndef COMPONENTLABELING_H
+#define COMPONENTLABELING_H
+
+#include <Voxelization/BitVoxelGrid.h>
+
+#include <glm/glm.hpp>
+#include <vector>
+
+namespace Grid
+{
+	enum Connectivity { CONNECTIVITY_6, CONNECTIVITY_26 };
+
+	/**
+	 * Consecutive occupied voxels of a column
+	 */
+	class VoxelRun
+	{
+	public:
+		int m_begin;	// first occupied z
+		int m_end;		// first empty z after the run
+	};
+
+	/**
+	 * Statistics of one connected component
+	 */
+	class ConnectedComponent
+	{
+	public:
+		unsigned int m_numVoxels;
+		glm::ivec3 m_min;	// lowest occupied voxel coordinates
+		glm::ivec3 m_max;	// highest occupied voxel coordinates
+
+		ConnectedComponent();
+	};
+
+	/**
+	 * This class labels the connected components of a bit voxel grid
+	 * - the occupied voxels of every column are split into runs along z
+	 * - runs are merged with union find, rows of columns are processed in parallel blocks,
+	 *   runs across block boundaries are merged in a sequential pass afterwards
+	 * - components are labeled 0..n-1 in order of their first voxel ( y, x, z )
+	 */
+	class ComponentLabeling
+	{
+	protected:
+		int m_width;
+		int m_height;
+		int m_depth;
+		glm::mat4 m_worldToVoxel;
+
+		std::vector< int > m_columnRunStart;	// index of the first run of column y * width + x, width * height + 1 entries
+		std::vector< VoxelRun > m_runs;
+		std::vector< int > m_runLabels;
+		std::vector< ConnectedComponent > m_components;
+
+		/**
+		 * copy all runs whose component should be kept into a grid
+		 */
+		void extractRuns( const std::vector< char >& keepComponent, BitVoxelGrid& target ) const;
+	public:
+		ComponentLabeling();
+		virtual ~ComponentLabeling();
+
+		/**
+		 * label the connected components of a voxel grid
+		 * @param voxelGrid to be labeled
+		 * @param connectivity whether voxels sharing only an edge or a corner are connected as well
+		 * @return amount of connected components
+		 */
+		int compute( const BitVoxelGrid& voxelGrid, Connectivity connectivity = CONNECTIVITY_6 );
+
+		int getNumComponents() const;
+		const std::vector< ConnectedComponent >& getComponents() const;
+
+		/**
+		 * @return label of the component containing voxel (x,y,z), -1 if the voxel is empty
+		 */
+		int getLabel( int x, int y, int z ) const;
+
+		/**
+		 * @return label of the component with the most voxels, -1 if there are no components
+		 */
+		int getLargestComponent() const;
+
+		/**
+		 * write all voxels of one component into a grid, adopting resolution and world mapping of the labeled grid
+		 */
+		void extractComponent( int label, BitVoxelGrid& target ) const;
+
+		/**
+		 * write all voxels of components with at least minNumVoxels voxels into a grid, i.e. to remove floating debris
+		 */
+		void extractComponents( unsigned int minNumVoxels, BitVoxelGrid& target ) const;
+
+		const std::vector< VoxelRun >& getRuns() const;
+		const std::vector< int >& getRunLabels() const;
+	};
+}
+
+#endif
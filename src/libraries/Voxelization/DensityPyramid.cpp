@@ -0,0 +1,143 @@
+#include "DensityPyramid.h"
+
+#include <cmath>
+
+using namespace Grid;
+
+DensityPyramid::DensityPyramid()
+{
+	p_voxelGrid = 0;
+}
+
+DensityPyramid::~DensityPyramid()
+{
+}
+
+void DensityPyramid::update(const BitVoxelGrid& voxelGrid)
+{
+	p_voxelGrid = 0;
+	m_levels.clear();
+	m_resolutions.clear();
+
+	if ( voxelGrid.getNumWords() == 0 )
+	{
+		return;
+	}
+
+	p_voxelGrid = &voxelGrid;
+	glm::ivec3 resolution( voxelGrid.getWidth(), voxelGrid.getHeight(), voxelGrid.getDepth() );
+	m_resolutions.push_back( resolution );
+
+	// level k + 1 : average 2x2x2 voxels of level k, rounded to 8 bits
+	while ( resolution.x > 1 || resolution.y > 1 || resolution.z > 1 )
+	{
+		glm::ivec3 sourceResolution = resolution;
+		resolution = glm::ivec3( ( resolution.x + 1 ) / 2, ( resolution.y + 1 ) / 2, ( resolution.z + 1 ) / 2 );
+
+		m_resolutions.push_back( resolution );
+		m_levels.push_back( std::vector< unsigned char >( resolution.x * resolution.y * resolution.z, 0 ) );
+
+		const unsigned char* source = ( m_levels.size() > 1 ) ? &m_levels[ m_levels.size() - 2 ][0] : 0;
+		const unsigned int* words = &voxelGrid.getWords()[0];
+		unsigned char* target = &m_levels.back()[0];
+		int width = resolution.x;
+		int height = resolution.y;
+		int depth = resolution.z;
+
+		#pragma omp parallel for schedule(static)
+		for ( int z = 0; z < depth; z++ )
+		{
+			for ( int y = 0; y < height; y++ )
+			{
+				for ( int x = 0; x < width; x++ )
+				{
+					// voxels outside of the source level count as empty
+					unsigned int sum = 0;
+					for ( int sy = 2 * y; sy < 2 * y + 2 && sy < sourceResolution.y; sy++ )
+					{
+						for ( int sx = 2 * x; sx < 2 * x + 2 && sx < sourceResolution.x; sx++ )
+						{
+							if ( !source )
+							{
+								// level 1 : the two voxels 2z and 2z + 1 share a word, padding bits are never set
+								unsigned int bits = ( words[ voxelGrid.getWordIndex( sx, sy, ( 2 * z ) >> 5 ) ] >> ( ( 2 * z ) & 31 ) ) & 3u;
+								sum += ( ( bits & 1u ) + ( bits >> 1 ) ) * 255u;
+								continue;
+							}
+							for ( int sz = 2 * z; sz < 2 * z + 2 && sz < sourceResolution.z; sz++ )
+							{
+								sum += source[ ( sz * sourceResolution.y + sy ) * sourceResolution.x + sx ];
+							}
+						}
+					}
+					target[ ( z * height + y ) * width + x ] = (unsigned char) ( ( sum + 4u ) / 8u );
+				}
+			}
+		}
+	}
+}
+
+int DensityPyramid::getNumLevels() const {
+	return (int) m_resolutions.size();
+}
+
+const glm::ivec3& DensityPyramid::getResolution(int level) const {
+	return m_resolutions[level];
+}
+
+float DensityPyramid::getDensity(int level, int x, int y, int z) const
+{
+	const glm::ivec3& resolution = m_resolutions[level];
+	if ( x < 0 || x >= resolution.x || y < 0 || y >= resolution.y || z < 0 || z >= resolution.z )
+	{
+		return 0.0f;
+	}
+	if ( level == 0 )
+	{
+		return (float) ( ( p_voxelGrid->getWords()[ p_voxelGrid->getWordIndex( x, y, z >> 5 ) ] >> ( z & 31 ) ) & 1u );
+	}
+	return (float) m_levels[ level - 1 ][ ( z * resolution.y + y ) * resolution.x + x ] * ( 1.0f / 255.0f );
+}
+
+float DensityPyramid::sample(int level, const glm::vec3& position) const
+{
+	// voxel centers of this level lie at ( i + 0.5 ) * 2^level
+	float scale = 1.0f / (float) ( 1 << level );
+	glm::vec3 levelPosition = position * scale - glm::vec3( 0.5f );
+	glm::vec3 base = glm::floor( levelPosition );
+	glm::vec3 f = levelPosition - base;
+
+	int x = (int) base.x;
+	int y = (int) base.y;
+	int z = (int) base.z;
+
+	float c00 = getDensity( level, x, y, z )         * ( 1.0f - f.x ) + getDensity( level, x + 1, y, z )         * f.x;
+	float c10 = getDensity( level, x, y + 1, z )     * ( 1.0f - f.x ) + getDensity( level, x + 1, y + 1, z )     * f.x;
+	float c01 = getDensity( level, x, y, z + 1 )     * ( 1.0f - f.x ) + getDensity( level, x + 1, y, z + 1 )     * f.x;
+	float c11 = getDensity( level, x, y + 1, z + 1 ) * ( 1.0f - f.x ) + getDensity( level, x + 1, y + 1, z + 1 ) * f.x;
+
+	float c0 = c00 * ( 1.0f - f.y ) + c10 * f.y;
+	float c1 = c01 * ( 1.0f - f.y ) + c11 * f.y;
+
+	return c0 * ( 1.0f - f.z ) + c1 * f.z;
+}
+
+float DensityPyramid::sampleLevel(float level, const glm::vec3& position) const
+{
+	if ( m_resolutions.empty() )
+	{
+		return 0.0f;
+	}
+
+	float maxLevel = (float) ( m_resolutions.size() - 1 );
+	level = ( level < 0.0f ) ? 0.0f : ( ( level > maxLevel ) ? maxLevel : level );
+
+	int lower = (int) std::floor( level );
+	float f = level - (float) lower;
+	if ( f <= 0.0f || lower + 1 >= (int) m_resolutions.size() )
+	{
+		return sample( lower, position );
+	}
+
+	return sample( lower, position ) * ( 1.0f - f ) + sample( lower + 1, position ) * f;
+}
@@ -0,0 +1,63 @@
+#ifndef DENSITYPYRAMID_H
+#define DENSITYPYRAMID_H
+
+#include <Voxelization/BitVoxelGrid.h>
+
+#include <glm/glm.hpp>
+#include <vector>
+
+namespace Grid
+{
+	/**
+	 * This class represents a density mip pyramid of a bit voxel grid
+	 * - level 0 is read from the grid itself, a voxel has density 1 if it is occupied, 0 otherwise
+	 * - a voxel of level k + 1 has the average density of the 2x2x2 voxels of level k it covers
+	 * - densities of level 1 and above are stored with 8 bits, i.e. rounded to multiples of 1 / 255
+	 * - the pyramid ends with a level of 1x1x1 voxels
+	 */
+	class DensityPyramid
+	{
+	protected:
+		const BitVoxelGrid* p_voxelGrid;						// level 0, not owned
+		std::vector< std::vector< unsigned char > > m_levels;	// level 1 .. n, density * 255, index : ( z * height + y ) * width + x
+		std::vector< glm::ivec3 > m_resolutions;				// level 0 .. n
+	public:
+		DensityPyramid();
+		virtual ~DensityPyramid();
+
+		/**
+		 * rebuild all levels from a voxel grid, must be called whenever the voxel grid has changed
+		 * @param voxelGrid level 0, must outlive the pyramid
+		 */
+		void update( const BitVoxelGrid& voxelGrid );
+
+		/**
+		 * @return amount of levels, including level 0
+		 */
+		int getNumLevels() const;
+
+		const glm::ivec3& getResolution( int level ) const;
+
+		/**
+		 * @return density of voxel (x,y,z) of the given level, 0 outside of the grid
+		 */
+		float getDensity( int level, int x, int y, int z ) const;
+
+		/**
+		 * trilinearly interpolated density of a level
+		 * @param level of the pyramid
+		 * @param position in level 0 grid coordinates
+		 * @return density, positions outside of the grid are considered empty
+		 */
+		float sample( int level, const glm::vec3& position ) const;
+
+		/**
+		 * density interpolated between the two levels enclosing a fractional level
+		 * @param level fractional pyramid level, clamped to the available levels
+		 * @param position in level 0 grid coordinates
+		 */
+		float sampleLevel( float level, const glm::vec3& position ) const;
+	};
+}
+
+#endif
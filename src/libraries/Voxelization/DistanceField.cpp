@@ -0,0 +1,304 @@
+#include "DistanceField.h"
+
+#include <Utility/DebugLog.h>
+
+#include <cmath>
+#include <cstring>
+
+using namespace Grid;
+
+static const float DISTANCE_INFINITY = 1.0e20f;
+
+/**
+ * 1D squared distance transform of a sampled function ( Felzenszwalb & Huttenlocher )
+ * @param f sampled function, n values
+ * @param d output, n values
+ * @param v scratch buffer, n values
+ * @param z scratch buffer, n + 1 values
+ */
+static void distanceTransform1D( const float* f, float* d, int* v, float* z, int n )
+{
+	int k = 0;
+	v[0] = 0;
+	z[0] = -DISTANCE_INFINITY;
+	z[1] = DISTANCE_INFINITY;
+
+	// lower envelope of parabolas
+	for ( int q = 1; q < n; q++ )
+	{
+		float s = ( ( f[q] + (float) ( q * q ) ) - ( f[ v[k] ] + (float) ( v[k] * v[k] ) ) ) / (float) ( 2 * q - 2 * v[k] );
+		while ( s <= z[k] )
+		{
+			k--;
+			s = ( ( f[q] + (float) ( q * q ) ) - ( f[ v[k] ] + (float) ( v[k] * v[k] ) ) ) / (float) ( 2 * q - 2 * v[k] );
+		}
+		k++;
+		v[k] = q;
+		z[k] = s;
+		z[k + 1] = DISTANCE_INFINITY;
+	}
+
+	k = 0;
+	for ( int q = 0; q < n; q++ )
+	{
+		while ( z[k + 1] < (float) q )
+		{
+			k++;
+		}
+		d[q] = (float) ( ( q - v[k] ) * ( q - v[k] ) ) + f[ v[k] ];
+	}
+}
+
+/**
+ * transform all rows of a volume along one axis in parallel
+ * @param data volume, transformed in place
+ * @param length amount of values per row
+ * @param stride distance between neighbouring values of a row
+ * @param numRows amount of rows
+ * @param rowsPerBlock amount of rows starting at consecutive indices
+ * @param blockStride distance between the starts of neighbouring blocks of rows
+ */
+static void transformRows( float* data, int length, int stride, int numRows, int rowsPerBlock, int blockStride )
+{
+	#pragma omp parallel
+	{
+		std::vector< float > f( length );
+		std::vector< float > d( length );
+		std::vector< int > v( length );
+		std::vector< float > z( length + 1 );
+
+		#pragma omp for schedule(static)
+		for ( int row = 0; row < numRows; row++ )
+		{
+			float* start = data + ( row % rowsPerBlock ) + ( row / rowsPerBlock ) * blockStride;
+
+			for ( int i = 0; i < length; i++ )
+			{
+				f[i] = start[ i * stride ];
+			}
+
+			distanceTransform1D( &f[0], &d[0], &v[0], &z[0], length );
+
+			for ( int i = 0; i < length; i++ )
+			{
+				start[ i * stride ] = d[i];
+			}
+		}
+	}
+}
+
+/**
+ * convert a float to a 16 bit half float, rounding to nearest
+ */
+static unsigned short floatToHalf( float value )
+{
+	unsigned int bits;
+	std::memcpy( &bits, &value, sizeof( bits ) );
+
+	unsigned short sign = (unsigned short) ( ( bits >> 16 ) & 0x8000u );
+	int exponent = (int) ( ( bits >> 23 ) & 0xFFu ) - 127 + 15;
+	unsigned int mantissa = bits & 0x007FFFFFu;
+
+	if ( exponent >= 31 )
+	{
+		// too large, infinity
+		return (unsigned short) ( sign | 0x7C00u );
+	}
+	if ( exponent <= 0 )
+	{
+		if ( exponent < -10 )
+		{
+			return sign;
+		}
+		// denormalized
+		mantissa |= 0x00800000u;
+		unsigned int shift = (unsigned int) ( 14 - exponent );
+		unsigned int halfMantissa = mantissa >> shift;
+		if ( ( mantissa >> ( shift - 1 ) ) & 1u )
+		{
+			halfMantissa++;
+		}
+		return (unsigned short) ( sign | halfMantissa );
+	}
+
+	unsigned int half = ( (unsigned int) exponent << 10 ) | ( mantissa >> 13 );
+	if ( mantissa & 0x00001000u )
+	{
+		// rounding may carry into the exponent, which is still correct
+		half++;
+	}
+	return (unsigned short) ( sign | half );
+}
+
+DistanceField::DistanceField()
+{
+	m_width = 0;
+	m_height = 0;
+	m_depth = 0;
+	m_signed = false;
+	m_worldToVoxel = glm::mat4( 1.0f );
+}
+
+DistanceField::~DistanceField()
+{
+}
+
+void DistanceField::computeSquaredDistances(const BitVoxelGrid& voxelGrid, bool toOccupied, std::vector<float>& squaredDistances) const
+{
+	int width = m_width;
+	int height = m_height;
+	int depth = m_depth;
+
+	squaredDistances.resize( width * height * depth );
+	float* data = &squaredDistances[0];
+	const unsigned int* words = &voxelGrid.getWords()[0];
+
+	// initialize : 0 at target voxels, infinity elsewhere
+	#pragma omp parallel for schedule(static)
+	for ( int y = 0; y < height; y++ )
+	{
+		for ( int x = 0; x < width; x++ )
+		{
+			for ( int z = 0; z < depth; z++ )
+			{
+				bool occupied = ( ( words[ voxelGrid.getWordIndex( x, y, z >> 5 ) ] >> ( z & 31 ) ) & 1u ) != 0;
+				data[ ( z * height + y ) * width + x ] = ( occupied == toOccupied ) ? 0.0f : DISTANCE_INFINITY;
+			}
+		}
+	}
+
+	// x rows are contiguous, y rows lie within a z slice, z rows span all slices
+	transformRows( data, width, 1, height * depth, 1, width );
+	transformRows( data, height, width, width * depth, width, width * height );
+	transformRows( data, depth, width * height, width * height, width * height, 0 );
+}
+
+void DistanceField::compute(const BitVoxelGrid& voxelGrid, bool isSigned)
+{
+	m_width = voxelGrid.getWidth();
+	m_height = voxelGrid.getHeight();
+	m_depth = voxelGrid.getDepth();
+	m_signed = isSigned;
+	m_worldToVoxel = voxelGrid.getWorldToVoxel();
+
+	if ( voxelGrid.getNumWords() == 0 || m_depth == 0 )
+	{
+		DEBUGLOG->log("ERROR : DISTANCE FIELD : voxel grid is empty");
+		m_distances.clear();
+		return;
+	}
+
+	computeSquaredDistances( voxelGrid, true, m_distances );
+
+	std::vector< float > insideDistances;
+	if ( m_signed )
+	{
+		computeSquaredDistances( voxelGrid, false, insideDistances );
+	}
+
+	int numVoxels = (int) m_distances.size();
+
+	#pragma omp parallel for schedule(static)
+	for ( int i = 0; i < numVoxels; i++ )
+	{
+		float distance = std::sqrt( m_distances[i] );
+		if ( m_signed && m_distances[i] == 0.0f )
+		{
+			distance = - std::sqrt( insideDistances[i] );
+		}
+		m_distances[i] = distance;
+	}
+}
+
+float DistanceField::getDistance(int x, int y, int z) const
+{
+	x = ( x < 0 ) ? 0 : ( ( x >= m_width ) ? m_width - 1 : x );
+	y = ( y < 0 ) ? 0 : ( ( y >= m_height ) ? m_height - 1 : y );
+	z = ( z < 0 ) ? 0 : ( ( z >= m_depth ) ? m_depth - 1 : z );
+	return m_distances[ getIndex( x, y, z ) ];
+}
+
+float DistanceField::sample(const glm::vec3& worldPosition) const
+{
+	if ( m_distances.empty() )
+	{
+		return DISTANCE_INFINITY;
+	}
+
+	// voxel centers lie at i + 0.5
+	glm::vec3 position = glm::vec3( m_worldToVoxel * glm::vec4( worldPosition, 1.0f ) ) - glm::vec3( 0.5f );
+	glm::vec3 base = glm::floor( position );
+	glm::vec3 f = position - base;
+
+	int x = (int) base.x;
+	int y = (int) base.y;
+	int z = (int) base.z;
+
+	float c00 = getDistance( x, y, z )         * ( 1.0f - f.x ) + getDistance( x + 1, y, z )         * f.x;
+	float c10 = getDistance( x, y + 1, z )     * ( 1.0f - f.x ) + getDistance( x + 1, y + 1, z )     * f.x;
+	float c01 = getDistance( x, y, z + 1 )     * ( 1.0f - f.x ) + getDistance( x + 1, y, z + 1 )     * f.x;
+	float c11 = getDistance( x, y + 1, z + 1 ) * ( 1.0f - f.x ) + getDistance( x + 1, y + 1, z + 1 ) * f.x;
+
+	float c0 = c00 * ( 1.0f - f.y ) + c10 * f.y;
+	float c1 = c01 * ( 1.0f - f.y ) + c11 * f.y;
+
+	return c0 * ( 1.0f - f.z ) + c1 * f.z;
+}
+
+void DistanceField::quantizeHalf(std::vector<unsigned short>& halfDistances) const
+{
+	halfDistances.resize( m_distances.size() );
+	int numVoxels = (int) m_distances.size();
+
+	#pragma omp parallel for schedule(static)
+	for ( int i = 0; i < numVoxels; i++ )
+	{
+		halfDistances[i] = floatToHalf( m_distances[i] );
+	}
+}
+
+void DistanceField::quantizeByte(std::vector<unsigned char>& byteDistances, float maxDistance) const
+{
+	byteDistances.resize( m_distances.size() );
+	if ( maxDistance <= 0.0f )
+	{
+		DEBUGLOG->log("ERROR : DISTANCE FIELD : maximum distance must be positive");
+		return;
+	}
+
+	int numVoxels = (int) m_distances.size();
+	float scale = ( m_signed ) ? 0.5f / maxDistance : 1.0f / maxDistance;
+	float offset = ( m_signed ) ? 0.5f : 0.0f;
+
+	#pragma omp parallel for schedule(static)
+	for ( int i = 0; i < numVoxels; i++ )
+	{
+		float normalized = m_distances[i] * scale + offset;
+		normalized = ( normalized < 0.0f ) ? 0.0f : ( ( normalized > 1.0f ) ? 1.0f : normalized );
+		byteDistances[i] = (unsigned char) ( normalized * 255.0f + 0.5f );
+	}
+}
+
+int DistanceField::getWidth() const {
+	return m_width;
+}
+
+int DistanceField::getHeight() const {
+	return m_height;
+}
+
+int DistanceField::getDepth() const {
+	return m_depth;
+}
+
+bool DistanceField::isSigned() const {
+	return m_signed;
+}
+
+const glm::mat4& DistanceField::getWorldToVoxel() const {
+	return m_worldToVoxel;
+}
+
+const std::vector<float>& DistanceField::getDistances() const {
+	return m_distances;
+}
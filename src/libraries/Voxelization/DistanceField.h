@@ -0,0 +1,80 @@
+#ifndef DISTANCEFIELD_H
+#define DISTANCEFIELD_H
+
+#include <Voxelization/BitVoxelGrid.h>
+
+#include <glm/glm.hpp>
+#include <vector>
+
+namespace Grid
+{
+	/**
+	 * This class represents a euclidean distance field of a bit voxel grid
+	 * Distances are exact distances between voxel centers in voxel units, computed with the separable
+	 * distance transform of Felzenszwalb & Huttenlocher, one pass per axis, rows of a pass in parallel
+	 * - unsigned : distance of every voxel to the nearest occupied voxel ( 0 for occupied voxels )
+	 * - signed : distance to the nearest occupied voxel outside, negative distance to the nearest empty voxel inside
+	 */
+	class DistanceField
+	{
+	protected:
+		int m_width;
+		int m_height;
+		int m_depth;
+		bool m_signed;
+		glm::mat4 m_worldToVoxel;
+
+		std::vector< float > m_distances;	// index : ( z * height + y ) * width + x
+
+		/**
+		 * compute squared distances to the nearest voxel with the given occupancy
+		 */
+		void computeSquaredDistances( const BitVoxelGrid& voxelGrid, bool toOccupied, std::vector< float >& squaredDistances ) const;
+	public:
+		DistanceField();
+		virtual ~DistanceField();
+
+		/**
+		 * compute the distance field of a voxel grid, adopting its resolution and world mapping
+		 * @param voxelGrid to compute the distance field of
+		 * @param isSigned whether distances inside of occupied regions should be negative
+		 */
+		void compute( const BitVoxelGrid& voxelGrid, bool isSigned = false );
+
+		inline int getIndex( int x, int y, int z ) const { return ( z * m_height + y ) * m_width + x; }
+
+		/**
+		 * @return distance of voxel (x,y,z) in voxel units, coordinates are clamped to the grid
+		 */
+		float getDistance( int x, int y, int z ) const;
+
+		/**
+		 * trilinearly interpolated distance at a world position, in voxel units
+		 */
+		float sample( const glm::vec3& worldPosition ) const;
+
+		/**
+		 * convert all distances to 16 bit half floats, i.e. for a GL_R16F texture
+		 * @param halfDistances will be resized and filled with one value per voxel
+		 */
+		void quantizeHalf( std::vector< unsigned short >& halfDistances ) const;
+
+		/**
+		 * convert all distances to 8 bit values, i.e. for a GL_R8 texture
+		 * unsigned : 0..maxDistance is mapped to 0..255
+		 * signed : -maxDistance..maxDistance is mapped to 0..255, so the surface lies at 127.5
+		 * @param byteDistances will be resized and filled with one value per voxel
+		 * @param maxDistance distance mapped to 255, larger distances are clamped
+		 */
+		void quantizeByte( std::vector< unsigned char >& byteDistances, float maxDistance ) const;
+
+		int getWidth() const;
+		int getHeight() const;
+		int getDepth() const;
+		bool isSigned() const;
+		const glm::mat4& getWorldToVoxel() const;
+		const std::vector< float >& getDistances() const;
+	};
+}
+
+#endif
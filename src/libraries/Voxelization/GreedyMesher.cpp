@@ -0,0 +1,417 @@
+#include "GreedyMesher.h"
+
+#include <Resources/Model.h>
+#include <Utility/DebugLog.h>
+
+#include <algorithm>
+#include <fstream>
+
+using namespace Grid;
+
+VoxelMesh::VoxelMesh()
+{
+}
+
+VoxelMesh::~VoxelMesh()
+{
+}
+
+void VoxelMesh::clear()
+{
+	m_positions.clear();
+	m_normals.clear();
+	m_indices.clear();
+}
+
+int VoxelMesh::getNumVertices() const {
+	return (int) m_positions.size();
+}
+
+int VoxelMesh::getNumIndices() const {
+	return (int) m_indices.size();
+}
+
+int VoxelMesh::getNumQuads() const {
+	return (int) m_indices.size() / 6;
+}
+
+void VoxelMesh::addQuad(const glm::vec3& p0, const glm::vec3& p1, const glm::vec3& p2, const glm::vec3& p3, const glm::vec3& normal)
+{
+	unsigned int base = (unsigned int) m_positions.size();
+
+	m_positions.push_back( p0 );
+	m_positions.push_back( p1 );
+	m_positions.push_back( p2 );
+	m_positions.push_back( p3 );
+	m_normals.insert( m_normals.end(), 4, normal );
+
+	m_indices.push_back( base );
+	m_indices.push_back( base + 1 );
+	m_indices.push_back( base + 2 );
+	m_indices.push_back( base );
+	m_indices.push_back( base + 2 );
+	m_indices.push_back( base + 3 );
+}
+
+unsigned int VoxelMesh::addVertex(const glm::vec3& position, const glm::vec3& normal)
+{
+	m_positions.push_back( position );
+	m_normals.push_back( normal );
+	return (unsigned int) m_positions.size() - 1;
+}
+
+void VoxelMesh::addQuad(unsigned int i0, unsigned int i1, unsigned int i2, unsigned int i3)
+{
+	m_indices.push_back( i0 );
+	m_indices.push_back( i1 );
+	m_indices.push_back( i2 );
+	m_indices.push_back( i0 );
+	m_indices.push_back( i2 );
+	m_indices.push_back( i3 );
+}
+
+void VoxelMesh::append(const std::vector<VoxelMesh>& meshes)
+{
+	int numMeshes = (int) meshes.size();
+	std::vector< unsigned int > vertexOffsets( numMeshes + 1, (unsigned int) m_positions.size() );
+	std::vector< unsigned int > indexOffsets( numMeshes + 1, (unsigned int) m_indices.size() );
+	for ( int i = 0; i < numMeshes; i++ )
+	{
+		vertexOffsets[ i + 1 ] = vertexOffsets[i] + meshes[i].getNumVertices();
+		indexOffsets[ i + 1 ] = indexOffsets[i] + meshes[i].getNumIndices();
+	}
+
+	m_positions.resize( vertexOffsets[ numMeshes ] );
+	m_normals.resize( vertexOffsets[ numMeshes ] );
+	m_indices.resize( indexOffsets[ numMeshes ] );
+
+	#pragma omp parallel for schedule(dynamic)
+	for ( int i = 0; i < numMeshes; i++ )
+	{
+		const VoxelMesh& mesh = meshes[i];
+		std::copy( mesh.m_positions.begin(), mesh.m_positions.end(), m_positions.begin() + vertexOffsets[i] );
+		std::copy( mesh.m_normals.begin(), mesh.m_normals.end(), m_normals.begin() + vertexOffsets[i] );
+		for ( unsigned int j = 0; j < mesh.m_indices.size(); j++ )
+		{
+			m_indices[ indexOffsets[i] + j ] = mesh.m_indices[j] + vertexOffsets[i];
+		}
+	}
+}
+
+Model* VoxelMesh::createModel() const
+{
+	if ( m_indices.empty() )
+	{
+		DEBUGLOG->log("WARNING : VOXEL MESH : mesh is empty, no model created");
+		return 0;
+	}
+
+	Model* model = new Model();
+	model->setNumVertices( getNumVertices() );
+	model->setNumIndices( getNumIndices() );
+	model->setNumFaces( getNumIndices() / 3 );
+
+	// buffer handle
+	GLuint buffer = 0;
+
+	glGenVertexArrays(1, &buffer);
+	glBindVertexArray(buffer);
+	model->setVAOHandle( buffer );
+
+	buffer = 0;
+	glGenBuffers(1, &buffer);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, buffer);
+	glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(GLuint) * m_indices.size(), &m_indices[0], GL_STATIC_DRAW);
+	model->setIndexBufferHandle( buffer );
+
+	buffer = 0;
+	glGenBuffers(1, &buffer);
+	glBindBuffer(GL_ARRAY_BUFFER, buffer);
+	glBufferData(GL_ARRAY_BUFFER, sizeof(glm::vec3) * m_positions.size(), &m_positions[0], GL_STATIC_DRAW);
+	glEnableVertexAttribArray(0);
+	glVertexAttribPointer(0, 3, GL_FLOAT, 0, 0, 0);
+	model->setVertexBufferHandle( buffer );
+
+	buffer = 0;
+	glGenBuffers(1, &buffer);
+	glBindBuffer(GL_ARRAY_BUFFER, buffer);
+	glBufferData(GL_ARRAY_BUFFER, sizeof(glm::vec3) * m_normals.size(), &m_normals[0], GL_STATIC_DRAW);
+	glEnableVertexAttribArray(2);
+	glVertexAttribPointer(2, 3, GL_FLOAT, 0, 0, 0);
+	model->setNormalBufferHandle( buffer );
+
+	glBindVertexArray(0);
+
+	DEBUGLOG->log("Buffered voxel mesh quads : ", getNumQuads());
+
+	return model;
+}
+
+bool VoxelMesh::writeToObj(std::string path) const
+{
+	std::ofstream file( path.c_str() );
+	if ( !file.is_open() )
+	{
+		DEBUGLOG->log("ERROR : VOXEL MESH : could not open file for writing : " + path);
+		return false;
+	}
+
+	for ( unsigned int i = 0; i < m_positions.size(); i++ )
+	{
+		file << "v " << m_positions[i].x << " " << m_positions[i].y << " " << m_positions[i].z << "\n";
+	}
+	for ( unsigned int i = 0; i < m_normals.size(); i++ )
+	{
+		file << "vn " << m_normals[i].x << " " << m_normals[i].y << " " << m_normals[i].z << "\n";
+	}
+	// obj indices start at 1
+	for ( unsigned int i = 0; i + 2 < m_indices.size(); i += 3 )
+	{
+		file << "f";
+		for ( int k = 0; k < 3; k++ )
+		{
+			file << " " << m_indices[ i + k ] + 1 << "//" << m_indices[ i + k ] + 1;
+		}
+		file << "\n";
+	}
+
+	return true;
+}
+
+std::vector<glm::vec3>& VoxelMesh::getPositions() {
+	return m_positions;
+}
+
+const std::vector<glm::vec3>& VoxelMesh::getPositions() const {
+	return m_positions;
+}
+
+std::vector<glm::vec3>& VoxelMesh::getNormals() {
+	return m_normals;
+}
+
+const std::vector<glm::vec3>& VoxelMesh::getNormals() const {
+	return m_normals;
+}
+
+std::vector<unsigned int>& VoxelMesh::getIndices() {
+	return m_indices;
+}
+
+const std::vector<unsigned int>& VoxelMesh::getIndices() const {
+	return m_indices;
+}
+
+/**
+ * occupancy of a chunk including a border of one voxel, one byte per voxel
+ */
+struct ChunkOccupancy
+{
+	glm::ivec3 m_size;	// padded size
+	std::vector< unsigned char > m_voxels;
+
+	inline bool isOccupied( const glm::ivec3& p ) const { return m_voxels[ ( ( p.z + 1 ) * m_size.y + ( p.y + 1 ) ) * m_size.x + ( p.x + 1 ) ] != 0; }
+};
+
+/**
+ * copy the occupancy of a chunk and its border from the grid words
+ * @return amount of occupied voxels inside the chunk
+ */
+static int readChunk( const BitVoxelGrid& voxelGrid, const glm::ivec3& origin, const glm::ivec3& size, ChunkOccupancy& chunk )
+{
+	chunk.m_size = size + glm::ivec3( 2 );
+	chunk.m_voxels.assign( chunk.m_size.x * chunk.m_size.y * chunk.m_size.z, 0 );
+
+	const unsigned int* words = &voxelGrid.getWords()[0];
+	int numOccupied = 0;
+
+	for ( int y = 0; y < chunk.m_size.y; y++ )
+	{
+		int gridY = origin.y + y - 1;
+		if ( gridY < 0 || gridY >= voxelGrid.getHeight() )
+		{
+			continue;
+		}
+		for ( int x = 0; x < chunk.m_size.x; x++ )
+		{
+			int gridX = origin.x + x - 1;
+			if ( gridX < 0 || gridX >= voxelGrid.getWidth() )
+			{
+				continue;
+			}
+			for ( int z = 0; z < chunk.m_size.z; z++ )
+			{
+				int gridZ = origin.z + z - 1;
+				if ( gridZ < 0 || gridZ >= voxelGrid.getDepth() )
+				{
+					continue;
+				}
+				unsigned int bit = ( words[ voxelGrid.getWordIndex( gridX, gridY, gridZ >> 5 ) ] >> ( gridZ & 31 ) ) & 1u;
+				chunk.m_voxels[ ( z * chunk.m_size.y + y ) * chunk.m_size.x + x ] = (unsigned char) bit;
+
+				if ( bit && x > 0 && y > 0 && z > 0 && x <= size.x && y <= size.y && z <= size.z )
+				{
+					numOccupied++;
+				}
+			}
+		}
+	}
+
+	return numOccupied;
+}
+
+/**
+ * greedily merge the faces of all slices of a chunk
+ * @param normals world space normals of the directions +x, -x, +y, -y, +z, -z
+ * @param flipWinding whether the voxel to world mapping mirrors the grid
+ */
+static void meshChunk( const ChunkOccupancy& chunk, const glm::ivec3& origin, const glm::ivec3& size, const glm::mat4& voxelToWorld, const glm::vec3* normals, bool flipWinding, std::vector< unsigned char >& mask, VoxelMesh& mesh )
+{
+	for ( int d = 0; d < 3; d++ )
+	{
+		int u = ( d + 1 ) % 3;
+		int v = ( d + 2 ) % 3;
+		int numU = size[u];
+		int numV = size[v];
+		mask.resize( numU * numV );
+
+		for ( int direction = 0; direction < 2; direction++ )
+		{
+			int sign = ( direction == 0 ) ? 1 : -1;
+			bool counterClockwise = ( direction == 0 ) != flipWinding;
+			glm::ivec3 offset( 0 );
+			offset[d] = sign;
+
+			for ( int s = 0; s < size[d]; s++ )
+			{
+				// a face is visible where an occupied voxel has an empty neighbour
+				glm::ivec3 p;
+				p[d] = s;
+				for ( int j = 0; j < numV; j++ )
+				{
+					p[v] = j;
+					for ( int i = 0; i < numU; i++ )
+					{
+						p[u] = i;
+						mask[ j * numU + i ] = ( chunk.isOccupied( p ) && !chunk.isOccupied( p + offset ) ) ? 1 : 0;
+					}
+				}
+
+				for ( int j = 0; j < numV; j++ )
+				{
+					for ( int i = 0; i < numU; )
+					{
+						if ( !mask[ j * numU + i ] )
+						{
+							i++;
+							continue;
+						}
+
+						// grow the rectangle along u, then along v as long as whole rows are set
+						int w = 1;
+						while ( i + w < numU && mask[ j * numU + i + w ] )
+						{
+							w++;
+						}
+						int h = 1;
+						for ( ; j + h < numV; h++ )
+						{
+							int k = 0;
+							while ( k < w && mask[ ( j + h ) * numU + i + k ] )
+							{
+								k++;
+							}
+							if ( k < w )
+							{
+								break;
+							}
+						}
+						for ( int l = 0; l < h; l++ )
+						{
+							std::fill( mask.begin() + ( j + l ) * numU + i, mask.begin() + ( j + l ) * numU + i + w, 0 );
+						}
+
+						glm::vec3 corner[4];
+						for ( int c = 0; c < 4; c++ )
+						{
+							corner[c][d] = (float) ( origin[d] + s + ( ( direction == 0 ) ? 1 : 0 ) );
+							corner[c][u] = (float) ( origin[u] + i + ( ( c == 1 || c == 2 ) ? w : 0 ) );
+							corner[c][v] = (float) ( origin[v] + j + ( ( c >= 2 ) ? h : 0 ) );
+							corner[c] = glm::vec3( voxelToWorld * glm::vec4( corner[c], 1.0f ) );
+						}
+
+						if ( counterClockwise )
+						{
+							mesh.addQuad( corner[0], corner[1], corner[2], corner[3], normals[ d * 2 + direction ] );
+						}
+						else
+						{
+							mesh.addQuad( corner[0], corner[3], corner[2], corner[1], normals[ d * 2 + direction ] );
+						}
+
+						i += w;
+					}
+				}
+			}
+		}
+	}
+}
+
+int Grid::extractGreedyMesh(const BitVoxelGrid& voxelGrid, VoxelMesh& mesh, int chunkSize)
+{
+	mesh.clear();
+
+	if ( chunkSize <= 0 )
+	{
+		DEBUGLOG->log("ERROR : GREEDY MESHER : chunk size must be positive : ", chunkSize);
+		return 0;
+	}
+	if ( voxelGrid.getNumWords() == 0 )
+	{
+		return 0;
+	}
+
+	glm::ivec3 gridSize( voxelGrid.getWidth(), voxelGrid.getHeight(), voxelGrid.getDepth() );
+	glm::ivec3 numChunks = ( gridSize + glm::ivec3( chunkSize - 1 ) ) / chunkSize;
+	int totalChunks = numChunks.x * numChunks.y * numChunks.z;
+
+	glm::mat4 voxelToWorld = glm::inverse( voxelGrid.getWorldToVoxel() );
+	glm::mat3 normalMatrix = glm::transpose( glm::mat3( voxelGrid.getWorldToVoxel() ) );
+	glm::mat3 axes( voxelToWorld );
+	bool flipWinding = glm::dot( glm::cross( axes[0], axes[1] ), axes[2] ) < 0.0f;
+
+	glm::vec3 normals[6];
+	for ( int d = 0; d < 3; d++ )
+	{
+		glm::vec3 axis( 0.0f );
+		axis[d] = 1.0f;
+		normals[ d * 2 ] = glm::normalize( normalMatrix * axis );
+		normals[ d * 2 + 1 ] = -normals[ d * 2 ];
+	}
+
+	std::vector< VoxelMesh > chunkMeshes( totalChunks );
+
+	#pragma omp parallel
+	{
+		ChunkOccupancy chunk;
+		std::vector< unsigned char > mask;
+
+		#pragma omp for schedule(dynamic)
+		for ( int c = 0; c < totalChunks; c++ )
+		{
+			glm::ivec3 chunkIndex( c % numChunks.x, ( c / numChunks.x ) % numChunks.y, c / ( numChunks.x * numChunks.y ) );
+			glm::ivec3 origin = chunkIndex * chunkSize;
+			glm::ivec3 size = glm::min( glm::ivec3( chunkSize ), gridSize - origin );
+
+			if ( readChunk( voxelGrid, origin, size, chunk ) == 0 )
+			{
+				continue;
+			}
+			meshChunk( chunk, origin, size, voxelToWorld, normals, flipWinding, mask, chunkMeshes[c] );
+		}
+	}
+
+	mesh.append( chunkMeshes );
+
+	return mesh.getNumQuads();
+}
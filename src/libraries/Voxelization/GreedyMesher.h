@@ -0,0 +1,86 @@
+#ifndef GREEDYMESHER_H
+#define GREEDYMESHER_H
+
+#include <Voxelization/BitVoxelGrid.h>
+
+#include <string>
+
+class Model;
+
+namespace Grid
+{
+	/**
+	 * triangle mesh of the boundary faces of a voxel grid in world coordinates
+	 * every quad consists of 6 indices, its 4 vertices are either its own ( flat faces ) or shared with neighbouring quads ( smooth surfaces )
+	 */
+	class VoxelMesh
+	{
+	protected:
+		std::vector< glm::vec3 > m_positions;
+		std::vector< glm::vec3 > m_normals;
+		std::vector< unsigned int > m_indices;
+	public:
+		VoxelMesh();
+		virtual ~VoxelMesh();
+
+		void clear();
+
+		int getNumVertices() const;
+		int getNumIndices() const;
+		int getNumQuads() const;
+
+		/**
+		 * append a quad, corners must be in counter clockwise order seen from the front
+		 */
+		void addQuad( const glm::vec3& p0, const glm::vec3& p1, const glm::vec3& p2, const glm::vec3& p3, const glm::vec3& normal );
+
+		/**
+		 * append a single vertex, i.e. to be shared by several quads
+		 * @return index of the vertex
+		 */
+		unsigned int addVertex( const glm::vec3& position, const glm::vec3& normal );
+
+		/**
+		 * append a quad of existing vertices, corners must be in counter clockwise order seen from the front
+		 */
+		void addQuad( unsigned int i0, unsigned int i1, unsigned int i2, unsigned int i3 );
+
+		/**
+		 * append all quads of several meshes, vertices are copied in parallel to their prefix sum offsets
+		 */
+		void append( const std::vector< VoxelMesh >& meshes );
+
+		/**
+		 * upload the mesh to a new vertex array object
+		 * positions are bound to attribute location 0, normals to attribute location 2
+		 * @return model to be rendered with GL_TRIANGLES, 0 if the mesh is empty
+		 */
+		Model* createModel() const;
+
+		/**
+		 * write the mesh to a wavefront obj file
+		 * @return false if the file could not be opened
+		 */
+		bool writeToObj( std::string path ) const;
+
+		std::vector< glm::vec3 >& getPositions();
+		const std::vector< glm::vec3 >& getPositions() const;
+		std::vector< glm::vec3 >& getNormals();
+		const std::vector< glm::vec3 >& getNormals() const;
+		std::vector< unsigned int >& getIndices();
+		const std::vector< unsigned int >& getIndices() const;
+	};
+
+	/**
+	 * extract the boundary faces of all occupied voxels and merge coplanar faces into maximal rectangles
+	 * the grid is split into chunks of chunkSize^3 voxels which are meshed in parallel, faces are not merged across chunk borders
+	 * voxels outside of the grid count as empty
+	 * @param voxelGrid to be meshed
+	 * @param mesh will be overwritten with the merged quads, in world coordinates of the grid
+	 * @param chunkSize edge length of a chunk in voxels
+	 * @return amount of quads
+	 */
+	int extractGreedyMesh( const BitVoxelGrid& voxelGrid, VoxelMesh& mesh, int chunkSize = 32 );
+}
+
+#endif
@@ -0,0 +1,256 @@
+#include "Morphology.h"
+
+#include <Utility/DebugLog.h>
+
+#include <vector>
+
+using namespace Grid;
+
+/**
+ * shift a column of words towards higher z, shifted in bits are taken from outside, i.e. 0u for empty or ~0u for occupied
+ */
+static inline void shiftColumnUp( const unsigned int* source, unsigned int* target, int numLayers, int shift, unsigned int outside )
+{
+	int wordShift = shift >> 5;
+	int bitShift = shift & 31;
+	for ( int layer = 0; layer < numLayers; layer++ )
+	{
+		int sourceLayer = layer - wordShift;
+		unsigned int word = outside;
+		if ( sourceLayer >= 0 )
+		{
+			word = source[ sourceLayer ] << bitShift;
+			if ( bitShift != 0 )
+			{
+				word |= ( ( sourceLayer - 1 >= 0 ) ? source[ sourceLayer - 1 ] : outside ) >> ( 32 - bitShift );
+			}
+		}
+		target[ layer ] = word;
+	}
+}
+
+/**
+ * shift a column of words towards lower z, shifted in bits are taken from outside, i.e. 0u for empty or ~0u for occupied
+ */
+static inline void shiftColumnDown( const unsigned int* source, unsigned int* target, int numLayers, int shift, unsigned int outside )
+{
+	int wordShift = shift >> 5;
+	int bitShift = shift & 31;
+	for ( int layer = 0; layer < numLayers; layer++ )
+	{
+		int sourceLayer = layer + wordShift;
+		unsigned int word = outside;
+		if ( sourceLayer < numLayers )
+		{
+			word = source[ sourceLayer ] >> bitShift;
+			if ( bitShift != 0 )
+			{
+				word |= ( ( sourceLayer + 1 < numLayers ) ? source[ sourceLayer + 1 ] : outside ) << ( 32 - bitShift );
+			}
+		}
+		target[ layer ] = word;
+	}
+}
+
+/**
+ * dilate or erode all columns along z
+ * a segment of radius a combined with a segment of radius s yields a segment of radius a + s, so radius r takes log2(r) steps
+ */
+static void morphZ( const BitVoxelGrid& grid, std::vector< unsigned int >& words, int radius, bool erode, unsigned int outside )
+{
+	int width = grid.getWidth();
+	int height = grid.getHeight();
+	int numLayers = grid.getNumWordLayers();
+	int layerSize = width * height;
+	unsigned int* data = &words[0];
+
+	#pragma omp parallel
+	{
+		std::vector< unsigned int > column( numLayers );
+		std::vector< unsigned int > up( numLayers );
+		std::vector< unsigned int > down( numLayers );
+
+		#pragma omp for schedule(static)
+		for ( int y = 0; y < height; y++ )
+		{
+			for ( int x = 0; x < width; x++ )
+			{
+				// bits beyond the grid depth are outside of the grid as well
+				for ( int layer = 0; layer < numLayers; layer++ )
+				{
+					column[ layer ] = data[ layer * layerSize + y * width + x ] | ( outside & ~grid.getLayerMask( layer ) );
+				}
+
+				int remaining = radius;
+				for ( int step = 1; remaining > 0; step *= 2 )
+				{
+					int shift = ( step < remaining ) ? step : remaining;
+					shiftColumnUp( &column[0], &up[0], numLayers, shift, outside );
+					shiftColumnDown( &column[0], &down[0], numLayers, shift, outside );
+					for ( int layer = 0; layer < numLayers; layer++ )
+					{
+						column[ layer ] = ( erode ) ? ( column[ layer ] & up[ layer ] & down[ layer ] ) : ( column[ layer ] | up[ layer ] | down[ layer ] );
+					}
+					remaining -= shift;
+				}
+
+				// bits beyond the grid depth stay empty
+				for ( int layer = 0; layer < numLayers; layer++ )
+				{
+					data[ layer * layerSize + y * width + x ] = column[ layer ] & grid.getLayerMask( layer );
+				}
+			}
+		}
+	}
+}
+
+/**
+ * dilate or erode all rows along x ( axis 0 ) or y ( axis 1 ) by combining neighbouring words
+ * neighbours outside of the grid are replaced by outside, i.e. 0u for empty or ~0u for occupied
+ */
+static void morphXY( const BitVoxelGrid& grid, std::vector< unsigned int >& words, int radius, bool erode, int axis, unsigned int outside )
+{
+	int width = grid.getWidth();
+	int height = grid.getHeight();
+	int numRows = grid.getNumWordLayers() * height;
+	int length = ( axis == 0 ) ? width : height;
+	int stride = ( axis == 0 ) ? 1 : width;
+
+	std::vector< unsigned int > scratch( words.size() );
+
+	int remaining = radius;
+	for ( int step = 1; remaining > 0; step *= 2 )
+	{
+		int shift = ( step < remaining ) ? step : remaining;
+		const unsigned int* source = &words[0];
+		unsigned int* target = &scratch[0];
+
+		#pragma omp parallel for schedule(static)
+		for ( int row = 0; row < numRows; row++ )
+		{
+			int y = row % height;
+			const unsigned int* sourceRow = source + row * width;
+			unsigned int* targetRow = target + row * width;
+			for ( int x = 0; x < width; x++ )
+			{
+				int position = ( axis == 0 ) ? x : y;
+				unsigned int lower = ( position - shift >= 0 ) ? sourceRow[ x - shift * stride ] : outside;
+				unsigned int upper = ( position + shift < length ) ? sourceRow[ x + shift * stride ] : outside;
+				targetRow[x] = ( erode ) ? ( sourceRow[x] & lower & upper ) : ( sourceRow[x] | lower | upper );
+			}
+		}
+
+		words.swap( scratch );
+		remaining -= shift;
+	}
+}
+
+/**
+ * apply a structuring element to a set of words laid out like the grid
+ * @param outsideOccupied voxels outside of the grid count as occupied instead of empty
+ */
+static void morph( const BitVoxelGrid& grid, std::vector< unsigned int >& words, int radius, StructuringElement element, bool erode, bool outsideOccupied = false )
+{
+	unsigned int outside = ( outsideOccupied ) ? ~0u : 0u;
+
+	if ( words.empty() || radius <= 0 )
+	{
+		return;
+	}
+
+	if ( element == STRUCTURING_ELEMENT_BOX )
+	{
+		morphXY( grid, words, radius, erode, 0, outside );
+		morphXY( grid, words, radius, erode, 1, outside );
+		morphZ( grid, words, radius, erode, outside );
+		return;
+	}
+
+	// cross : union ( or intersection ) of the three axis aligned radius 1 passes, repeated radius times
+	std::vector< unsigned int > wordsX;
+	std::vector< unsigned int > wordsY;
+	int numWords = (int) words.size();
+	for ( int i = 0; i < radius; i++ )
+	{
+		wordsX = words;
+		wordsY = words;
+		morphXY( grid, wordsX, 1, erode, 0, outside );
+		morphXY( grid, wordsY, 1, erode, 1, outside );
+		morphZ( grid, words, 1, erode, outside );
+
+		#pragma omp parallel for schedule(static)
+		for ( int w = 0; w < numWords; w++ )
+		{
+			words[w] = ( erode ) ? ( words[w] & wordsX[w] & wordsY[w] ) : ( words[w] | wordsX[w] | wordsY[w] );
+		}
+	}
+}
+
+/**
+ * copy the result words into the result grid
+ */
+static void storeResult( const BitVoxelGrid& source, BitVoxelGrid& result, std::vector< unsigned int >& words )
+{
+	if ( result.getWidth() != source.getWidth() || result.getHeight() != source.getHeight() || result.getDepth() != source.getDepth() )
+	{
+		result.resize( source.getWidth(), source.getHeight(), source.getDepth() );
+	}
+	result.setWorldToVoxel( source.getWorldToVoxel() );
+	result.getWords().swap( words );
+}
+
+void Grid::dilate(const BitVoxelGrid& source, BitVoxelGrid& result, int radius, StructuringElement element)
+{
+	if ( radius < 0 )
+	{
+		DEBUGLOG->log("ERROR : MORPHOLOGY : radius must not be negative : ", radius);
+		return;
+	}
+
+	std::vector< unsigned int > words( source.getWords() );
+	morph( source, words, radius, element, false );
+	storeResult( source, result, words );
+}
+
+void Grid::erode(const BitVoxelGrid& source, BitVoxelGrid& result, int radius, StructuringElement element)
+{
+	if ( radius < 0 )
+	{
+		DEBUGLOG->log("ERROR : MORPHOLOGY : radius must not be negative : ", radius);
+		return;
+	}
+
+	std::vector< unsigned int > words( source.getWords() );
+	morph( source, words, radius, element, true );
+	storeResult( source, result, words );
+}
+
+void Grid::open(const BitVoxelGrid& source, BitVoxelGrid& result, int radius, StructuringElement element)
+{
+	if ( radius < 0 )
+	{
+		DEBUGLOG->log("ERROR : MORPHOLOGY : radius must not be negative : ", radius);
+		return;
+	}
+
+	std::vector< unsigned int > words( source.getWords() );
+	morph( source, words, radius, element, true );
+	morph( source, words, radius, element, false );
+	storeResult( source, result, words );
+}
+
+void Grid::close(const BitVoxelGrid& source, BitVoxelGrid& result, int radius, StructuringElement element)
+{
+	if ( radius < 0 )
+	{
+		DEBUGLOG->log("ERROR : MORPHOLOGY : radius must not be negative : ", radius);
+		return;
+	}
+
+	std::vector< unsigned int > words( source.getWords() );
+	morph( source, words, radius, element, false );
+
+	// voxels outside of the grid count as occupied, so the erosion never removes voxels of the source at the grid boundary
+	morph( source, words, radius, element, true, true );
+	storeResult( source, result, words );
+}
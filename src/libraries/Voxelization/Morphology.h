@@ -0,0 +1,46 @@
+#ifndef MORPHOLOGY_H
+#define MORPHOLOGY_H
+
+#include <Voxelization/BitVoxelGrid.h>
+
+namespace Grid
+{
+	/**
+	 * BOX : all voxels within a cube of side length 2 * radius + 1
+	 * CROSS : all voxels within manhattan distance radius, i.e. the 6-neighbourhood for radius 1
+	 */
+	enum StructuringElement { STRUCTURING_ELEMENT_BOX, STRUCTURING_ELEMENT_CROSS };
+
+	/**
+	 * grow the occupied voxels of a grid
+	 * z is handled by shifting column words, x and y by combining neighbouring words, rows of words are processed in parallel
+	 * a box of radius r is applied as three separable passes with log2(r) steps each,
+	 * a cross of radius r as r repeated unions of the three axis aligned radius 1 passes
+	 * @param source grid
+	 * @param result will be resized if necessary and overwritten, may be the source grid
+	 * @param radius of the structuring element in voxels
+	 * @param element shape of the structuring element
+	 */
+	void dilate( const BitVoxelGrid& source, BitVoxelGrid& result, int radius, StructuringElement element = STRUCTURING_ELEMENT_BOX );
+
+	/**
+	 * shrink the occupied voxels of a grid, voxels outside of the grid count as empty
+	 * @see dilate
+	 */
+	void erode( const BitVoxelGrid& source, BitVoxelGrid& result, int radius, StructuringElement element = STRUCTURING_ELEMENT_BOX );
+
+	/**
+	 * erosion followed by dilation, removes structures smaller than the structuring element
+	 * @see dilate
+	 */
+	void open( const BitVoxelGrid& source, BitVoxelGrid& result, int radius, StructuringElement element = STRUCTURING_ELEMENT_BOX );
+
+	/**
+	 * dilation followed by erosion, fills gaps smaller than the structuring element, never removes voxels of the source
+	 * the erosion counts voxels outside of the grid as occupied, so structures touching the grid boundary are kept
+	 * @see dilate
+	 */
+	void close( const BitVoxelGrid& source, BitVoxelGrid& result, int radius, StructuringElement element = STRUCTURING_ELEMENT_BOX );
+}
+
+#endif
@@ -0,0 +1,137 @@
+#include "OccupancyPyramid.h"
+
+#include <Utility/DebugLog.h>
+
+using namespace Grid;
+
+/**
+ * move the even bits of a word into the lower 16 bits
+ */
+static inline unsigned int compactEvenBits( unsigned int word )
+{
+	word &= 0x55555555u;
+	word = ( word | ( word >> 1 ) ) & 0x33333333u;
+	word = ( word | ( word >> 2 ) ) & 0x0F0F0F0Fu;
+	word = ( word | ( word >> 4 ) ) & 0x00FF00FFu;
+	word = ( word | ( word >> 8 ) ) & 0x0000FFFFu;
+	return word;
+}
+
+/**
+ * OR-reduce 2x2x2 voxels of the source grid into one voxel of the target grid
+ */
+static void downsample( const BitVoxelGrid& source, BitVoxelGrid& target )
+{
+	const unsigned int* sourceWords = &source.getWords()[0];
+	unsigned int* targetWords = &target.getWords()[0];
+
+	int sourceWidth = source.getWidth();
+	int sourceHeight = source.getHeight();
+	int sourceLayers = source.getNumWordLayers();
+	int targetWidth = target.getWidth();
+	int targetHeight = target.getHeight();
+	int targetLayers = target.getNumWordLayers();
+
+	#pragma omp parallel for schedule(static)
+	for ( int y = 0; y < targetHeight; y++ )
+	{
+		for ( int layer = 0; layer < targetLayers; layer++ )
+		{
+			for ( int x = 0; x < targetWidth; x++ )
+			{
+				// z voxels 0..31 of this word come from two source word layers
+				unsigned int lower = 0;
+				unsigned int upper = 0;
+				for ( int sy = 2 * y; sy < 2 * y + 2 && sy < sourceHeight; sy++ )
+				{
+					for ( int sx = 2 * x; sx < 2 * x + 2 && sx < sourceWidth; sx++ )
+					{
+						lower |= sourceWords[ source.getWordIndex( sx, sy, 2 * layer ) ];
+						if ( 2 * layer + 1 < sourceLayers )
+						{
+							upper |= sourceWords[ source.getWordIndex( sx, sy, 2 * layer + 1 ) ];
+						}
+					}
+				}
+
+				// OR neighbouring bit pairs, then pack them
+				lower = compactEvenBits( lower | ( lower >> 1 ) );
+				upper = compactEvenBits( upper | ( upper >> 1 ) );
+
+				targetWords[ target.getWordIndex( x, y, layer ) ] = lower | ( upper << 16 );
+			}
+		}
+	}
+}
+
+OccupancyPyramid::OccupancyPyramid(const BitVoxelGrid* voxelGrid)
+{
+	p_voxelGrid = voxelGrid;
+
+	update();
+}
+
+OccupancyPyramid::~OccupancyPyramid()
+{
+}
+
+void OccupancyPyramid::update()
+{
+	if ( !p_voxelGrid || p_voxelGrid->getNumWords() == 0 )
+	{
+		m_levels.clear();
+		return;
+	}
+
+	int width = p_voxelGrid->getWidth();
+	int height = p_voxelGrid->getHeight();
+	int depth = p_voxelGrid->getDepth();
+
+	// count levels until 1x1x1 is reached
+	int numLevels = 0;
+	while ( width > 1 || height > 1 || depth > 1 )
+	{
+		width = ( width + 1 ) / 2;
+		height = ( height + 1 ) / 2;
+		depth = ( depth + 1 ) / 2;
+		numLevels++;
+	}
+
+	m_levels.resize( numLevels );
+
+	const BitVoxelGrid* source = p_voxelGrid;
+	for ( int i = 0; i < numLevels; i++ )
+	{
+		m_levels[i].resize( ( source->getWidth() + 1 ) / 2, ( source->getHeight() + 1 ) / 2, ( source->getDepth() + 1 ) / 2 );
+		downsample( *source, m_levels[i] );
+		source = &m_levels[i];
+	}
+}
+
+void OccupancyPyramid::setVoxelGrid(const BitVoxelGrid* voxelGrid)
+{
+	p_voxelGrid = voxelGrid;
+
+	update();
+}
+
+const BitVoxelGrid* OccupancyPyramid::getVoxelGrid() const {
+	return p_voxelGrid;
+}
+
+int OccupancyPyramid::getNumLevels() const {
+	return ( p_voxelGrid ) ? (int) m_levels.size() + 1 : 0;
+}
+
+const BitVoxelGrid& OccupancyPyramid::getLevel(int level) const
+{
+	if ( level <= 0 || level > (int) m_levels.size() )
+	{
+		if ( level != 0 )
+		{
+			DEBUGLOG->log("ERROR : OCCUPANCY PYRAMID : level out of range : ", level);
+		}
+		return *p_voxelGrid;
+	}
+	return m_levels[ level - 1 ];
+}
@@ -0,0 +1,57 @@
+#ifndef OCCUPANCYPYRAMID_H
+#define OCCUPANCYPYRAMID_H
+
+#include <Voxelization/BitVoxelGrid.h>
+
+#include <vector>
+
+namespace Grid
+{
+	/**
+	 * This class represents an occupancy mip pyramid of a bit voxel grid
+	 * - level 0 is the grid itself
+	 * - a voxel of level k + 1 is occupied if any of the 2x2x2 voxels of level k it covers is occupied
+	 * - the pyramid ends with a level of 1x1x1 voxels
+	 */
+	class OccupancyPyramid
+	{
+	protected:
+		const BitVoxelGrid* p_voxelGrid;			// level 0, not owned
+		std::vector< BitVoxelGrid > m_levels;		// level 1 .. n
+	public:
+		/**
+		 * @param voxelGrid to build the pyramid of, must outlive the pyramid
+		 */
+		OccupancyPyramid( const BitVoxelGrid* voxelGrid = 0 );
+		virtual ~OccupancyPyramid();
+
+		/**
+		 * rebuild all levels, must be called whenever the voxel grid has changed
+		 */
+		void update();
+
+		/**
+		 * set a different voxel grid and rebuild all levels
+		 */
+		void setVoxelGrid( const BitVoxelGrid* voxelGrid );
+		const BitVoxelGrid* getVoxelGrid() const;
+
+		/**
+		 * @return amount of levels, including level 0
+		 */
+		int getNumLevels() const;
+
+		const BitVoxelGrid& getLevel( int level ) const;
+
+		/**
+		 * @return true if voxel (x,y,z) of the given level is occupied, coordinates are relative to that level
+		 */
+		inline bool isOccupied( int level, int x, int y, int z ) const
+		{
+			const BitVoxelGrid& grid = ( level == 0 ) ? *p_voxelGrid : m_levels[ level - 1 ];
+			return ( grid.getWords()[ grid.getWordIndex( x, y, z >> 5 ) ] >> ( z & 31 ) ) & 1u;
+		}
+	};
+}
+
+#endif
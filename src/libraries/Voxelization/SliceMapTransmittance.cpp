@@ -0,0 +1,150 @@
+#include "SliceMapTransmittance.h"
+
+#include <Utility/BitTools.h>
+#include <Utility/DebugLog.h>
+
+#include <cmath>
+
+SliceMap::TransmittanceQuery::TransmittanceQuery(const Grid::BitVoxelGrid* sliceMap, const glm::mat4& lightViewProjection)
+{
+	p_sliceMap = sliceMap;
+	m_lightViewProjection = lightViewProjection;
+}
+
+SliceMap::TransmittanceQuery::~TransmittanceQuery()
+{
+}
+
+int SliceMap::TransmittanceQuery::countOccupiedVoxels(const glm::vec3& worldPosition) const
+{
+	if ( !p_sliceMap || p_sliceMap->getNumWords() == 0 )
+	{
+		DEBUGLOG->log("ERROR : TRANSMITTANCE QUERY : no slice map available");
+		return 0;
+	}
+
+	// project into light space
+	glm::vec4 lightPosition = m_lightViewProjection * glm::vec4( worldPosition, 1.0f );
+	if ( lightPosition.w <= 0.0f )
+	{
+		return 0;
+	}
+	lightPosition /= lightPosition.w;
+
+	// map to 0..1
+	float u = lightPosition.x * 0.5f + 0.5f;
+	float v = lightPosition.y * 0.5f + 0.5f;
+	float depth = glm::clamp( lightPosition.z * 0.5f + 0.5f, 0.0f, 1.0f );
+
+	int x = (int) std::floor( u * p_sliceMap->getWidth() );
+	int y = (int) std::floor( v * p_sliceMap->getHeight() );
+	if ( x < 0 || x >= p_sliceMap->getWidth() || y < 0 || y >= p_sliceMap->getHeight() )
+	{
+		return 0;
+	}
+
+	// slice containing the position
+	int depthBit = glm::clamp( (int) ( depth * p_sliceMap->getDepth() ), 0, p_sliceMap->getDepth() - 1 );
+	int lastLayer = depthBit >> 5;
+
+	const unsigned int* words = &p_sliceMap->getWords()[0];
+
+	// full words in front of the position, then the masked word containing it
+	int occupiedVoxels = 0;
+	for ( int layer = 0; layer < lastLayer; layer++ )
+	{
+		occupiedVoxels += BitTools::popCount( words[ p_sliceMap->getWordIndex( x, y, layer ) ] );
+	}
+	occupiedVoxels += BitTools::popCount( words[ p_sliceMap->getWordIndex( x, y, lastLayer ) ] & BitTools::getRangeMask( 0, ( depthBit & 31 ) + 1 ) );
+
+	return occupiedVoxels;
+}
+
+void SliceMap::TransmittanceQuery::countOccupiedVoxels(const std::vector<glm::vec3>& worldPositions, std::vector<int>& occupiedVoxels) const
+{
+	occupiedVoxels.resize( worldPositions.size() );
+
+	if ( !p_sliceMap || p_sliceMap->getNumWords() == 0 )
+	{
+		DEBUGLOG->log("ERROR : TRANSMITTANCE QUERY : no slice map available");
+		occupiedVoxels.assign( worldPositions.size(), 0 );
+		return;
+	}
+
+	int numPositions = (int) worldPositions.size();
+
+	#pragma omp parallel for schedule(static)
+	for ( int i = 0; i < numPositions; i++ )
+	{
+		occupiedVoxels[i] = countOccupiedVoxels( worldPositions[i] );
+	}
+}
+
+void SliceMap::TransmittanceQuery::computeTransmittance(const std::vector<glm::vec3>& worldPositions, std::vector<float>& transmittance, float sigma) const
+{
+	std::vector< int > occupiedVoxels;
+	countOccupiedVoxels( worldPositions, occupiedVoxels );
+
+	// there are at most depth + 1 different results, so look them up
+	int maxVoxels = ( p_sliceMap ) ? p_sliceMap->getDepth() : 0;
+	std::vector< float > transmittanceLookup( maxVoxels + 1, 1.0f );
+	for ( int i = 1; i <= maxVoxels; i++ )
+	{
+		transmittanceLookup[i] = transmittanceLookup[i - 1] * ( 1.0f - sigma );
+	}
+
+	transmittance.resize( worldPositions.size() );
+	for ( unsigned int i = 0; i < occupiedVoxels.size(); i++ )
+	{
+		transmittance[i] = transmittanceLookup[ occupiedVoxels[i] ];
+	}
+}
+
+const Grid::BitVoxelGrid* SliceMap::TransmittanceQuery::getSliceMap() const {
+	return p_sliceMap;
+}
+
+void SliceMap::TransmittanceQuery::setSliceMap(const Grid::BitVoxelGrid* sliceMap) {
+	p_sliceMap = sliceMap;
+}
+
+const glm::mat4& SliceMap::TransmittanceQuery::getLightViewProjection() const {
+	return m_lightViewProjection;
+}
+
+void SliceMap::TransmittanceQuery::setLightViewProjection(const glm::mat4& lightViewProjection) {
+	m_lightViewProjection = lightViewProjection;
+}
+
+void SliceMap::readSliceMapRGBA8(GLuint textureHandle, Grid::BitVoxelGrid& sliceMap, int layer)
+{
+	GLint width = 0;
+	GLint height = 0;
+
+	glBindTexture( GL_TEXTURE_2D, textureHandle );
+	glGetTexLevelParameteriv( GL_TEXTURE_2D, 0, GL_TEXTURE_WIDTH, &width );
+	glGetTexLevelParameteriv( GL_TEXTURE_2D, 0, GL_TEXTURE_HEIGHT, &height );
+
+	if ( width != sliceMap.getWidth() || height != sliceMap.getHeight() )
+	{
+		DEBUGLOG->log("ERROR : SLICE MAP : texture resolution does not match slice map resolution");
+		glBindTexture( GL_TEXTURE_2D, 0 );
+		return;
+	}
+
+	std::vector< GLubyte > texels( width * height * 4, 0 );
+	glGetTexImage( GL_TEXTURE_2D, 0, GL_RGBA, GL_UNSIGNED_BYTE, &texels[0] );
+	glBindTexture( GL_TEXTURE_2D, 0 );
+
+	// r channel holds slices 0..7, g channel 8..15, b channel 16..23, a channel 24..31
+	std::vector< unsigned int > words( width * height, 0 );
+	for ( int i = 0; i < width * height; i++ )
+	{
+		words[i] = ( (unsigned int) texels[ i * 4 ] )
+				| ( (unsigned int) texels[ i * 4 + 1 ] << 8 )
+				| ( (unsigned int) texels[ i * 4 + 2 ] << 16 )
+				| ( (unsigned int) texels[ i * 4 + 3 ] << 24 );
+	}
+
+	sliceMap.setWordLayer( &words[0], layer );
+}
@@ -0,0 +1,66 @@
+#ifndef SLICEMAPTRANSMITTANCE_H
+#define SLICEMAPTRANSMITTANCE_H
+
+#include <Voxelization/BitVoxelGrid.h>
+
+#include <glm/glm.hpp>
+#include <vector>
+
+namespace SliceMap
+{
+	/**
+	 * This class answers transmittance queries against a slice map rendered from a light source
+	 * For every world position it counts the occupied voxels of the slice map column between the light source and the position,
+	 * by masking the Z-words of the column and counting the set bits
+	 */
+	class TransmittanceQuery
+	{
+	protected:
+		const Grid::BitVoxelGrid* p_sliceMap;	// slice map, bit 0 of word layer 0 is the slice nearest to the light source
+		glm::mat4 m_lightViewProjection;		// world to light clip space
+	public:
+		/**
+		 * @param sliceMap slice map rendered from the light source
+		 * @param lightViewProjection light projection matrix * light view matrix
+		 */
+		TransmittanceQuery( const Grid::BitVoxelGrid* sliceMap, const glm::mat4& lightViewProjection );
+		virtual ~TransmittanceQuery();
+
+		/**
+		 * count occupied voxels between the light source and a world position ( including the slice containing the position )
+		 * @param worldPosition
+		 * @return amount of occupied voxels, 0 if the position is outside of the slice map
+		 */
+		int countOccupiedVoxels( const glm::vec3& worldPosition ) const;
+
+		/**
+		 * count occupied voxels between the light source and every world position of a batch
+		 * @param worldPositions to be queried
+		 * @param occupiedVoxels will be resized and filled with one result per position
+		 */
+		void countOccupiedVoxels( const std::vector< glm::vec3 >& worldPositions, std::vector< int >& occupiedVoxels ) const;
+
+		/**
+		 * compute the light transmittance for every world position of a batch
+		 * @param worldPositions to be queried
+		 * @param transmittance will be resized and filled with ( 1 - sigma ) ^ occupiedVoxels per position
+		 * @param sigma light absorption per voxel
+		 */
+		void computeTransmittance( const std::vector< glm::vec3 >& worldPositions, std::vector< float >& transmittance, float sigma = 0.3f ) const;
+
+		const Grid::BitVoxelGrid* getSliceMap() const;
+		void setSliceMap( const Grid::BitVoxelGrid* sliceMap );
+		const glm::mat4& getLightViewProjection() const;
+		void setLightViewProjection( const glm::mat4& lightViewProjection );
+	};
+
+	/**
+	 * read back a RGBA8 slice map texture ( 8 slices per channel, as written by sliceMap.frag ) into a word layer of a grid
+	 * @param textureHandle of a GL_TEXTURE_2D with RGBA8 format and the same resolution as the grid
+	 * @param sliceMap grid to be written to
+	 * @param layer to be overwritten
+	 */
+	void readSliceMapRGBA8( GLuint textureHandle, Grid::BitVoxelGrid& sliceMap, int layer = 0 );
+}
+
+#endif
@@ -0,0 +1,259 @@
+#include "SummedVolumeTable.h"
+
+#include <Utility/BitTools.h>
+#include <Utility/DebugLog.h>
+
+#include <algorithm>
+#include <cmath>
+
+using namespace Grid;
+
+SummedVolumeTable::SummedVolumeTable()
+{
+	m_width = 0;
+	m_height = 0;
+	m_depth = 0;
+	m_worldToVoxel = glm::mat4( 1.0f );
+}
+
+SummedVolumeTable::~SummedVolumeTable()
+{
+}
+
+void SummedVolumeTable::build(const BitVoxelGrid& voxelGrid)
+{
+	m_width = voxelGrid.getWidth();
+	m_height = voxelGrid.getHeight();
+	m_depth = voxelGrid.getDepth();
+	m_worldToVoxel = voxelGrid.getWorldToVoxel();
+	m_words = voxelGrid.getWords();
+	m_sums.assign( ( m_width + 1 ) * ( m_height + 1 ) * ( m_depth + 1 ), 0 );
+
+	if ( voxelGrid.getNumWords() == 0 )
+	{
+		return;
+	}
+
+	int width = m_width;
+	int height = m_height;
+	int depth = m_depth;
+	const unsigned int* words = &m_words[0];
+	unsigned int* sums = &m_sums[0];
+
+	// entry slice z + 1 holds the 2D table of voxel slice z
+	#pragma omp parallel for schedule(static)
+	for ( int z = 0; z < depth; z++ )
+	{
+		int layer = z >> 5;
+		int bit = z & 31;
+		for ( int y = 0; y < height; y++ )
+		{
+			unsigned int rowSum = 0;
+			for ( int x = 0; x < width; x++ )
+			{
+				rowSum += ( words[ voxelGrid.getWordIndex( x, y, layer ) ] >> bit ) & 1u;
+				sums[ getIndex( x + 1, y + 1, z + 1 ) ] = sums[ getIndex( x + 1, y, z + 1 ) ] + rowSum;
+			}
+		}
+	}
+
+	// sum up the slices
+	#pragma omp parallel for schedule(static)
+	for ( int y = 1; y <= height; y++ )
+	{
+		for ( int z = 1; z <= depth; z++ )
+		{
+			for ( int x = 1; x <= width; x++ )
+			{
+				sums[ getIndex( x, y, z ) ] += sums[ getIndex( x, y, z - 1 ) ];
+			}
+		}
+	}
+}
+
+bool SummedVolumeTable::clampBox(glm::ivec3& min, glm::ivec3& max) const
+{
+	min = glm::max( min, glm::ivec3( 0 ) );
+	max = glm::min( max, glm::ivec3( m_width, m_height, m_depth ) );
+	return min.x < max.x && min.y < max.y && min.z < max.z;
+}
+
+void SummedVolumeTable::update(const BitVoxelGrid& voxelGrid, glm::ivec3 min, glm::ivec3 max)
+{
+	if ( voxelGrid.getWidth() != m_width || voxelGrid.getHeight() != m_height || voxelGrid.getDepth() != m_depth )
+	{
+		DEBUGLOG->log("ERROR : SUMMED VOLUME TABLE : grid resolution differs from the table, rebuild it instead");
+		return;
+	}
+	if ( !clampBox( min, max ) )
+	{
+		return;
+	}
+
+	glm::ivec3 size = max - min;
+	std::vector< int > deltas( size.x * size.y * size.z, 0 );
+	bool changed = false;
+
+	// collect the changes of the region and adopt them into the stored words
+	for ( int y = min.y; y < max.y; y++ )
+	{
+		for ( int x = min.x; x < max.x; x++ )
+		{
+			for ( int layer = min.z >> 5; layer <= ( max.z - 1 ) >> 5; layer++ )
+			{
+				int first = std::max( min.z - layer * 32, 0 );
+				int last = std::min( max.z - layer * 32, 32 );
+				unsigned int mask = BitTools::getRangeMask( first, last - first );
+
+				int wordIndex = voxelGrid.getWordIndex( x, y, layer );
+				unsigned int oldWord = m_words[ wordIndex ];
+				unsigned int newWord = voxelGrid.getWords()[ wordIndex ];
+				unsigned int difference = ( oldWord ^ newWord ) & mask;
+				if ( difference == 0 )
+				{
+					continue;
+				}
+
+				while ( difference )
+				{
+					int bit = BitTools::countTrailingZeros( difference );
+					difference &= difference - 1;
+					int z = layer * 32 + bit;
+					deltas[ ( ( z - min.z ) * size.y + ( y - min.y ) ) * size.x + ( x - min.x ) ] = ( ( newWord >> bit ) & 1u ) ? 1 : -1;
+				}
+				m_words[ wordIndex ] = ( oldWord & ~mask ) | ( newWord & mask );
+				changed = true;
+			}
+		}
+	}
+
+	if ( !changed )
+	{
+		return;
+	}
+
+	// inclusive prefix sums of the changes along x, y and z
+	for ( int z = 0; z < size.z; z++ )
+	{
+		for ( int y = 0; y < size.y; y++ )
+		{
+			int* row = &deltas[ ( z * size.y + y ) * size.x ];
+			for ( int x = 1; x < size.x; x++ )
+			{
+				row[x] += row[ x - 1 ];
+			}
+			if ( y > 0 )
+			{
+				const int* previousRow = row - size.x;
+				for ( int x = 0; x < size.x; x++ )
+				{
+					row[x] += previousRow[x];
+				}
+			}
+		}
+		if ( z > 0 )
+		{
+			int sliceSize = size.x * size.y;
+			for ( int i = 0; i < sliceSize; i++ )
+			{
+				deltas[ z * sliceSize + i ] += deltas[ ( z - 1 ) * sliceSize + i ];
+			}
+		}
+	}
+
+	// entry (x,y,z) changes by the summed changes of the region part inside [0,x) x [0,y) x [0,z)
+	int width = m_width;
+	int height = m_height;
+	int depth = m_depth;
+	unsigned int* sums = &m_sums[0];
+
+	#pragma omp parallel for schedule(static)
+	for ( int z = min.z + 1; z <= depth; z++ )
+	{
+		int localZ = std::min( z, max.z ) - min.z - 1;
+		for ( int y = min.y + 1; y <= height; y++ )
+		{
+			int localY = std::min( y, max.y ) - min.y - 1;
+			const int* row = &deltas[ ( localZ * size.y + localY ) * size.x ];
+			for ( int x = min.x + 1; x <= width; x++ )
+			{
+				int localX = std::min( x, max.x ) - min.x - 1;
+				sums[ getIndex( x, y, z ) ] += (unsigned int) row[ localX ];
+			}
+		}
+	}
+}
+
+unsigned int SummedVolumeTable::countOccupiedVoxels(glm::ivec3 min, glm::ivec3 max) const
+{
+	if ( !clampBox( min, max ) )
+	{
+		return 0;
+	}
+
+	// unsigned wrap around cancels out
+	return m_sums[ getIndex( max.x, max.y, max.z ) ]
+		- m_sums[ getIndex( min.x, max.y, max.z ) ]
+		- m_sums[ getIndex( max.x, min.y, max.z ) ]
+		- m_sums[ getIndex( max.x, max.y, min.z ) ]
+		+ m_sums[ getIndex( min.x, min.y, max.z ) ]
+		+ m_sums[ getIndex( min.x, max.y, min.z ) ]
+		+ m_sums[ getIndex( max.x, min.y, min.z ) ]
+		- m_sums[ getIndex( min.x, min.y, min.z ) ];
+}
+
+unsigned int SummedVolumeTable::countOccupiedVoxels(const glm::vec3& worldMin, const glm::vec3& worldMax) const
+{
+	// bounds of the box corners in grid coordinates
+	glm::vec3 gridMin( 0.0f );
+	glm::vec3 gridMax( 0.0f );
+	for ( int corner = 0; corner < 8; corner++ )
+	{
+		glm::vec3 worldCorner( ( corner & 1 ) ? worldMax.x : worldMin.x, ( corner & 2 ) ? worldMax.y : worldMin.y, ( corner & 4 ) ? worldMax.z : worldMin.z );
+		glm::vec3 gridCorner = glm::vec3( m_worldToVoxel * glm::vec4( worldCorner, 1.0f ) );
+		gridMin = ( corner == 0 ) ? gridCorner : glm::min( gridMin, gridCorner );
+		gridMax = ( corner == 0 ) ? gridCorner : glm::max( gridMax, gridCorner );
+	}
+
+	glm::ivec3 min( (int) std::floor( gridMin.x ), (int) std::floor( gridMin.y ), (int) std::floor( gridMin.z ) );
+	glm::ivec3 max( (int) std::ceil( gridMax.x ), (int) std::ceil( gridMax.y ), (int) std::ceil( gridMax.z ) );
+	return countOccupiedVoxels( min, max );
+}
+
+bool SummedVolumeTable::isEmpty(const glm::ivec3& min, const glm::ivec3& max) const
+{
+	return countOccupiedVoxels( min, max ) == 0;
+}
+
+void SummedVolumeTable::countOccupiedVoxels(const glm::ivec3* mins, const glm::ivec3* maxs, int numBoxes, unsigned int* counts) const
+{
+	#pragma omp parallel for schedule(static)
+	for ( int i = 0; i < numBoxes; i++ )
+	{
+		counts[i] = countOccupiedVoxels( mins[i], maxs[i] );
+	}
+}
+
+int SummedVolumeTable::getWidth() const {
+	return m_width;
+}
+
+int SummedVolumeTable::getHeight() const {
+	return m_height;
+}
+
+int SummedVolumeTable::getDepth() const {
+	return m_depth;
+}
+
+unsigned int SummedVolumeTable::getNumOccupiedVoxels() const {
+	return ( m_sums.empty() ) ? 0 : m_sums.back();
+}
+
+const glm::mat4& SummedVolumeTable::getWorldToVoxel() const {
+	return m_worldToVoxel;
+}
+
+const std::vector<unsigned int>& SummedVolumeTable::getSums() const {
+	return m_sums;
+}
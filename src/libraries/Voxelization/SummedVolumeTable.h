@@ -0,0 +1,89 @@
+#ifndef SUMMEDVOLUMETABLE_H
+#define SUMMEDVOLUMETABLE_H
+
+#include <Voxelization/BitVoxelGrid.h>
+
+#include <glm/glm.hpp>
+#include <vector>
+
+namespace Grid
+{
+	/**
+	 * This class represents a summed volume table of a bit voxel grid, answering box occupancy queries in constant time
+	 * - entry (x,y,z) holds the amount of occupied voxels in [0,x) x [0,y) x [0,z), so a box query takes 8 lookups
+	 * - the table needs 4 bytes per voxel, it keeps a copy of the grid words to compute the changes of incremental updates
+	 */
+	class SummedVolumeTable
+	{
+	protected:
+		int m_width;
+		int m_height;
+		int m_depth;
+		glm::mat4 m_worldToVoxel;
+
+		std::vector< unsigned int > m_sums;		// index : ( z * ( height + 1 ) + y ) * ( width + 1 ) + x
+		std::vector< unsigned int > m_words;	// grid words the table currently represents
+
+		inline int getIndex( int x, int y, int z ) const { return ( z * ( m_height + 1 ) + y ) * ( m_width + 1 ) + x; }
+
+		/**
+		 * clamp a box to the grid
+		 * @return false if the clamped box is empty
+		 */
+		bool clampBox( glm::ivec3& min, glm::ivec3& max ) const;
+	public:
+		SummedVolumeTable();
+		virtual ~SummedVolumeTable();
+
+		/**
+		 * build the table of a grid, adopting its resolution and world mapping
+		 * every z slice is summed up in x and y in parallel, then all columns are summed up in z in parallel
+		 */
+		void build( const BitVoxelGrid& voxelGrid );
+
+		/**
+		 * update the table after voxels of a region of the grid changed, i.e. after bricks were revoxelized
+		 * the change of every voxel in the region is summed up locally and added to all entries beyond the region's lower corner,
+		 * so the cost depends on the region's position instead of the grid size. voxels outside of the region are not considered
+		 * @param voxelGrid with the same resolution the table was built from
+		 * @param min lowest voxel of the changed region
+		 * @param max highest voxel of the changed region, exclusive
+		 */
+		void update( const BitVoxelGrid& voxelGrid, glm::ivec3 min, glm::ivec3 max );
+
+		/**
+		 * @param min lowest voxel of the box
+		 * @param max highest voxel of the box, exclusive, the box is clamped to the grid
+		 * @return amount of occupied voxels in the box
+		 */
+		unsigned int countOccupiedVoxels( glm::ivec3 min, glm::ivec3 max ) const;
+
+		/**
+		 * @return amount of occupied voxels which overlap an axis aligned box in world coordinates
+		 */
+		unsigned int countOccupiedVoxels( const glm::vec3& worldMin, const glm::vec3& worldMax ) const;
+
+		/**
+		 * @return true if no voxel in the box is occupied
+		 */
+		bool isEmpty( const glm::ivec3& min, const glm::ivec3& max ) const;
+
+		/**
+		 * answer a batch of box queries in parallel
+		 * @param mins lowest voxels of the boxes
+		 * @param maxs highest voxels of the boxes, exclusive
+		 * @param numBoxes amount of boxes
+		 * @param counts will be filled with the amount of occupied voxels per box
+		 */
+		void countOccupiedVoxels( const glm::ivec3* mins, const glm::ivec3* maxs, int numBoxes, unsigned int* counts ) const;
+
+		int getWidth() const;
+		int getHeight() const;
+		int getDepth() const;
+		unsigned int getNumOccupiedVoxels() const;
+		const glm::mat4& getWorldToVoxel() const;
+		const std::vector< unsigned int >& getSums() const;
+	};
+}
+
+#endif
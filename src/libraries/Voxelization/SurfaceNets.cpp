@@ -0,0 +1,205 @@
+#include "SurfaceNets.h"
+
+#include <Utility/DebugLog.h>
+
+#include <algorithm>
+
+using namespace Grid;
+
+/**
+ * distance field access shared by all chunks
+ */
+struct SurfaceNetsField
+{
+	const DistanceField* p_distanceField;
+	float m_isoValue;
+	float m_outsideValue;	// value of samples outside of the grid
+	glm::mat4 m_voxelToWorld;
+	glm::mat3 m_normalMatrix;
+	bool m_flipWinding;
+
+	/**
+	 * @return distance relative to the iso value of sample (x,y,z), negative inside
+	 */
+	inline float sample( int x, int y, int z ) const
+	{
+		if ( x < 0 || y < 0 || z < 0 || x >= p_distanceField->getWidth() || y >= p_distanceField->getHeight() || z >= p_distanceField->getDepth() )
+		{
+			return m_outsideValue - m_isoValue;
+		}
+		return p_distanceField->getDistances()[ p_distanceField->getIndex( x, y, z ) ] - m_isoValue;
+	}
+};
+
+/**
+ * place the vertex of a cell at the mean of the surface crossings of its 12 edges
+ * @param cell lowest sample of the cell
+ */
+static unsigned int createCellVertex( const SurfaceNetsField& field, const glm::ivec3& cell, VoxelMesh& mesh )
+{
+	float values[8];
+	for ( int corner = 0; corner < 8; corner++ )
+	{
+		values[ corner ] = field.sample( cell.x + ( corner & 1 ), cell.y + ( ( corner >> 1 ) & 1 ), cell.z + ( corner >> 2 ) );
+	}
+
+	glm::vec3 sum( 0.0f );
+	int numCrossings = 0;
+	for ( int a = 0; a < 8; a++ )
+	{
+		for ( int bit = 1; bit < 8; bit <<= 1 )
+		{
+			if ( a & bit )
+			{
+				continue;
+			}
+			int b = a | bit;
+			if ( ( values[a] < 0.0f ) == ( values[b] < 0.0f ) )
+			{
+				continue;
+			}
+
+			float t = values[a] / ( values[a] - values[b] );
+			glm::vec3 cornerA( (float) ( a & 1 ), (float) ( ( a >> 1 ) & 1 ), (float) ( a >> 2 ) );
+			glm::vec3 cornerB( (float) ( b & 1 ), (float) ( ( b >> 1 ) & 1 ), (float) ( b >> 2 ) );
+			sum += cornerA + t * ( cornerB - cornerA );
+			numCrossings++;
+		}
+	}
+
+	// samples lie at voxel centers
+	glm::vec3 position = glm::vec3( cell ) + glm::vec3( 0.5f ) + sum / (float) std::max( numCrossings, 1 );
+
+	// mean of the forward differences along the four edges of every axis
+	glm::vec3 gradient(
+			( values[1] - values[0] ) + ( values[3] - values[2] ) + ( values[5] - values[4] ) + ( values[7] - values[6] ),
+			( values[2] - values[0] ) + ( values[3] - values[1] ) + ( values[6] - values[4] ) + ( values[7] - values[5] ),
+			( values[4] - values[0] ) + ( values[5] - values[1] ) + ( values[6] - values[2] ) + ( values[7] - values[3] ) );
+	glm::vec3 normal = field.m_normalMatrix * gradient;
+	float length = glm::length( normal );
+	normal = ( length > 0.0f ) ? normal / length : glm::vec3( 0.0f, 0.0f, 1.0f );
+
+	return mesh.addVertex( glm::vec3( field.m_voxelToWorld * glm::vec4( position, 1.0f ) ), normal );
+}
+
+/**
+ * emit the quads of all crossed edges starting at the samples of a chunk
+ * @param origin lowest sample of the chunk
+ * @param size amount of samples of the chunk per axis
+ * @param cellVertices scratch table of vertex indices for the cells origin - 1 .. origin + size - 1
+ */
+static void extractChunk( const SurfaceNetsField& field, const glm::ivec3& origin, const glm::ivec3& size, std::vector< int >& cellVertices, VoxelMesh& mesh )
+{
+	glm::ivec3 tableSize = size + glm::ivec3( 1 );
+	cellVertices.assign( tableSize.x * tableSize.y * tableSize.z, -1 );
+
+	for ( int z = origin.z; z < origin.z + size.z; z++ )
+	{
+		for ( int y = origin.y; y < origin.y + size.y; y++ )
+		{
+			for ( int x = origin.x; x < origin.x + size.x; x++ )
+			{
+				glm::ivec3 p( x, y, z );
+				bool inside = field.sample( x, y, z ) < 0.0f;
+
+				for ( int d = 0; d < 3; d++ )
+				{
+					glm::ivec3 q = p;
+					q[d]++;
+					if ( ( field.sample( q.x, q.y, q.z ) < 0.0f ) == inside )
+					{
+						continue;
+					}
+
+					// the four cells around the edge, counter clockwise seen from +d
+					int u = ( d + 1 ) % 3;
+					int v = ( d + 2 ) % 3;
+					glm::ivec3 cells[4] = { p, p, p, p };
+					cells[0][u]--; cells[0][v]--;
+					cells[1][v]--;
+					cells[3][u]--;
+
+					unsigned int indices[4];
+					for ( int c = 0; c < 4; c++ )
+					{
+						glm::ivec3 local = cells[c] - origin + glm::ivec3( 1 );
+						int& vertex = cellVertices[ ( local.z * tableSize.y + local.y ) * tableSize.x + local.x ];
+						if ( vertex < 0 )
+						{
+							vertex = (int) createCellVertex( field, cells[c], mesh );
+						}
+						indices[c] = (unsigned int) vertex;
+					}
+
+					// the surface faces away from the inside sample
+					if ( inside != field.m_flipWinding )
+					{
+						mesh.addQuad( indices[0], indices[1], indices[2], indices[3] );
+					}
+					else
+					{
+						mesh.addQuad( indices[0], indices[3], indices[2], indices[1] );
+					}
+				}
+			}
+		}
+	}
+}
+
+int Grid::extractSurfaceNets(const DistanceField& distanceField, VoxelMesh& mesh, float isoValue, int chunkSize)
+{
+	mesh.clear();
+
+	if ( chunkSize <= 0 )
+	{
+		DEBUGLOG->log("ERROR : SURFACE NETS : chunk size must be positive : ", chunkSize);
+		return 0;
+	}
+	if ( distanceField.getDistances().empty() )
+	{
+		return 0;
+	}
+
+	SurfaceNetsField field;
+	field.p_distanceField = &distanceField;
+	field.m_isoValue = isoValue;
+	field.m_outsideValue = isoValue + 1.0f;
+	field.m_voxelToWorld = glm::inverse( distanceField.getWorldToVoxel() );
+	field.m_normalMatrix = glm::transpose( glm::mat3( distanceField.getWorldToVoxel() ) );
+	glm::mat3 axes( field.m_voxelToWorld );
+	field.m_flipWinding = glm::dot( glm::cross( axes[0], axes[1] ), axes[2] ) < 0.0f;
+
+	// edges start at samples -1 .. size - 1, so the surface is closed at the grid border
+	glm::ivec3 numSamples( distanceField.getWidth() + 1, distanceField.getHeight() + 1, distanceField.getDepth() + 1 );
+	glm::ivec3 numChunks = ( numSamples + glm::ivec3( chunkSize - 1 ) ) / chunkSize;
+	int totalChunks = numChunks.x * numChunks.y * numChunks.z;
+
+	std::vector< VoxelMesh > chunkMeshes( totalChunks );
+
+	#pragma omp parallel
+	{
+		std::vector< int > cellVertices;
+
+		#pragma omp for schedule(dynamic)
+		for ( int c = 0; c < totalChunks; c++ )
+		{
+			glm::ivec3 chunkIndex( c % numChunks.x, ( c / numChunks.x ) % numChunks.y, c / ( numChunks.x * numChunks.y ) );
+			glm::ivec3 offset = chunkIndex * chunkSize;
+			glm::ivec3 size = glm::min( glm::ivec3( chunkSize ), numSamples - offset );
+
+			extractChunk( field, offset - glm::ivec3( 1 ), size, cellVertices, chunkMeshes[c] );
+		}
+	}
+
+	mesh.append( chunkMeshes );
+
+	return mesh.getNumQuads();
+}
+
+int Grid::extractSurfaceNets(const BitVoxelGrid& voxelGrid, VoxelMesh& mesh, int chunkSize)
+{
+	DistanceField distanceField;
+	distanceField.compute( voxelGrid, true );
+
+	return extractSurfaceNets( distanceField, mesh, 0.0f, chunkSize );
+}
@@ -0,0 +1,32 @@
+#ifndef SURFACENETS_H
+#define SURFACENETS_H
+
+#include <Voxelization/BitVoxelGrid.h>
+#include <Voxelization/DistanceField.h>
+#include <Voxelization/GreedyMesher.h>
+
+namespace Grid
+{
+	/**
+	 * extract a smooth iso surface of a distance field with naive surface nets
+	 * distances are sampled at voxel centers, every cell of 2^3 samples which is crossed by the surface gets one vertex
+	 * at the mean of its edge crossings, and every crossed edge between two samples yields a quad of the four cells around it.
+	 * samples outside of the grid count as outside of the surface, so the surface is closed.
+	 * cells are split into chunks of chunkSize^3 which are extracted in parallel, vertices are welded inside a chunk
+	 * through a table of vertex indices per cell, only vertices of cells on chunk borders are duplicated
+	 * @param distanceField to be meshed, inside is where the distance is below the iso value
+	 * @param mesh will be overwritten with the surface, in world coordinates, normals point along the distance gradient
+	 * @param isoValue distance of the surface in voxel units, i.e. 0 for a signed distance field
+	 * @param chunkSize edge length of a chunk in cells
+	 * @return amount of quads
+	 */
+	int extractSurfaceNets( const DistanceField& distanceField, VoxelMesh& mesh, float isoValue = 0.0f, int chunkSize = 32 );
+
+	/**
+	 * extract a smooth surface of the occupied voxels of a grid with naive surface nets on its signed distance field
+	 * @see extractSurfaceNets
+	 */
+	int extractSurfaceNets( const BitVoxelGrid& voxelGrid, VoxelMesh& mesh, int chunkSize = 32 );
+}
+
+#endif
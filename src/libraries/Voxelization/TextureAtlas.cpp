@@ -1,10 +1,16 @@
 #include <Voxelization/TextureAtlas.h>
 
+#include <Voxelization/TextureAtlasCache.h>
+#include <Voxelization/TextureAtlasRasterizer.h>
+
 #include <Utility/DebugLog.h>
 
 #include <Rendering/RenderState.h>
 
+#include <algorithm>
+
 Shader*	writeWorldPositionTextureAtlasShader = 0;	// globally accessible Shader to be used to write a texture atlas
+ComputeShader* extractValidTexelsComputeShader = 0;	// globally accessible Shader to be used to extract the valid texels of a texture atlas
 
 Shader* TexAtlas::getWriteWorldPositionTextureAtlasShader() {
 	if (!writeWorldPositionTextureAtlasShader)
@@ -16,6 +22,15 @@ Shader* TexAtlas::getWriteWorldPositionTextureAtlasShader() {
 	return writeWorldPositionTextureAtlasShader;
 }
 
+ComputeShader* TexAtlas::getExtractValidTexelsComputeShader() {
+	if (!extractValidTexelsComputeShader)
+	{
+		extractValidTexelsComputeShader = new ComputeShader(
+				SHADERS_PATH "/textureAtlas/extractValidTexels.comp");
+	}
+	return extractValidTexelsComputeShader;
+}
+
 void TexAtlas::TextureAtlasRenderPass::configureRenderPass() {
 	// make sure renderpass uses the provided Camera
 	// make sure renderpass clears with alpha 0.0
@@ -110,9 +125,64 @@ Object* TexAtlas::TextureAtlas::getObject() {
 	return p_object;
 }
 
+/**
+ * valid texels of a read back RGBA8 image
+ */
+struct ReadbackTexels
+{
+	const GLubyte* p_pixels;
+	int m_width;
+
+	inline bool isValid( int x, int y ) const { return p_pixels[ ( y * m_width + x ) * 4 + 3 ] != 0; }
+};
+
+/**
+ * write the texel coordinates of all valid texels, row by row
+ * every row is counted in parallel, an exclusive prefix sum over the row counts yields the write offset of every row
+ */
+template < class ValidTexels >
+static void compactValidTexels( const ValidTexels& validTexels, int width, int height, std::vector< glm::vec3 >& vertexPositions )
+{
+	std::vector< int > rowOffsets( height + 1, 0 );
+
+	#pragma omp parallel for schedule(static)
+	for ( int y = 0; y < height; y++ )
+	{
+		int numValid = 0;
+		for ( int x = 0; x < width; x++ )
+		{
+			numValid += validTexels.isValid( x, y ) ? 1 : 0;
+		}
+		rowOffsets[ y + 1 ] = numValid;
+	}
+
+	for ( int y = 0; y < height; y++ )
+	{
+		rowOffsets[ y + 1 ] += rowOffsets[ y ];
+	}
+
+	vertexPositions.resize( rowOffsets[ height ] );
+
+	#pragma omp parallel for schedule(static)
+	for ( int y = 0; y < height; y++ )
+	{
+		int index = rowOffsets[ y ];
+		for ( int x = 0; x < width; x++ )
+		{
+			if ( validTexels.isValid( x, y ) )
+			{
+				vertexPositions[ index++ ] = glm::vec3( ( (float) x + 0.25f ) / ( (float) width ), ( (float) y + 0.25f ) / ( (float) height ), 0.0f );	// corresponding pixel coordinates
+			}
+		}
+	}
+}
+
 TexAtlas::TextureAtlasVertexGenerator::TextureAtlasVertexGenerator(
 		TextureAtlas* textureAtlas) {
 	p_textureAtlas = textureAtlas;
+	p_worldPositionAtlas = 0;
+	m_extractionMode = EXTRACT_READBACK;
+	m_numVertices = 0;
 	m_pixelsObject = 0;
 }
 
@@ -136,112 +206,216 @@ void TexAtlas::TextureAtlasVertexGenerator::generateVertexPositions() {
 	glGetTexLevelParameteriv(GL_TEXTURE_2D, 0,GL_TEXTURE_HEIGHT, &height);
 
 	// retrieve the image and save as an array
-	GLubyte* pixels = new GLubyte[ width * height * 4];
-	glGetTexImage(GL_TEXTURE_2D, 0, GL_RGBA, GL_UNSIGNED_BYTE, pixels);
+	std::vector< GLubyte > pixels( width * height * 4 );
+	if ( !pixels.empty() )
+	{
+		glGetTexImage(GL_TEXTURE_2D, 0, GL_RGBA, GL_UNSIGNED_BYTE, &pixels[0]);
+	}
 
 	DEBUGLOG->log("TEXTURE ATLAS VERTEX GENERATOR : retrieved width : ", width );
 	DEBUGLOG->log("TEXTURE ATLAS VERTEX GENERATOR : retrieved height: ", height );
 
-	// iterate over texture
-	for ( int y = 0; y < height; y++ )
-	{
-		for( int x = 0; x < width; x++)
-		{
-			// valid texture atlas pixel : alpha is != 0.0f
-			int pixelIndex = ( ( (y *  width) * 4 ) + (x * 4) );
-			if ( pixels[ pixelIndex + 3 ] != 0.0f )
-			{
-				m_vertexPositions.push_back( glm::vec3( ( (float) x + 0.25f ) / ( (float) width ), ( (float) y + 0.25f ) / ( (float) height ), 0.0f) );	// push back corresponding pixel coordinates
-			}
-		}
-	}
+	// valid texture atlas pixel : alpha is != 0
+	ReadbackTexels validTexels;
+	validTexels.p_pixels = pixels.empty() ? 0 : &pixels[0];
+	validTexels.m_width = width;
+	compactValidTexels( validTexels, width, height, m_vertexPositions );
+	m_numVertices = (int) m_vertexPositions.size();
 }
 
-void TexAtlas::TextureAtlasVertexGenerator::generateVertexArrayObject()
+void TexAtlas::TextureAtlasVertexGenerator::generateVertexPositions(const WorldPositionAtlas& worldPositionAtlas)
+{
+	compactValidTexels( worldPositionAtlas, worldPositionAtlas.getWidth(), worldPositionAtlas.getHeight(), m_vertexPositions );
+	m_numVertices = (int) m_vertexPositions.size();
+}
+
+void TexAtlas::TextureAtlasVertexGenerator::generateVertexPositions(const AtlasVertexCache& vertexCache)
+{
+	m_vertexPositions.assign( vertexCache.getTexelCoordinates(), vertexCache.getTexelCoordinates() + vertexCache.getNumVertices() );
+	m_numVertices = (int) m_vertexPositions.size();
+}
+
+void TexAtlas::TextureAtlasVertexGenerator::createPixelsObject(GLuint vertexArrayHandle, GLuint vertexBufferHandle, GLuint indexBufferHandle, int numVertices)
 {
 	Model *pixels = new Model;
 	Material *mat = new Material();
 
 	mat->setTexture("uniformTexture", p_textureAtlas);
 
-	GLuint vertexArrayHandle;
-
-	glGenVertexArrays(1, &vertexArrayHandle);
-//	glBindVertexArray(vertexArrayHandle);
 	if ( !RenderState::getInstance()->bindVertexArrayObjectIfDifferent( vertexArrayHandle ) )
 	{
 		DEBUGLOG->log("ERROR : TEXTURE ATLAS VERTEX GENERATOR : failed to bind VAO");
 	}
 
-	std::vector <GLint> indices;
-	std::vector <GLfloat> vertices;
-	std::vector <GLfloat> uvCoords;
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexBufferHandle);
+	glBindBuffer(GL_ARRAY_BUFFER, vertexBufferHandle);
+
+	// x y z as vertex position
+	glEnableVertexAttribArray(0);
+	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 0, 0);
+
+	// x y as UV coordinates
+	glEnableVertexAttribArray(1);
+	glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(GLfloat) * 3, 0);
+
+	pixels->setVAOHandle(vertexArrayHandle);
+	pixels->setVertexBufferHandle( vertexBufferHandle );
+	pixels->setIndexBufferHandle( indexBufferHandle );
+	pixels->setUvBufferHandle( vertexBufferHandle );
+	pixels->setNumIndices( numVertices );
+	pixels->setNumVertices( numVertices );
+	pixels->setNumFaces(0);
+
+	m_pixelsObject = new Object(pixels,mat);
+	m_pixelsObject->setRenderMode( GL_POINTS );
 
-	 // buffer vertices
-	for( unsigned int i = 0; i < m_vertexPositions.size(); i++)
+	RenderState::getInstance()->bindVertexArrayObjectIfDifferent( 0 );
+}
+
+void TexAtlas::TextureAtlasVertexGenerator::generateVertexArrayObject()
+{
+	GLuint vertexArrayHandle;
+	glGenVertexArrays(1, &vertexArrayHandle);
+	RenderState::getInstance()->bindVertexArrayObjectIfDifferent( vertexArrayHandle );
+
+	int numVertices = (int) m_vertexPositions.size();
+	std::vector <GLint> indices( numVertices );
+
+	// buffer current index
+	#pragma omp parallel for schedule(static)
+	for( int i = 0; i < numVertices; i++)
 	{
-		for (unsigned int c = 0; c < 3; c++)
-		{
-			// buffer x y z as vertex position
-			vertices.push_back( m_vertexPositions[i][c] );
-			if ( c < 2 )
-			{
-				// buffer x y as UV coordinates
-				uvCoords.push_back( m_vertexPositions[i][c] );
-			}
-		}
-		// buffer current index
-		indices.push_back(i);
+		indices[i] = i;
 	}
 
 	GLuint indexBufferHandle;
 	glGenBuffers(1, &indexBufferHandle);
 	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexBufferHandle);
 
-	glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(GLint) * indices.size(), &indices[0], GL_STATIC_DRAW);
+	glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(GLint) * indices.size(), indices.empty() ? 0 : &indices[0], GL_STATIC_DRAW);
 
 	// buffer vertices
 	GLuint vertexBufferHandle;
 	glGenBuffers(1, &vertexBufferHandle);
 	glBindBuffer(GL_ARRAY_BUFFER, vertexBufferHandle);
 
-	glBufferData(GL_ARRAY_BUFFER, sizeof(GLfloat) * vertices.size(), &vertices[0], GL_STATIC_DRAW);
+	glBufferData(GL_ARRAY_BUFFER, sizeof(glm::vec3) * m_vertexPositions.size(), m_vertexPositions.empty() ? 0 : &m_vertexPositions[0], GL_STATIC_DRAW);
 
-	glEnableVertexAttribArray(0);
-	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 0, 0);
+	createPixelsObject( vertexArrayHandle, vertexBufferHandle, indexBufferHandle, numVertices );
+}
 
-	// buffer uv coords
-	GLuint uvBufferHandle;
-	glGenBuffers(1, &uvBufferHandle);
-	glBindBuffer(GL_ARRAY_BUFFER, uvBufferHandle);
+void TexAtlas::TextureAtlasVertexGenerator::generateVertexArrayObjectWithComputeShader()
+{
+	// retrieve width and height
+	GLint width = 0;
+	GLint height = 0;
 
-	glBufferData(GL_ARRAY_BUFFER, sizeof(GLfloat) * uvCoords.size(), &uvCoords[0], GL_STATIC_DRAW);
+	p_textureAtlas->bindToTextureUnit( 0 );
+	glActiveTexture( p_textureAtlas->getActiveUnit() );
 
-	glEnableVertexAttribArray(1);
-	glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 0, 0);
+	glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_WIDTH, &width);
+	glGetTexLevelParameteriv(GL_TEXTURE_2D, 0,GL_TEXTURE_HEIGHT, &height);
 
-	pixels->setVAOHandle(vertexArrayHandle);
-	pixels->setVertexBufferHandle( vertexBufferHandle );
-	pixels->setIndexBufferHandle( indexBufferHandle );
-	pixels->setUvBufferHandle( uvBufferHandle );
-	pixels->setNumIndices( indices.size() );
-	pixels->setNumVertices( vertices.size() / 3 );
-	pixels->setNumFaces(0);
+	DEBUGLOG->log("TEXTURE ATLAS VERTEX GENERATOR : retrieved width : ", width );
+	DEBUGLOG->log("TEXTURE ATLAS VERTEX GENERATOR : retrieved height: ", height );
 
-	m_pixelsObject = new Object(pixels,mat);
-	m_pixelsObject->setRenderMode( GL_POINTS );
+	// preallocate buffers large enough for every texel
+	GLsizeiptr maxNumVertices = std::max( (GLsizeiptr) width * height, (GLsizeiptr) 1 );
+
+	GLuint scratchBufferHandles[2];
+	glGenBuffers(2, scratchBufferHandles);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, scratchBufferHandles[0]);
+	glBufferData(GL_SHADER_STORAGE_BUFFER, sizeof(GLfloat) * 3 * maxNumVertices, 0, GL_DYNAMIC_COPY);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, scratchBufferHandles[1]);
+	glBufferData(GL_SHADER_STORAGE_BUFFER, sizeof(GLint) * maxNumVertices, 0, GL_DYNAMIC_COPY);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+	GLuint zero = 0;
+	GLuint atomicCounterHandle;
+	glGenBuffers(1, &atomicCounterHandle);
+	glBindBuffer(GL_ATOMIC_COUNTER_BUFFER, atomicCounterHandle);
+	glBufferData(GL_ATOMIC_COUNTER_BUFFER, sizeof(GLuint), &zero, GL_DYNAMIC_READ);
+
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, scratchBufferHandles[0]);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, scratchBufferHandles[1]);
+	glBindBufferBase(GL_ATOMIC_COUNTER_BUFFER, 0, atomicCounterHandle);
+
+	// append valid texels
+	ComputeShader* extractShader = getExtractValidTexelsComputeShader();
+	extractShader->useProgram();
+	extractShader->uploadUniform( 0, "uniformTextureAtlas" );
+	extractShader->dispatch( ( width + extractShader->getLocalGroupSizeX() - 1 ) / extractShader->getLocalGroupSizeX(), ( height + extractShader->getLocalGroupSizeY() - 1 ) / extractShader->getLocalGroupSizeY(), 1 );
+
+	glMemoryBarrier( GL_ATOMIC_COUNTER_BARRIER_BIT | GL_BUFFER_UPDATE_BARRIER_BIT );
+
+	// only the amount of vertices is read back
+	GLuint numVertices = 0;
+	glGetBufferSubData(GL_ATOMIC_COUNTER_BUFFER, 0, sizeof(GLuint), &numVertices);
+
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, 0);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, 0);
+	glBindBufferBase(GL_ATOMIC_COUNTER_BUFFER, 0, 0);
+	glDeleteBuffers(1, &atomicCounterHandle);
+
+	// shrink the buffers to the amount of vertices
+	GLuint bufferHandles[2];
+	GLsizeiptr bufferSizes[2] = { (GLsizeiptr) sizeof(GLfloat) * 3 * numVertices, (GLsizeiptr) sizeof(GLint) * numVertices };
+	glGenBuffers(2, bufferHandles);
+	for ( int i = 0; i < 2; i++ )
+	{
+		glBindBuffer(GL_COPY_READ_BUFFER, scratchBufferHandles[i]);
+		glBindBuffer(GL_COPY_WRITE_BUFFER, bufferHandles[i]);
+		glBufferData(GL_COPY_WRITE_BUFFER, bufferSizes[i], 0, GL_STATIC_DRAW);
+		if ( numVertices > 0 )
+		{
+			glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, bufferSizes[i]);
+		}
+	}
+	glBindBuffer(GL_COPY_READ_BUFFER, 0);
+	glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+	glDeleteBuffers(2, scratchBufferHandles);
 
-	RenderState::getInstance()->bindVertexArrayObjectIfDifferent( 0 );
+	m_vertexPositions.clear();
+	m_numVertices = (int) numVertices;
+
+	GLuint vertexArrayHandle;
+	glGenVertexArrays(1, &vertexArrayHandle);
+
+	createPixelsObject( vertexArrayHandle, bufferHandles[0], bufferHandles[1], m_numVertices );
 }
 
 void TexAtlas::TextureAtlasVertexGenerator::call()
 {
-	if ( m_vertexPositions.empty() )
+	if ( !m_pixelsObject )
 	{
+		if ( m_extractionMode == EXTRACT_COMPUTE_SHADER )
+		{
+			DEBUGLOG->log("TEXTURE ATLAS VERTEX GENERATOR : generating Vertex Array Object from Texture Atlas with compute shader");
+			DEBUGLOG->indent();
+				generateVertexArrayObjectWithComputeShader();
+				DEBUGLOG->log("TEXTURE ATLAS VERTEX GENERATOR : generated Vertices :", m_numVertices );
+			DEBUGLOG->outdent();
+
+			detach();
+			return;
+		}
+
+		if ( m_extractionMode == EXTRACT_CPU_ATLAS && !p_worldPositionAtlas )
+		{
+			DEBUGLOG->log("ERROR : TEXTURE ATLAS VERTEX GENERATOR : no world position atlas set, reading back texture atlas instead");
+		}
+
 		DEBUGLOG->log("TEXTURE ATLAS VERTEX GENERATOR : generating Vertex Positions from Texture Atlas");
 		DEBUGLOG->indent();
-			generateVertexPositions();
-			DEBUGLOG->log("TEXTURE ATLAS VERTEX GENERATOR : generated Vertices :", m_vertexPositions.size( ) );
+			if ( m_extractionMode == EXTRACT_CPU_ATLAS && p_worldPositionAtlas )
+			{
+				generateVertexPositions( *p_worldPositionAtlas );
+			}
+			else
+			{
+				generateVertexPositions();
+			}
+			DEBUGLOG->log("TEXTURE ATLAS VERTEX GENERATOR : generated Vertices :", m_numVertices );
 		DEBUGLOG->outdent();
 
 		DEBUGLOG->log("TEXTURE ATLAS VERTEX GENERATOR : generating Vertex Array Object");
@@ -266,6 +440,26 @@ void TexAtlas::TextureAtlasVertexGenerator::setPixelsObject(Object* pixelsObject
 TexAtlas::TextureAtlas* TexAtlas::TextureAtlasVertexGenerator::getTextureAtlas() {
 	return p_textureAtlas;
 }
+
+void TexAtlas::TextureAtlasVertexGenerator::setWorldPositionAtlas(const WorldPositionAtlas* worldPositionAtlas) {
+	p_worldPositionAtlas = worldPositionAtlas;
+}
+
+const TexAtlas::WorldPositionAtlas* TexAtlas::TextureAtlasVertexGenerator::getWorldPositionAtlas() {
+	return p_worldPositionAtlas;
+}
+
+void TexAtlas::TextureAtlasVertexGenerator::setExtractionMode(VertexExtractionMode extractionMode) {
+	m_extractionMode = extractionMode;
+}
+
+TexAtlas::VertexExtractionMode TexAtlas::TextureAtlasVertexGenerator::getExtractionMode() {
+	return m_extractionMode;
+}
+
+int TexAtlas::TextureAtlasVertexGenerator::getNumVertices() {
+	return m_numVertices;
+}
 //TexAtlas::TextureAtlasVerticesObject::TextureAtlasVerticesObject( TextureAtlas* textureAtlasPtr )
 //{
 //	p_textureAtlas = textureAtlasPtr;
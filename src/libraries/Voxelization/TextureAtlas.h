@@ -9,7 +9,19 @@
 
 namespace TexAtlas
 {
+	class WorldPositionAtlas;
+	class AtlasVertexCache;
+
 	Shader* getWriteWorldPositionTextureAtlasShader();
+	ComputeShader* getExtractValidTexelsComputeShader();
+
+	/**
+	 * way of finding the valid texels of a texture atlas
+	 * - EXTRACT_READBACK : read back the texture atlas and compact it on the CPU
+	 * - EXTRACT_COMPUTE_SHADER : append every valid texel to the vertex buffer on the GPU, only the amount of vertices is read back
+	 * - EXTRACT_CPU_ATLAS : compact a CPU rasterized WorldPositionAtlas, no GL texture is read
+	 */
+	enum VertexExtractionMode { EXTRACT_READBACK, EXTRACT_COMPUTE_SHADER, EXTRACT_CPU_ATLAS };
 
 	/**
 	 * This class represents a Texture Atlas, which is a special type of texture referencing an object
@@ -84,30 +96,68 @@ namespace TexAtlas
 	/**
 	 * This class represents a Generator of Vertices for a Texture Atlas
 	 * It will produce a set of vertices from the provided Texture Atlas, one vertex per valid Atlas texel
+	 * valid texels are compacted with a parallel prefix sum over rows on the CPU or with an atomic counter on the GPU, see VertexExtractionMode
 	 */
 	class TextureAtlasVertexGenerator : public Listener
 	{
 	protected:
-		std::vector< glm::vec3 > m_vertexPositions;
+		std::vector< glm::vec3 > m_vertexPositions;	// empty if the vertices were generated on the GPU
 		TextureAtlas* p_textureAtlas;
+		const WorldPositionAtlas* p_worldPositionAtlas;
+
+		VertexExtractionMode m_extractionMode;
+		int m_numVertices;
 
 		Object* m_pixelsObject;
+
+		/**
+		 * create the pixels object from buffers holding one vec3 per vertex, the uv coordinates are read from the same buffer
+		 */
+		void createPixelsObject( GLuint vertexArrayHandle, GLuint vertexBufferHandle, GLuint indexBufferHandle, int numVertices );
 	public:
 		TextureAtlasVertexGenerator( TextureAtlas* textureAtlas );
 		virtual ~TextureAtlasVertexGenerator();
 
 		std::vector< glm::vec3 >& getVertexPositions();
 
+		/**
+		 * read back the texture atlas and compact its valid texels
+		 */
 		void generateVertexPositions();
 
+		/**
+		 * compact the valid texels of a CPU rasterized atlas
+		 */
+		void generateVertexPositions( const WorldPositionAtlas& worldPositionAtlas );
+
+		/**
+		 * adopt the texel coordinates of a loaded cache, the texture atlas is not read at all
+		 */
+		void generateVertexPositions( const AtlasVertexCache& vertexCache );
+
 		void generateVertexArrayObject();
 
-		void call();			// generate Vertex Positions if empty
+		/**
+		 * generate the vertex array object directly from the texture atlas with a compute shader,
+		 * the order of the vertices is arbitrary
+		 */
+		void generateVertexArrayObjectWithComputeShader();
+
+		void call();			// generate Vertex Array Object if there is none
 
 		void setPixelsObject(Object* pixelsObject);
 		Object* getPixelsObject();
 		TextureAtlas* getTextureAtlas();
 
+		/**
+		 * @param worldPositionAtlas to be used by EXTRACT_CPU_ATLAS, must match the texture atlas
+		 */
+		void setWorldPositionAtlas( const WorldPositionAtlas* worldPositionAtlas );
+		const WorldPositionAtlas* getWorldPositionAtlas();
+		void setExtractionMode( VertexExtractionMode extractionMode );
+		VertexExtractionMode getExtractionMode();
+		int getNumVertices();
+
 	};
 
 // TODO
@@ -0,0 +1,236 @@
+#include "TextureAtlasCache.h"
+
+#include <Utility/DebugLog.h>
+
+#include <cstdio>
+#include <cstring>
+
+using namespace TexAtlas;
+
+static const unsigned long long FNV_PRIME = 1099511628211ULL;
+static const unsigned int CACHE_VERSION = 1;
+
+/**
+ * layout of the file header, followed by numVertices texel coordinates and numVertices world positions
+ */
+struct AtlasCacheHeader
+{
+	char m_magic[4];	// "TAVC"
+	unsigned int m_version;
+	unsigned long long m_key;
+	int m_width;
+	int m_height;
+	int m_numVertices;
+	int m_reserved;
+};
+
+unsigned long long TexAtlas::hashBytes(const void* data, size_t numBytes, unsigned long long hash)
+{
+	const unsigned char* bytes = (const unsigned char*) data;
+	for ( size_t i = 0; i < numBytes; i++ )
+	{
+		hash ^= bytes[i];
+		hash *= FNV_PRIME;
+	}
+	return hash;
+}
+
+/**
+ * continue a hash with the contents of an array
+ */
+template< class T >
+static unsigned long long hashArray( const std::vector< T >& array, unsigned long long hash )
+{
+	unsigned int size = (unsigned int) array.size();
+	hash = hashBytes( &size, sizeof( size ), hash );
+	return ( array.empty() ) ? hash : hashBytes( &array[0], sizeof( T ) * array.size(), hash );
+}
+
+unsigned long long TexAtlas::hashMesh(const MeshRecord& mesh)
+{
+	unsigned long long hash = hashArray( mesh.m_x, 14695981039346656037ULL );
+	hash = hashArray( mesh.m_y, hash );
+	hash = hashArray( mesh.m_z, hash );
+	hash = hashArray( mesh.m_uvs, hash );
+	hash = hashArray( mesh.m_indices, hash );
+	hash = hashArray( mesh.m_faceOffsets, hash );
+	return hash;
+}
+
+unsigned long long TexAtlas::computeAtlasCacheKey(const MeshRecord& mesh, const glm::mat4& modelMatrix, int width, int height)
+{
+	unsigned long long hash = hashMesh( mesh );
+
+	int resolution[2] = { width, height };
+	hash = hashBytes( &modelMatrix[0][0], sizeof( float ) * 16, hash );
+	hash = hashBytes( resolution, sizeof( resolution ), hash );
+	hash = hashBytes( &CACHE_VERSION, sizeof( CACHE_VERSION ), hash );
+	return hash;
+}
+
+std::string TexAtlas::getAtlasCacheFileName(unsigned long long key)
+{
+	char fileName[64];
+	sprintf( fileName, "textureAtlas_%08x%08x.tac", (unsigned int) ( key >> 32 ), (unsigned int) ( key & 0xFFFFFFFFu ) );
+	return std::string( CACHE_PATH ) + "/" + fileName;
+}
+
+AtlasVertexCache::AtlasVertexCache()
+{
+	m_key = 0;
+	m_width = 0;
+	m_height = 0;
+	m_numVertices = 0;
+	p_texelCoordinates = 0;
+	p_worldPositions = 0;
+}
+
+AtlasVertexCache::~AtlasVertexCache()
+{
+	close();
+}
+
+bool AtlasVertexCache::load(const std::string& path, unsigned long long expectedKey)
+{
+	close();
+
+	// no file yet, i.e. the atlas was never cooked
+	if ( !m_file.open( path ) )
+	{
+		return false;
+	}
+	const char* data = m_file.getData();
+	size_t size = m_file.getSize();
+
+	AtlasCacheHeader header;
+	if ( size < sizeof( header ) )
+	{
+		DEBUGLOG->log("ERROR : TEXTURE ATLAS CACHE : could not read " + path);
+		close();
+		return false;
+	}
+	memcpy( &header, data, sizeof( header ) );
+
+	if ( memcmp( header.m_magic, "TAVC", 4 ) != 0 || header.m_version != CACHE_VERSION || header.m_key != expectedKey || header.m_numVertices < 0
+		|| size != sizeof( header ) + sizeof( glm::vec3 ) * 2 * (size_t) header.m_numVertices )
+	{
+		DEBUGLOG->log("TEXTURE ATLAS CACHE : rejected outdated or foreign file " + path);
+		close();
+		return false;
+	}
+
+	m_key = header.m_key;
+	m_width = header.m_width;
+	m_height = header.m_height;
+	m_numVertices = header.m_numVertices;
+	p_texelCoordinates = (const glm::vec3*) ( data + sizeof( header ) );
+	p_worldPositions = p_texelCoordinates + m_numVertices;
+
+	return true;
+}
+
+void AtlasVertexCache::close()
+{
+	m_file.close();
+
+	m_key = 0;
+	m_width = 0;
+	m_height = 0;
+	m_numVertices = 0;
+	p_texelCoordinates = 0;
+	p_worldPositions = 0;
+}
+
+bool AtlasVertexCache::isLoaded() const
+{
+	return p_texelCoordinates != 0;
+}
+
+bool AtlasVertexCache::write(const std::string& path, unsigned long long key, const WorldPositionAtlas& atlas)
+{
+	int width = atlas.getWidth();
+	int height = atlas.getHeight();
+
+	// valid texels in row order, the way a TextureAtlasVertexGenerator compacts them
+	std::vector< glm::vec3 > texelCoordinates;
+	std::vector< glm::vec3 > worldPositions;
+	for ( int y = 0; y < height; y++ )
+	{
+		for ( int x = 0; x < width; x++ )
+		{
+			if ( atlas.isValid( x, y ) )
+			{
+				texelCoordinates.push_back( glm::vec3( ( (float) x + 0.25f ) / ( (float) width ), ( (float) y + 0.25f ) / ( (float) height ), 0.0f ) );
+				worldPositions.push_back( glm::vec3( atlas.getTexel( x, y ) ) );
+			}
+		}
+	}
+
+	AtlasCacheHeader header;
+	memcpy( header.m_magic, "TAVC", 4 );
+	header.m_version = CACHE_VERSION;
+	header.m_key = key;
+	header.m_width = width;
+	header.m_height = height;
+	header.m_numVertices = (int) texelCoordinates.size();
+	header.m_reserved = 0;
+
+	FILE* file = fopen( path.c_str(), "wb" );
+	if ( !file )
+	{
+		DEBUGLOG->log("ERROR : TEXTURE ATLAS CACHE : could not open " + path);
+		return false;
+	}
+
+	bool success = fwrite( &header, sizeof( header ), 1, file ) == 1;
+	if ( success && !texelCoordinates.empty() )
+	{
+		success = fwrite( &texelCoordinates[0], sizeof( glm::vec3 ), texelCoordinates.size(), file ) == texelCoordinates.size()
+			&& fwrite( &worldPositions[0], sizeof( glm::vec3 ), worldPositions.size(), file ) == worldPositions.size();
+	}
+	fclose( file );
+
+	if ( !success )
+	{
+		DEBUGLOG->log("ERROR : TEXTURE ATLAS CACHE : could not write " + path);
+		remove( path.c_str() );
+	}
+	return success;
+}
+
+void AtlasVertexCache::fillAtlas(WorldPositionAtlas& atlas) const
+{
+	atlas.resize( m_width, m_height );
+
+	#pragma omp parallel for schedule(static)
+	for ( int i = 0; i < m_numVertices; i++ )
+	{
+		int x = (int) ( p_texelCoordinates[i].x * m_width );
+		int y = (int) ( p_texelCoordinates[i].y * m_height );
+		atlas.setTexel( x, y, glm::vec4( p_worldPositions[i], 1.0f ) );
+	}
+}
+
+unsigned long long AtlasVertexCache::getKey() const {
+	return m_key;
+}
+
+int AtlasVertexCache::getWidth() const {
+	return m_width;
+}
+
+int AtlasVertexCache::getHeight() const {
+	return m_height;
+}
+
+int AtlasVertexCache::getNumVertices() const {
+	return m_numVertices;
+}
+
+const glm::vec3* AtlasVertexCache::getTexelCoordinates() const {
+	return p_texelCoordinates;
+}
+
+const glm::vec3* AtlasVertexCache::getWorldPositions() const {
+	return p_worldPositions;
+}
@@ -0,0 +1,91 @@
+#ifndef TEXTUREATLASCACHE_H
+#define TEXTUREATLASCACHE_H
+
+#include <Voxelization/TextureAtlasRasterizer.h>
+#include <Utility/MappedFile.h>
+
+#include <glm/glm.hpp>
+#include <string>
+#include <vector>
+
+namespace TexAtlas
+{
+	/**
+	 * FNV-1a hash of a block of memory
+	 * @param hash to be continued, i.e. the result of a previous call
+	 */
+	unsigned long long hashBytes( const void* data, size_t numBytes, unsigned long long hash = 14695981039346656037ULL );
+
+	/**
+	 * @return FNV-1a hash of the mesh buffers
+	 */
+	unsigned long long hashMesh( const MeshRecord& mesh );
+
+	/**
+	 * @return key of the atlas of a mesh, i.e. the mesh hash continued with the model matrix and the atlas resolution
+	 */
+	unsigned long long computeAtlasCacheKey( const MeshRecord& mesh, const glm::mat4& modelMatrix, int width, int height );
+
+	/**
+	 * @return file name of a cache entry in the cache directory, i.e. CACHE_PATH "/textureAtlas_<key in hex>.tac"
+	 */
+	std::string getAtlasCacheFileName( unsigned long long key );
+
+	/**
+	 * This class represents a cached set of atlas vertices in a binary file
+	 * - the file holds a header, the texel coordinates of all valid texels in row order and their world positions
+	 * - a loaded file is memory mapped, on Windows it is read into memory instead
+	 * - texel coordinates are stored the way a TextureAtlasVertexGenerator creates them, so they can be buffered directly
+	 */
+	class AtlasVertexCache
+	{
+	protected:
+		unsigned long long m_key;
+		int m_width;
+		int m_height;
+		int m_numVertices;
+
+		const glm::vec3* p_texelCoordinates;
+		const glm::vec3* p_worldPositions;
+
+		MappedFile m_file;
+	public:
+		AtlasVertexCache();
+		virtual ~AtlasVertexCache();
+
+		/**
+		 * load a cache file
+		 * @param path of the file
+		 * @param expectedKey the file has to match, files of other meshes or versions are rejected
+		 * @return true if the file exists and matches the key
+		 */
+		bool load( const std::string& path, unsigned long long expectedKey );
+
+		/**
+		 * release the loaded file
+		 */
+		void close();
+
+		bool isLoaded() const;
+
+		/**
+		 * write the valid texels of an atlas into a cache file
+		 * @return true on success
+		 */
+		static bool write( const std::string& path, unsigned long long key, const WorldPositionAtlas& atlas );
+
+		/**
+		 * restore the valid texels into an atlas, which is resized to the cached resolution
+		 */
+		void fillAtlas( WorldPositionAtlas& atlas ) const;
+
+		unsigned long long getKey() const;
+		int getWidth() const;
+		int getHeight() const;
+		int getNumVertices() const;
+		const glm::vec3* getTexelCoordinates() const;
+		const glm::vec3* getWorldPositions() const;
+	};
+}
+
+#endif
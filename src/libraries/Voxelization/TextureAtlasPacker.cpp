@@ -0,0 +1,348 @@
+#include "TextureAtlasPacker.h"
+
+#include <Utility/DebugLog.h>
+
+#include <algorithm>
+#include <cmath>
+
+using namespace TexAtlas;
+
+/**
+ * orders object indices by descending chart resolution
+ */
+struct LargerChart
+{
+	const std::vector< int >* p_resolutions;
+
+	bool operator()( int a, int b ) const { return (*p_resolutions)[a] > (*p_resolutions)[b]; }
+};
+
+PackedTextureAtlas::PackedTextureAtlas()
+{
+	m_textureHandle = 0;
+	m_texelBufferHandle = 0;
+	m_modelMatrixBufferHandle = 0;
+}
+
+PackedTextureAtlas::~PackedTextureAtlas()
+{
+	deleteGLResources();
+}
+
+int PackedTextureAtlas::addObject(const MeshRecord& mesh, const glm::mat4& modelMatrix, int resolution)
+{
+	if ( (int) mesh.m_uvs.size() != mesh.getNumVertices() )
+	{
+		DEBUGLOG->log("ERROR : PACKED TEXTURE ATLAS : amount of uv coordinates differs from amount of positions");
+		return -1;
+	}
+
+	Entry entry;
+	entry.p_mesh = &mesh;
+	entry.p_renderableNode = 0;
+	entry.m_resolution = std::max( resolution, 1 );
+
+	m_entries.push_back( entry );
+	m_charts.push_back( glm::ivec4( 0 ) );
+	m_modelMatrices.push_back( modelMatrix );
+
+	return (int) m_entries.size() - 1;
+}
+
+int PackedTextureAtlas::addObject(ResourceManager& resourceManager, RenderableNode* renderableNode, int resolution)
+{
+	if ( !renderableNode || !renderableNode->getObject() || !renderableNode->getObject()->getModel() )
+	{
+		DEBUGLOG->log("ERROR : PACKED TEXTURE ATLAS : renderable node has no model");
+		return -1;
+	}
+
+	Model* model = renderableNode->getObject()->getModel();
+	int object = addObject(
+			resourceManager.getMeshRecord( model ),
+			renderableNode->getAccumulatedModelMatrix(),
+			resolution );
+	if ( object >= 0 )
+	{
+		m_entries[ object ].p_renderableNode = renderableNode;
+	}
+	return object;
+}
+
+bool PackedTextureAtlas::placeCharts(int maxResolution, glm::ivec2& size)
+{
+	int numObjects = (int) m_entries.size();
+	std::vector< int > resolutions( numObjects );
+	std::vector< int > order( numObjects );
+	double totalArea = 0.0;
+	int largestResolution = 1;
+	for ( int i = 0; i < numObjects; i++ )
+	{
+		resolutions[i] = m_entries[i].m_resolution;
+		order[i] = i;
+		totalArea += (double) resolutions[i] * resolutions[i];
+		largestResolution = std::max( largestResolution, resolutions[i] );
+	}
+
+	if ( largestResolution > maxResolution )
+	{
+		DEBUGLOG->log("ERROR : PACKED TEXTURE ATLAS : chart exceeds the maximum resolution : ", largestResolution);
+		return false;
+	}
+
+	LargerChart largerChart;
+	largerChart.p_resolutions = &resolutions;
+	std::stable_sort( order.begin(), order.end(), largerChart );
+
+	// widen the atlas until the shelves fit
+	for ( int width = std::max( largestResolution, (int) std::ceil( std::sqrt( totalArea ) ) ); ; width = std::min( width * 2, maxResolution ) )
+	{
+		width = std::min( width, maxResolution );
+
+		int x = 0;
+		int shelfY = 0;
+		int shelfHeight = 0;
+		for ( int i = 0; i < numObjects; i++ )
+		{
+			int resolution = resolutions[ order[i] ];
+			if ( x + resolution > width )
+			{
+				shelfY += shelfHeight;
+				x = 0;
+				shelfHeight = 0;
+			}
+			m_charts[ order[i] ] = glm::ivec4( x, shelfY, resolution, resolution );
+			x += resolution;
+			shelfHeight = std::max( shelfHeight, resolution );
+		}
+
+		int height = shelfY + shelfHeight;
+		if ( height <= maxResolution )
+		{
+			size = glm::ivec2( width, std::max( height, 1 ) );
+			return true;
+		}
+		if ( width == maxResolution )
+		{
+			DEBUGLOG->log("ERROR : PACKED TEXTURE ATLAS : charts do not fit into the maximum resolution, required height : ", height);
+			return false;
+		}
+	}
+}
+
+bool PackedTextureAtlas::pack(int maxResolution)
+{
+	m_texelCoordinates.clear();
+	m_texelPositions.clear();
+
+	glm::ivec2 size( 0 );
+	if ( m_entries.empty() || !placeCharts( maxResolution, size ) )
+	{
+		m_atlas.resize( 0, 0 );
+		return false;
+	}
+
+	// charts are disjoint, so every chart is rasterized by a single thread
+	m_atlas.resize( size.x, size.y );
+	int numObjects = (int) m_entries.size();
+	int numInvalid = 0;
+
+	#pragma omp parallel for schedule(dynamic) reduction(+:numInvalid)
+	for ( int i = 0; i < numObjects; i++ )
+	{
+		bool invalidIndices = false;
+		rasterizeChart( *m_entries[i].p_mesh, glm::mat4( 1.0f ), m_atlas, m_charts[i], (float) ( i + 1 ), invalidIndices );
+		numInvalid += ( invalidIndices ) ? 1 : 0;
+	}
+
+	if ( numInvalid > 0 )
+	{
+		DEBUGLOG->log("ERROR : PACKED TEXTURE ATLAS : faces reference vertices out of range, skipped them, affected objects : ", numInvalid);
+	}
+
+	// compact the valid texels row by row with a prefix sum over the row counts
+	int width = size.x;
+	int height = size.y;
+	std::vector< int > rowOffsets( height + 1, 0 );
+
+	#pragma omp parallel for schedule(static)
+	for ( int y = 0; y < height; y++ )
+	{
+		int numValid = 0;
+		for ( int x = 0; x < width; x++ )
+		{
+			numValid += m_atlas.isValid( x, y ) ? 1 : 0;
+		}
+		rowOffsets[ y + 1 ] = numValid;
+	}
+
+	for ( int y = 0; y < height; y++ )
+	{
+		rowOffsets[ y + 1 ] += rowOffsets[ y ];
+	}
+
+	m_texelCoordinates.resize( rowOffsets[ height ] );
+	m_texelPositions.resize( rowOffsets[ height ] );
+
+	#pragma omp parallel for schedule(static)
+	for ( int y = 0; y < height; y++ )
+	{
+		int index = rowOffsets[ y ];
+		for ( int x = 0; x < width; x++ )
+		{
+			if ( m_atlas.isValid( x, y ) )
+			{
+				m_texelCoordinates[ index ] = glm::vec3( ( (float) x + 0.25f ) / ( (float) width ), ( (float) y + 0.25f ) / ( (float) height ), 0.0f );
+				m_texelPositions[ index ] = m_atlas.getTexel( x, y );
+				index++;
+			}
+		}
+	}
+
+	return true;
+}
+
+void PackedTextureAtlas::updateModelMatrices()
+{
+	for ( unsigned int i = 0; i < m_entries.size(); i++ )
+	{
+		if ( m_entries[i].p_renderableNode )
+		{
+			m_modelMatrices[i] = m_entries[i].p_renderableNode->getAccumulatedModelMatrix();
+		}
+	}
+}
+
+void PackedTextureAtlas::setModelMatrix(int object, const glm::mat4& modelMatrix) {
+	m_modelMatrices[ object ] = modelMatrix;
+}
+
+void PackedTextureAtlas::voxelize(Grid::BitVoxelGrid& voxelGrid) const
+{
+	if ( voxelGrid.getNumWords() == 0 || m_texelPositions.empty() )
+	{
+		return;
+	}
+
+	// model to grid matrix per object
+	std::vector< glm::mat4 > modelToVoxel( m_modelMatrices.size() );
+	for ( unsigned int i = 0; i < m_modelMatrices.size(); i++ )
+	{
+		modelToVoxel[i] = voxelGrid.getWorldToVoxel() * m_modelMatrices[i];
+	}
+
+	unsigned int* words = &voxelGrid.getWords()[0];
+	int numTexels = (int) m_texelPositions.size();
+	int width = voxelGrid.getWidth();
+	int height = voxelGrid.getHeight();
+	int depth = voxelGrid.getDepth();
+
+	#pragma omp parallel for schedule(static)
+	for ( int i = 0; i < numTexels; i++ )
+	{
+		const glm::vec4& texel = m_texelPositions[i];
+		glm::vec3 gridPosition = glm::vec3( modelToVoxel[ (int) texel.w - 1 ] * glm::vec4( glm::vec3( texel ), 1.0f ) );
+
+		int x = (int) std::floor( gridPosition.x );
+		int y = (int) std::floor( gridPosition.y );
+		int z = (int) std::floor( gridPosition.z );
+		if ( x < 0 || y < 0 || z < 0 || x >= width || y >= height || z >= depth )
+		{
+			continue;
+		}
+
+		unsigned int& word = words[ voxelGrid.getWordIndex( x, y, z >> 5 ) ];
+
+		#pragma omp atomic
+		word |= 1u << ( z & 31 );
+	}
+}
+
+void PackedTextureAtlas::uploadAtlas()
+{
+	if ( m_textureHandle )
+	{
+		glDeleteTextures( 1, &m_textureHandle );
+	}
+	m_textureHandle = m_atlas.createTexture();
+
+	if ( !m_texelBufferHandle )
+	{
+		glGenBuffers( 1, &m_texelBufferHandle );
+	}
+	glBindBuffer( GL_SHADER_STORAGE_BUFFER, m_texelBufferHandle );
+	glBufferData( GL_SHADER_STORAGE_BUFFER, sizeof( glm::vec3 ) * m_texelCoordinates.size(), m_texelCoordinates.empty() ? 0 : &m_texelCoordinates[0], GL_STATIC_DRAW );
+	glBindBuffer( GL_SHADER_STORAGE_BUFFER, 0 );
+
+	uploadModelMatrices();
+}
+
+void PackedTextureAtlas::uploadModelMatrices()
+{
+	if ( !m_modelMatrixBufferHandle )
+	{
+		glGenBuffers( 1, &m_modelMatrixBufferHandle );
+	}
+	glBindBuffer( GL_SHADER_STORAGE_BUFFER, m_modelMatrixBufferHandle );
+	glBufferData( GL_SHADER_STORAGE_BUFFER, sizeof( glm::mat4 ) * m_modelMatrices.size(), m_modelMatrices.empty() ? 0 : &m_modelMatrices[0], GL_DYNAMIC_DRAW );
+	glBindBuffer( GL_SHADER_STORAGE_BUFFER, 0 );
+}
+
+void PackedTextureAtlas::deleteGLResources()
+{
+	if ( m_textureHandle )
+	{
+		glDeleteTextures( 1, &m_textureHandle );
+	}
+	if ( m_texelBufferHandle )
+	{
+		glDeleteBuffers( 1, &m_texelBufferHandle );
+	}
+	if ( m_modelMatrixBufferHandle )
+	{
+		glDeleteBuffers( 1, &m_modelMatrixBufferHandle );
+	}
+	m_textureHandle = 0;
+	m_texelBufferHandle = 0;
+	m_modelMatrixBufferHandle = 0;
+}
+
+int PackedTextureAtlas::getNumObjects() const {
+	return (int) m_entries.size();
+}
+
+int PackedTextureAtlas::getNumTexels() const {
+	return (int) m_texelCoordinates.size();
+}
+
+const glm::ivec4& PackedTextureAtlas::getChart(int object) const {
+	return m_charts[ object ];
+}
+
+const glm::mat4& PackedTextureAtlas::getModelMatrix(int object) const {
+	return m_modelMatrices[ object ];
+}
+
+const WorldPositionAtlas& PackedTextureAtlas::getAtlas() const {
+	return m_atlas;
+}
+
+const std::vector<glm::vec3>& PackedTextureAtlas::getTexelCoordinates() const {
+	return m_texelCoordinates;
+}
+
+const std::vector<glm::vec4>& PackedTextureAtlas::getTexelPositions() const {
+	return m_texelPositions;
+}
+
+GLuint PackedTextureAtlas::getTextureHandle() const {
+	return m_textureHandle;
+}
+
+GLuint PackedTextureAtlas::getTexelBufferHandle() const {
+	return m_texelBufferHandle;
+}
+
+GLuint PackedTextureAtlas::getModelMatrixBufferHandle() const {
+	return m_modelMatrixBufferHandle;
+}
@@ -0,0 +1,117 @@
+#ifndef TEXTUREATLASPACKER_H
+#define TEXTUREATLASPACKER_H
+
+#include <Voxelization/BitVoxelGrid.h>
+#include <Voxelization/TextureAtlasRasterizer.h>
+
+#include <glm/glm.hpp>
+#include <vector>
+
+namespace TexAtlas
+{
+	/**
+	 * This class represents a texture atlas shared by many objects, so a whole scene is voxelized with a single dispatch
+	 * - every object gets a square chart of the atlas, charts are placed on shelves sorted by size
+	 * - texels hold positions in model space, their w component is the object index + 1, 0 marks invalid texels
+	 * - a table of model matrices maps every object into world space, so moving objects only update the table
+	 * - meshes are referenced, not copied, until the atlas is packed
+	 */
+	class PackedTextureAtlas
+	{
+	protected:
+		/**
+		 * an object waiting to be packed
+		 */
+		struct Entry
+		{
+			const MeshRecord* p_mesh;
+			RenderableNode* p_renderableNode;	// model matrix source, may be 0
+			int m_resolution;
+		};
+
+		std::vector< Entry > m_entries;
+		std::vector< glm::ivec4 > m_charts;			// x, y, width, height per object
+		std::vector< glm::mat4 > m_modelMatrices;	// per object
+
+		WorldPositionAtlas m_atlas;
+		std::vector< glm::vec3 > m_texelCoordinates;	// valid texels in row order, like a TextureAtlasVertexGenerator creates them
+		std::vector< glm::vec4 > m_texelPositions;		// model space position and object index + 1 per valid texel
+
+		GLuint m_textureHandle;
+		GLuint m_texelBufferHandle;
+		GLuint m_modelMatrixBufferHandle;
+
+		/**
+		 * place all charts on shelves
+		 * @return false if they do not fit
+		 */
+		bool placeCharts( int maxResolution, glm::ivec2& size );
+	public:
+		PackedTextureAtlas();
+		virtual ~PackedTextureAtlas();
+
+		/**
+		 * add an object to be packed
+		 * @param mesh vertex positions in model space, uv coordinates and faces
+		 * @param modelMatrix initial model matrix
+		 * @param resolution side length of the chart, i.e. computed by computeAtlasSizing
+		 * @return object index
+		 */
+		int addObject( const MeshRecord& mesh, const glm::mat4& modelMatrix, int resolution );
+
+		/**
+		 * add the model of a renderable node, its accumulated model matrix is read by updateModelMatrices
+		 * @return object index, -1 if the node has no model
+		 */
+		int addObject( ResourceManager& resourceManager, RenderableNode* renderableNode, int resolution );
+
+		/**
+		 * place the charts of all objects, rasterize them and compact the valid texels
+		 * @param maxResolution maximum side length of the atlas
+		 * @return false if the charts do not fit
+		 */
+		bool pack( int maxResolution = 8192 );
+
+		/**
+		 * read the accumulated model matrices of all objects added with a renderable node
+		 */
+		void updateModelMatrices();
+
+		void setModelMatrix( int object, const glm::mat4& modelMatrix );
+
+		/**
+		 * mark the voxels of all valid texels of all objects in a parallel loop over the texels
+		 * @param voxelGrid to be written to, its contents are kept
+		 */
+		void voxelize( Grid::BitVoxelGrid& voxelGrid ) const;
+
+		/**
+		 * create or update the GL resources used by voxelizeWithPackedTexAtlasCompute.comp :
+		 * the atlas texture, a shader storage buffer with the texel coordinates and one with the model matrices
+		 */
+		void uploadAtlas();
+
+		/**
+		 * upload the model matrix table only, i.e. after objects moved
+		 */
+		void uploadModelMatrices();
+
+		/**
+		 * release the GL resources
+		 */
+		void deleteGLResources();
+
+		int getNumObjects() const;
+		int getNumTexels() const;
+		const glm::ivec4& getChart( int object ) const;
+		const glm::mat4& getModelMatrix( int object ) const;
+		const WorldPositionAtlas& getAtlas() const;
+		const std::vector< glm::vec3 >& getTexelCoordinates() const;
+		const std::vector< glm::vec4 >& getTexelPositions() const;
+		GLuint getTextureHandle() const;
+		GLuint getTexelBufferHandle() const;
+		GLuint getModelMatrixBufferHandle() const;
+	};
+}
+
+#endif
@@ -0,0 +1,392 @@
+#include "TextureAtlasRasterizer.h"
+
+#include <Utility/DebugLog.h>
+
+#include <algorithm>
+#include <cmath>
+
+using namespace TexAtlas;
+
+static const int SUBTEXEL_BITS = 8;				// fixed point precision of snapped vertex coordinates
+static const long long SUBTEXEL_ONE = 1LL << SUBTEXEL_BITS;
+static const int BIN_SIZE = 64;					// texels per bin side, multiple of the tile size
+
+/**
+ * triangle in fixed point texel coordinates, counter clockwise
+ */
+struct AtlasTriangle
+{
+	long long m_x[3];
+	long long m_y[3];
+	long long m_area;			// twice the signed area, positive
+	unsigned int m_indices[3];	// vertex indices in the order of m_x, m_y
+	glm::ivec2 m_min;			// covered texel bounds, inclusive
+	glm::ivec2 m_max;
+};
+
+/**
+ * @return edge function of edge a -> b at point p, positive on the left side
+ */
+static inline long long edgeFunction( long long ax, long long ay, long long bx, long long by, long long px, long long py )
+{
+	return ( bx - ax ) * ( py - ay ) - ( by - ay ) * ( px - ax );
+}
+
+/**
+ * top left rule for counter clockwise triangles with y pointing up: left edges go down, top edges go left
+ */
+static inline bool isTopLeft( long long ax, long long ay, long long bx, long long by )
+{
+	return ( by < ay ) || ( by == ay && bx < ax );
+}
+
+/**
+ * snap a triangle to fixed point texel coordinates
+ * @param region x, y, width, height of the texels the uv range 0..1 is mapped to
+ * @param clampMin lowest texel to be covered
+ * @param clampMax highest texel to be covered, exclusive
+ * @return false if the triangle is degenerate or covers no texel center
+ */
+static bool setupTriangle( const std::vector< glm::vec2 >& uvs, unsigned int i0, unsigned int i1, unsigned int i2, const glm::ivec4& region, const glm::ivec2& clampMin, const glm::ivec2& clampMax, AtlasTriangle& triangle )
+{
+	unsigned int indices[3] = { i0, i1, i2 };
+	for ( int v = 0; v < 3; v++ )
+	{
+		triangle.m_x[v] = (long long) std::floor( ( (double) uvs[ indices[v] ].x * region.z + region.x ) * SUBTEXEL_ONE + 0.5 );
+		triangle.m_y[v] = (long long) std::floor( ( (double) uvs[ indices[v] ].y * region.w + region.y ) * SUBTEXEL_ONE + 0.5 );
+		triangle.m_indices[v] = indices[v];
+	}
+
+	triangle.m_area = edgeFunction( triangle.m_x[0], triangle.m_y[0], triangle.m_x[1], triangle.m_y[1], triangle.m_x[2], triangle.m_y[2] );
+	if ( triangle.m_area == 0 )
+	{
+		return false;
+	}
+	if ( triangle.m_area < 0 )
+	{
+		std::swap( triangle.m_x[1], triangle.m_x[2] );
+		std::swap( triangle.m_y[1], triangle.m_y[2] );
+		std::swap( triangle.m_indices[1], triangle.m_indices[2] );
+		triangle.m_area = -triangle.m_area;
+	}
+
+	// texel x has its center at ( x + 0.5 ) * SUBTEXEL_ONE
+	long long minX = std::min( triangle.m_x[0], std::min( triangle.m_x[1], triangle.m_x[2] ) );
+	long long maxX = std::max( triangle.m_x[0], std::max( triangle.m_x[1], triangle.m_x[2] ) );
+	long long minY = std::min( triangle.m_y[0], std::min( triangle.m_y[1], triangle.m_y[2] ) );
+	long long maxY = std::max( triangle.m_y[0], std::max( triangle.m_y[1], triangle.m_y[2] ) );
+	long long half = SUBTEXEL_ONE / 2;
+
+	triangle.m_min.x = (int) std::max( ( minX - half + SUBTEXEL_ONE - 1 ) >> SUBTEXEL_BITS, (long long) clampMin.x );
+	triangle.m_min.y = (int) std::max( ( minY - half + SUBTEXEL_ONE - 1 ) >> SUBTEXEL_BITS, (long long) clampMin.y );
+	triangle.m_max.x = (int) std::min( ( maxX - half ) >> SUBTEXEL_BITS, (long long) clampMax.x - 1 );
+	triangle.m_max.y = (int) std::min( ( maxY - half ) >> SUBTEXEL_BITS, (long long) clampMax.y - 1 );
+
+	return triangle.m_min.x <= triangle.m_max.x && triangle.m_min.y <= triangle.m_max.y;
+}
+
+/**
+ * rasterize the part of a triangle inside a bin
+ */
+static void rasterizeTriangle( const AtlasTriangle& triangle, const std::vector< glm::vec3 >& worldPositions, const glm::ivec2& binMin, const glm::ivec2& binMax, float validValue, WorldPositionAtlas& atlas )
+{
+	int minX = std::max( triangle.m_min.x, binMin.x );
+	int minY = std::max( triangle.m_min.y, binMin.y );
+	int maxX = std::min( triangle.m_max.x, binMax.x );
+	int maxY = std::min( triangle.m_max.y, binMax.y );
+	if ( minX > maxX || minY > maxY )
+	{
+		return;
+	}
+
+	const long long* tx = triangle.m_x;
+	const long long* ty = triangle.m_y;
+
+	// edge k lies opposite of vertex k
+	long long stepX[3], stepY[3], rowStart[3], bias[3];
+	long long px = ( (long long) minX << SUBTEXEL_BITS ) + SUBTEXEL_ONE / 2;
+	long long py = ( (long long) minY << SUBTEXEL_BITS ) + SUBTEXEL_ONE / 2;
+	for ( int k = 0; k < 3; k++ )
+	{
+		int a = ( k + 1 ) % 3;
+		int b = ( k + 2 ) % 3;
+		stepX[k] = -( ty[b] - ty[a] ) * SUBTEXEL_ONE;
+		stepY[k] = ( tx[b] - tx[a] ) * SUBTEXEL_ONE;
+		rowStart[k] = edgeFunction( tx[a], ty[a], tx[b], ty[b], px, py );
+		bias[k] = isTopLeft( tx[a], ty[a], tx[b], ty[b] ) ? 0 : -1;	// covered if edge function + bias >= 0
+	}
+
+	const glm::vec3& p0 = worldPositions[ triangle.m_indices[0] ];
+	const glm::vec3& p1 = worldPositions[ triangle.m_indices[1] ];
+	const glm::vec3& p2 = worldPositions[ triangle.m_indices[2] ];
+	double inverseArea = 1.0 / (double) triangle.m_area;
+
+	for ( int y = minY; y <= maxY; y++ )
+	{
+		long long e0 = rowStart[0];
+		long long e1 = rowStart[1];
+		long long e2 = rowStart[2];
+		for ( int x = minX; x <= maxX; x++ )
+		{
+			if ( ( e0 + bias[0] ) >= 0 && ( e1 + bias[1] ) >= 0 && ( e2 + bias[2] ) >= 0 )
+			{
+				float l0 = (float) ( e0 * inverseArea );
+				float l1 = (float) ( e1 * inverseArea );
+				float l2 = 1.0f - l0 - l1;
+				atlas.setTexel( x, y, glm::vec4( l0 * p0 + l1 * p1 + l2 * p2, validValue ) );
+			}
+			e0 += stepX[0];
+			e1 += stepX[1];
+			e2 += stepX[2];
+		}
+		rowStart[0] += stepY[0];
+		rowStart[1] += stepY[1];
+		rowStart[2] += stepY[2];
+	}
+}
+
+WorldPositionAtlas::WorldPositionAtlas(int width, int height)
+{
+	m_width = 0;
+	m_height = 0;
+	m_numTilesX = 0;
+	m_numTilesY = 0;
+	resize( width, height );
+}
+
+WorldPositionAtlas::~WorldPositionAtlas()
+{
+}
+
+void WorldPositionAtlas::resize(int width, int height)
+{
+	m_width = std::max( width, 0 );
+	m_height = std::max( height, 0 );
+	m_numTilesX = ( m_width + TILE_SIZE - 1 ) / TILE_SIZE;
+	m_numTilesY = ( m_height + TILE_SIZE - 1 ) / TILE_SIZE;
+	m_texels.assign( m_numTilesX * m_numTilesY * TILE_SIZE * TILE_SIZE, glm::vec4( 0.0f ) );
+}
+
+void WorldPositionAtlas::clear()
+{
+	std::fill( m_texels.begin(), m_texels.end(), glm::vec4( 0.0f ) );
+}
+
+const glm::vec4& WorldPositionAtlas::getTexel(int x, int y) const {
+	return m_texels[ getTexelIndex( x, y ) ];
+}
+
+void WorldPositionAtlas::setTexel(int x, int y, const glm::vec4& texel) {
+	m_texels[ getTexelIndex( x, y ) ] = texel;
+}
+
+bool WorldPositionAtlas::isValid(int x, int y) const {
+	return m_texels[ getTexelIndex( x, y ) ].w != 0.0f;
+}
+
+int WorldPositionAtlas::countValidTexels() const
+{
+	int numValid = 0;
+	int numTexels = (int) m_texels.size();
+
+	#pragma omp parallel for reduction(+:numValid) schedule(static)
+	for ( int i = 0; i < numTexels; i++ )
+	{
+		numValid += ( m_texels[i].w != 0.0f ) ? 1 : 0;
+	}
+	return numValid;
+}
+
+void WorldPositionAtlas::getLinearTexels(std::vector<glm::vec4>& texels) const
+{
+	texels.resize( m_width * m_height );
+
+	#pragma omp parallel for schedule(static)
+	for ( int y = 0; y < m_height; y++ )
+	{
+		for ( int x = 0; x < m_width; x++ )
+		{
+			texels[ y * m_width + x ] = m_texels[ getTexelIndex( x, y ) ];
+		}
+	}
+}
+
+GLuint WorldPositionAtlas::createTexture() const
+{
+	std::vector< glm::vec4 > texels;
+	getLinearTexels( texels );
+
+	GLuint textureHandle;
+	glGenTextures( 1, &textureHandle );
+	glBindTexture( GL_TEXTURE_2D, textureHandle );
+	glTexImage2D( GL_TEXTURE_2D, 0, GL_RGBA32F_ARB, m_width, m_height, 0, GL_RGBA, GL_FLOAT, texels.empty() ? 0 : &texels[0] );
+	glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST );
+	glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST );
+	glBindTexture( GL_TEXTURE_2D, 0 );
+
+	return textureHandle;
+}
+
+void WorldPositionAtlas::readTexture(GLuint textureHandle)
+{
+	GLint width = 0;
+	GLint height = 0;
+
+	glBindTexture( GL_TEXTURE_2D, textureHandle );
+	glGetTexLevelParameteriv( GL_TEXTURE_2D, 0, GL_TEXTURE_WIDTH, &width );
+	glGetTexLevelParameteriv( GL_TEXTURE_2D, 0, GL_TEXTURE_HEIGHT, &height );
+
+	std::vector< glm::vec4 > texels( width * height );
+	if ( !texels.empty() )
+	{
+		glGetTexImage( GL_TEXTURE_2D, 0, GL_RGBA, GL_FLOAT, &texels[0] );
+	}
+	glBindTexture( GL_TEXTURE_2D, 0 );
+
+	resize( width, height );
+
+	#pragma omp parallel for schedule(static)
+	for ( int y = 0; y < height; y++ )
+	{
+		for ( int x = 0; x < width; x++ )
+		{
+			// invalid texels are stored as 0 entirely
+			const glm::vec4& texel = texels[ y * width + x ];
+			m_texels[ getTexelIndex( x, y ) ] = ( texel.w != 0.0f ) ? texel : glm::vec4( 0.0f );
+		}
+	}
+}
+
+int WorldPositionAtlas::getWidth() const {
+	return m_width;
+}
+
+int WorldPositionAtlas::getHeight() const {
+	return m_height;
+}
+
+int WorldPositionAtlas::getNumTilesX() const {
+	return m_numTilesX;
+}
+
+int WorldPositionAtlas::getNumTilesY() const {
+	return m_numTilesY;
+}
+
+const std::vector<glm::vec4>& WorldPositionAtlas::getTexels() const {
+	return m_texels;
+}
+
+int TexAtlas::rasterizeWorldPositions(const MeshRecord& mesh, const glm::mat4& modelMatrix, WorldPositionAtlas& atlas)
+{
+	return rasterizeWorldPositions( mesh, modelMatrix, atlas, glm::ivec4( 0, 0, atlas.getWidth(), atlas.getHeight() ), 1.0f );
+}
+
+int TexAtlas::rasterizeWorldPositions(const MeshRecord& mesh, const glm::mat4& modelMatrix, WorldPositionAtlas& atlas, glm::ivec4 region, float validValue)
+{
+	if ( (int) mesh.m_uvs.size() != mesh.getNumVertices() )
+	{
+		DEBUGLOG->log("ERROR : TEXTURE ATLAS RASTERIZER : amount of uv coordinates differs from amount of positions");
+		return 0;
+	}
+
+	bool invalidIndices = false;
+	int numTriangles = rasterizeChart( mesh, modelMatrix, atlas, region, validValue, invalidIndices );
+	if ( invalidIndices )
+	{
+		DEBUGLOG->log("ERROR : TEXTURE ATLAS RASTERIZER : faces reference vertices out of range, skipped them");
+	}
+	return numTriangles;
+}
+
+int TexAtlas::rasterizeChart(const MeshRecord& mesh, const glm::mat4& modelMatrix, WorldPositionAtlas& atlas, glm::ivec4 region, float validValue, bool& invalidIndices)
+{
+	invalidIndices = false;
+	if ( (int) mesh.m_uvs.size() != mesh.getNumVertices() )
+	{
+		return 0;
+	}
+
+	// clamp the region to the atlas
+	glm::ivec2 regionMin = glm::max( glm::ivec2( region.x, region.y ), glm::ivec2( 0 ) );
+	glm::ivec2 regionMax = glm::min( glm::ivec2( region.x + region.z, region.y + region.w ), glm::ivec2( atlas.getWidth(), atlas.getHeight() ) );
+	if ( regionMin.x >= regionMax.x || regionMin.y >= regionMax.y )
+	{
+		return 0;
+	}
+
+	int numVertices = mesh.getNumVertices();
+	std::vector< glm::vec3 > worldPositions( numVertices );
+
+	#pragma omp parallel for schedule(static)
+	for ( int i = 0; i < numVertices; i++ )
+	{
+		worldPositions[i] = glm::vec3( modelMatrix * glm::vec4( mesh.getPosition( i ), 1.0f ) );
+	}
+
+	// set up triangles in primitive order
+	std::vector< AtlasTriangle > triangles;
+	for ( int f = 0; f < mesh.getNumFaces(); f++ )
+	{
+		const unsigned int* face = mesh.getFace( f );
+		for ( int v = 2; v < mesh.getFaceSize( f ); v++ )
+		{
+			if ( face[0] >= (unsigned int) numVertices || face[ v - 1 ] >= (unsigned int) numVertices || face[v] >= (unsigned int) numVertices )
+			{
+				invalidIndices = true;
+				continue;
+			}
+			AtlasTriangle triangle;
+			if ( setupTriangle( mesh.m_uvs, face[0], face[ v - 1 ], face[v], region, regionMin, regionMax, triangle ) )
+			{
+				triangles.push_back( triangle );
+			}
+		}
+	}
+
+	// bin triangles by their bounds, bins cover the region only and keep the primitive order
+	int numBinsX = ( regionMax.x - regionMin.x + BIN_SIZE - 1 ) / BIN_SIZE;
+	int numBinsY = ( regionMax.y - regionMin.y + BIN_SIZE - 1 ) / BIN_SIZE;
+	std::vector< std::vector< int > > bins( numBinsX * numBinsY );
+	for ( unsigned int t = 0; t < triangles.size(); t++ )
+	{
+		for ( int binY = ( triangles[t].m_min.y - regionMin.y ) / BIN_SIZE; binY <= ( triangles[t].m_max.y - regionMin.y ) / BIN_SIZE; binY++ )
+		{
+			for ( int binX = ( triangles[t].m_min.x - regionMin.x ) / BIN_SIZE; binX <= ( triangles[t].m_max.x - regionMin.x ) / BIN_SIZE; binX++ )
+			{
+				bins[ binY * numBinsX + binX ].push_back( (int) t );
+			}
+		}
+	}
+
+	// bins cover disjoint texels, so they are rasterized independently
+	int numBins = numBinsX * numBinsY;
+
+	#pragma omp parallel for schedule(dynamic)
+	for ( int b = 0; b < numBins; b++ )
+	{
+		glm::ivec2 binMin = regionMin + glm::ivec2( ( b % numBinsX ) * BIN_SIZE, ( b / numBinsX ) * BIN_SIZE );
+		glm::ivec2 binMax = glm::min( binMin + glm::ivec2( BIN_SIZE - 1 ), regionMax - glm::ivec2( 1 ) );
+		for ( unsigned int i = 0; i < bins[b].size(); i++ )
+		{
+			rasterizeTriangle( triangles[ bins[b][i] ], worldPositions, binMin, binMax, validValue, atlas );
+		}
+	}
+
+	return (int) triangles.size();
+}
+
+int TexAtlas::rasterizeWorldPositions(ResourceManager& resourceManager, RenderableNode* renderableNode, WorldPositionAtlas& atlas)
+{
+	if ( !renderableNode || !renderableNode->getObject() || !renderableNode->getObject()->getModel() )
+	{
+		DEBUGLOG->log("ERROR : TEXTURE ATLAS RASTERIZER : renderable node has no model");
+		return 0;
+	}
+
+	Model* model = renderableNode->getObject()->getModel();
+	return rasterizeWorldPositions(
+			resourceManager.getMeshRecord( model ),
+			renderableNode->getAccumulatedModelMatrix(),
+			atlas );
+}
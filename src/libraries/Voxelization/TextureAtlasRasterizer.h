@@ -0,0 +1,120 @@
+#ifndef TEXTUREATLASRASTERIZER_H
+#define TEXTUREATLASRASTERIZER_H
+
+#include <Resources/ResourceManager.h>
+#include <Scene/RenderableNode.h>
+
+#include <glm/glm.hpp>
+#include <vector>
+
+namespace TexAtlas
+{
+	/**
+	 * This class represents a world position texture atlas in main memory, i.e. the CPU counterpart of a RGBA32F TextureAtlas
+	 * - texels are stored in tiles of TILE_SIZE x TILE_SIZE texels, so neighbouring texels of a triangle share cache lines
+	 * - a valid texel holds ( world position, 1 ), an invalid texel holds ( 0, 0, 0, 0 ), just like the texture rendered by a TextureAtlasRenderPass
+	 */
+	class WorldPositionAtlas
+	{
+	protected:
+		int m_width;
+		int m_height;
+		int m_numTilesX;
+		int m_numTilesY;
+
+		std::vector< glm::vec4 > m_texels;	// index : ( tileY * numTilesX + tileX ) * TILE_SIZE^2 + localY * TILE_SIZE + localX
+	public:
+		static const int TILE_SIZE = 8;
+
+		WorldPositionAtlas( int width = 0, int height = 0 );
+		virtual ~WorldPositionAtlas();
+
+		/**
+		 * change the resolution, all texels will be invalid afterwards
+		 */
+		void resize( int width, int height );
+
+		/**
+		 * invalidate all texels
+		 */
+		void clear();
+
+		inline int getTexelIndex( int x, int y ) const
+		{
+			return ( ( y / TILE_SIZE ) * m_numTilesX + ( x / TILE_SIZE ) ) * TILE_SIZE * TILE_SIZE + ( y % TILE_SIZE ) * TILE_SIZE + ( x % TILE_SIZE );
+		}
+
+		const glm::vec4& getTexel( int x, int y ) const;
+		void setTexel( int x, int y, const glm::vec4& texel );
+		bool isValid( int x, int y ) const;
+
+		/**
+		 * @return amount of valid texels
+		 */
+		int countValidTexels() const;
+
+		/**
+		 * copy the texels row by row, the way glGetTexImage would return them
+		 * @param texels will be resized to width * height
+		 */
+		void getLinearTexels( std::vector< glm::vec4 >& texels ) const;
+
+		/**
+		 * upload the atlas into a new GL_RGBA32F texture, i.e. to be used by a TextureAtlas
+		 * @return texture handle
+		 */
+		GLuint createTexture() const;
+
+		/**
+		 * read back a RGBA32F texture, i.e. one rendered by a TextureAtlasRenderPass, adopting its resolution
+		 */
+		void readTexture( GLuint textureHandle );
+
+		int getWidth() const;
+		int getHeight() const;
+		int getNumTilesX() const;
+		int getNumTilesY() const;
+		const std::vector< glm::vec4 >& getTexels() const;
+	};
+
+	/**
+	 * rasterize a triangle mesh in uv space, writing the interpolated world position of every covered texel
+	 * this replaces a TextureAtlasRenderPass when no GL context is available and produces the same set of valid texels:
+	 * - uv coordinates are snapped to 8 bits of sub texel precision and texels are sampled at their centers
+	 * - edges are tested with exact integer edge functions and the top left fill rule, so shared edges are covered exactly once
+	 * - triangles are binned into blocks of 64 x 64 texels of the rasterized region which are rasterized in parallel, keeping the primitive order within a block
+	 * faces with more than 3 indices are split into a triangle fan, faces with less are ignored
+	 * @param mesh vertex positions in model space, uv coordinates and faces
+	 * @param modelMatrix to transform positions into world space
+	 * @param atlas to be rasterized into, keeps its resolution and is not cleared
+	 * @return amount of rasterized triangles
+	 */
+	int rasterizeWorldPositions( const MeshRecord& mesh, const glm::mat4& modelMatrix, WorldPositionAtlas& atlas );
+
+	/**
+	 * rasterize a triangle mesh into a region of an atlas, i.e. a chart of a packed atlas
+	 * @see rasterizeWorldPositions
+	 * @param region x, y, width, height of the texels the uv range 0..1 is mapped to, no texel outside of it is written
+	 * @param validValue w component of covered texels, must not be 0
+	 */
+	int rasterizeWorldPositions( const MeshRecord& mesh, const glm::mat4& modelMatrix, WorldPositionAtlas& atlas, glm::ivec4 region, float validValue );
+
+	/**
+	 * rasterize a triangle mesh into a region of an atlas without logging, so disjoint regions may be rasterized from several threads at once
+	 * @see rasterizeWorldPositions
+	 * @param invalidIndices set to true if faces reference vertices out of range, they are skipped
+	 * @return amount of rasterized triangles, 0 if the amount of uv coordinates differs from the amount of positions
+	 */
+	int rasterizeChart( const MeshRecord& mesh, const glm::mat4& modelMatrix, WorldPositionAtlas& atlas, glm::ivec4 region, float validValue, bool& invalidIndices );
+
+	/**
+	 * rasterize the model of a renderable node with its accumulated model matrix
+	 * @param resourceManager which loaded the model of the node
+	 * @param renderableNode to be rasterized
+	 * @param atlas to be rasterized into
+	 * @return amount of rasterized triangles
+	 */
+	int rasterizeWorldPositions( ResourceManager& resourceManager, RenderableNode* renderableNode, WorldPositionAtlas& atlas );
+}
+
+#endif
@@ -0,0 +1,132 @@
+#include "TextureAtlasSizing.h"
+
+#include <Utility/DebugLog.h>
+
+#include <algorithm>
+#include <cmath>
+
+using namespace TexAtlas;
+
+TexAtlas::AtlasSizing TexAtlas::computeAtlasSizing(const MeshRecord& mesh, const glm::mat4& modelMatrix, float cellSize, int maxResolution)
+{
+	AtlasSizing sizing;
+	sizing.m_surfaceArea = 0.0f;
+	sizing.m_uvArea = 0.0f;
+	sizing.m_meanStretch = 0.0f;
+	sizing.m_maxStretch = 0.0f;
+	sizing.m_numDegenerateTriangles = 0;
+	sizing.m_resolution = 1;
+
+	if ( (int) mesh.m_uvs.size() != mesh.getNumVertices() )
+	{
+		DEBUGLOG->log("ERROR : TEXTURE ATLAS SIZING : amount of uv coordinates differs from amount of positions");
+		return sizing;
+	}
+	if ( cellSize <= 0.0f )
+	{
+		DEBUGLOG->log("ERROR : TEXTURE ATLAS SIZING : cell size must be positive : ", cellSize);
+		return sizing;
+	}
+
+	unsigned int numVertices = (unsigned int) mesh.getNumVertices();
+	int numFaces = mesh.getNumFaces();
+	double surfaceArea = 0.0;
+	double uvArea = 0.0;
+	float maxStretch = 0.0f;
+	int numDegenerateTriangles = 0;
+
+	#pragma omp parallel
+	{
+		double localSurfaceArea = 0.0;
+		double localUVArea = 0.0;
+		float localMaxStretch = 0.0f;
+		int localNumDegenerateTriangles = 0;
+
+		#pragma omp for schedule(static)
+		for ( int f = 0; f < numFaces; f++ )
+		{
+			const unsigned int* face = mesh.getFace( f );
+			for ( int v = 2; v < mesh.getFaceSize( f ); v++ )
+			{
+				unsigned int i0 = face[0];
+				unsigned int i1 = face[ v - 1 ];
+				unsigned int i2 = face[v];
+				if ( i0 >= numVertices || i1 >= numVertices || i2 >= numVertices )
+				{
+					continue;
+				}
+
+				glm::vec3 p0 = glm::vec3( modelMatrix * glm::vec4( mesh.getPosition( i0 ), 1.0f ) );
+				glm::vec3 edge1 = glm::vec3( modelMatrix * glm::vec4( mesh.getPosition( i1 ), 1.0f ) ) - p0;
+				glm::vec3 edge2 = glm::vec3( modelMatrix * glm::vec4( mesh.getPosition( i2 ), 1.0f ) ) - p0;
+				glm::vec2 uvEdge1 = mesh.m_uvs[ i1 ] - mesh.m_uvs[ i0 ];
+				glm::vec2 uvEdge2 = mesh.m_uvs[ i2 ] - mesh.m_uvs[ i0 ];
+
+				float worldArea = 0.5f * glm::length( glm::cross( edge1, edge2 ) );
+				float determinant = uvEdge1.x * uvEdge2.y - uvEdge2.x * uvEdge1.y;
+
+				localSurfaceArea += worldArea;
+				localUVArea += 0.5f * std::fabs( determinant );
+
+				if ( determinant == 0.0f )
+				{
+					localNumDegenerateTriangles += ( worldArea > 0.0f ) ? 1 : 0;
+					continue;
+				}
+
+				// derivatives of the world position along u and v
+				glm::vec3 dPdu = ( edge1 * uvEdge2.y - edge2 * uvEdge1.y ) / determinant;
+				glm::vec3 dPdv = ( edge2 * uvEdge1.x - edge1 * uvEdge2.x ) / determinant;
+
+				// largest singular value from the eigenvalues of the first fundamental form
+				float e = glm::dot( dPdu, dPdu );
+				float fuv = glm::dot( dPdu, dPdv );
+				float g = glm::dot( dPdv, dPdv );
+				float halfDifference = 0.5f * ( e - g );
+				float largestEigenvalue = 0.5f * ( e + g ) + std::sqrt( halfDifference * halfDifference + fuv * fuv );
+
+				localMaxStretch = std::max( localMaxStretch, std::sqrt( largestEigenvalue ) );
+			}
+		}
+
+		#pragma omp critical
+		{
+			surfaceArea += localSurfaceArea;
+			uvArea += localUVArea;
+			maxStretch = std::max( maxStretch, localMaxStretch );
+			numDegenerateTriangles += localNumDegenerateTriangles;
+		}
+	}
+
+	sizing.m_surfaceArea = (float) surfaceArea;
+	sizing.m_uvArea = (float) uvArea;
+	sizing.m_meanStretch = ( uvArea > 0.0 ) ? (float) std::sqrt( surfaceArea / uvArea ) : 0.0f;
+	sizing.m_maxStretch = maxStretch;
+	sizing.m_numDegenerateTriangles = numDegenerateTriangles;
+
+	// texel diagonal in world space : maxStretch * sqrt(2) / resolution <= cellSize
+	double resolution = std::ceil( (double) maxStretch * std::sqrt( 2.0 ) / (double) cellSize );
+	if ( resolution > (double) maxResolution )
+	{
+		DEBUGLOG->log("TEXTURE ATLAS SIZING : required resolution exceeds the maximum, voxels may be missed : ", (float) resolution);
+	}
+	sizing.m_resolution = (int) std::min( std::max( resolution, 1.0 ), (double) std::max( maxResolution, 1 ) );
+
+	return sizing;
+}
+
+TexAtlas::AtlasSizing TexAtlas::computeAtlasSizing(ResourceManager& resourceManager, RenderableNode* renderableNode, float cellSize, int maxResolution)
+{
+	if ( !renderableNode || !renderableNode->getObject() || !renderableNode->getObject()->getModel() )
+	{
+		DEBUGLOG->log("ERROR : TEXTURE ATLAS SIZING : renderable node has no model");
+		return computeAtlasSizing( MeshRecord(), glm::mat4( 1.0f ), cellSize, maxResolution );
+	}
+
+	Model* model = renderableNode->getObject()->getModel();
+	return computeAtlasSizing(
+			resourceManager.getMeshRecord( model ),
+			renderableNode->getAccumulatedModelMatrix(),
+			cellSize,
+			maxResolution );
+}
@@ -0,0 +1,45 @@
+#ifndef TEXTUREATLASSIZING_H
+#define TEXTUREATLASSIZING_H
+
+#include <Resources/ResourceManager.h>
+#include <Scene/RenderableNode.h>
+
+#include <glm/glm.hpp>
+#include <vector>
+
+namespace TexAtlas
+{
+	/**
+	 * surface measures of a mesh in world space and uv space, and the atlas resolution derived from them
+	 */
+	struct AtlasSizing
+	{
+		float m_surfaceArea;		// world space area of all triangles
+		float m_uvArea;				// uv space area of all triangles, exceeds 1 if charts overlap
+		float m_meanStretch;		// sqrt( surface area / uv area ), world length per uv length on average
+		float m_maxStretch;			// largest singular value of the uv to world mapping of any triangle
+		int m_numDegenerateTriangles;	// triangles with zero uv area, these are never rasterized
+		int m_resolution;			// side length of the square atlas
+	};
+
+	/**
+	 * measure a mesh and pick the smallest square atlas which guarantees at least one texel per voxel footprint:
+	 * every triangle maps a texel to a parallelogram in world space whose diagonal is at most its largest stretch * sqrt(2) / resolution,
+	 * so the resolution is chosen such that this diagonal does not exceed the cell size anywhere on the surface
+	 * voxels which only contain a sliver of the surface, narrower than the texel spacing, may still be missed
+	 * @param mesh vertex positions in model space, uv coordinates and faces, faces with more than 3 indices are split into a triangle fan
+	 * @param modelMatrix to transform positions into world space
+	 * @param cellSize side length of a voxel, i.e. of the finest grid the atlas will be used with
+	 * @param maxResolution upper bound of the resolution, i.e. the maximum texture size
+	 * @return measures and resolution, which is at least 1
+	 */
+	AtlasSizing computeAtlasSizing( const MeshRecord& mesh, const glm::mat4& modelMatrix, float cellSize, int maxResolution = 8192 );
+
+	/**
+	 * measure the model of a renderable node with its accumulated model matrix
+	 * @see computeAtlasSizing
+	 */
+	AtlasSizing computeAtlasSizing( ResourceManager& resourceManager, RenderableNode* renderableNode, float cellSize, int maxResolution = 8192 );
+}
+
+#endif
@@ -0,0 +1,167 @@
+#include "VoxelCompaction.h"
+
+#include <Utility/BitTools.h>
+
+#include <algorithm>
+#include <utility>
+
+using namespace Grid;
+
+static const int BRICK_SIZE = 32;					// edge length of a brick, equal to the bits per word
+static const int BRICK_BITS = 15;					// bits of a morton code inside a brick
+static const int BRICK_CODES = 1 << BRICK_BITS;	// amount of voxels per brick
+
+/**
+ * @return amount of occupied voxels of a brick
+ */
+static int countBrick( const BitVoxelGrid& voxelGrid, int bx, int by, int layer )
+{
+	const unsigned int* words = &voxelGrid.getWords()[0];
+	int xEnd = std::min( ( bx + 1 ) * BRICK_SIZE, voxelGrid.getWidth() );
+	int yEnd = std::min( ( by + 1 ) * BRICK_SIZE, voxelGrid.getHeight() );
+
+	int count = 0;
+	for ( int y = by * BRICK_SIZE; y < yEnd; y++ )
+	{
+		for ( int x = bx * BRICK_SIZE; x < xEnd; x++ )
+		{
+			count += BitTools::popCount( words[ voxelGrid.getWordIndex( x, y, layer ) ] );
+		}
+	}
+	return count;
+}
+
+/**
+ * write the occupied voxels of a brick in morton order
+ * every voxel sets the bit of its local morton code in a bit set of 32^3 bits, which is then read in order
+ * @param codes bit set of BRICK_CODES bits, must be empty and will be empty afterwards
+ */
+static void fillBrick( const BitVoxelGrid& voxelGrid, int bx, int by, int layer, unsigned long long brickCode, std::vector< unsigned int >& codes, glm::ivec3* coordinates, unsigned long long* mortonCodes )
+{
+	const unsigned int* words = &voxelGrid.getWords()[0];
+	int xEnd = std::min( ( bx + 1 ) * BRICK_SIZE, voxelGrid.getWidth() );
+	int yEnd = std::min( ( by + 1 ) * BRICK_SIZE, voxelGrid.getHeight() );
+
+	for ( int y = by * BRICK_SIZE; y < yEnd; y++ )
+	{
+		for ( int x = bx * BRICK_SIZE; x < xEnd; x++ )
+		{
+			unsigned int word = words[ voxelGrid.getWordIndex( x, y, layer ) ];
+			unsigned int xy = BitTools::encodeMorton3( x & ( BRICK_SIZE - 1 ), y & ( BRICK_SIZE - 1 ), 0 );
+			while ( word )
+			{
+				int z = BitTools::countTrailingZeros( word );
+				word &= word - 1;
+				unsigned int code = xy | ( BitTools::spreadBits3( z ) << 2 );
+				codes[ code >> 5 ] |= 1u << ( code & 31 );
+			}
+		}
+	}
+
+	glm::ivec3 brickOrigin( bx * BRICK_SIZE, by * BRICK_SIZE, layer * BRICK_SIZE );
+	int i = 0;
+	for ( int w = 0; w < BRICK_CODES / 32; w++ )
+	{
+		unsigned int word = codes[w];
+		codes[w] = 0;
+		while ( word )
+		{
+			unsigned int code = w * 32 + BitTools::countTrailingZeros( word );
+			word &= word - 1;
+
+			coordinates[i] = brickOrigin + glm::ivec3( BitTools::compactBits3( code ), BitTools::compactBits3( code >> 1 ), BitTools::compactBits3( code >> 2 ) );
+			if ( mortonCodes )
+			{
+				mortonCodes[i] = ( brickCode << BRICK_BITS ) | code;
+			}
+			i++;
+		}
+	}
+}
+
+int Grid::compactOccupiedVoxels(const BitVoxelGrid& voxelGrid, std::vector<glm::ivec3>& coordinates, std::vector<unsigned long long>* mortonCodes)
+{
+	coordinates.clear();
+	if ( mortonCodes )
+	{
+		mortonCodes->clear();
+	}
+	if ( voxelGrid.getNumWords() == 0 )
+	{
+		return 0;
+	}
+
+	int numBricksX = ( voxelGrid.getWidth() + BRICK_SIZE - 1 ) / BRICK_SIZE;
+	int numBricksY = ( voxelGrid.getHeight() + BRICK_SIZE - 1 ) / BRICK_SIZE;
+	int numLayers = voxelGrid.getNumWordLayers();
+	int numBricks = numBricksX * numBricksY * numLayers;
+
+	// visit bricks in morton order of their brick coordinates
+	std::vector< std::pair< unsigned int, int > > bricks( numBricks );
+	for ( int i = 0; i < numBricks; i++ )
+	{
+		int bx = i % numBricksX;
+		int by = ( i / numBricksX ) % numBricksY;
+		int layer = i / ( numBricksX * numBricksY );
+		bricks[i] = std::make_pair( BitTools::encodeMorton3( bx, by, layer ), i );
+	}
+	std::sort( bricks.begin(), bricks.end() );
+
+	// exclusive prefix sum of the brick counts yields the write offsets
+	std::vector< int > offsets( numBricks + 1, 0 );
+
+	#pragma omp parallel for schedule(dynamic)
+	for ( int i = 0; i < numBricks; i++ )
+	{
+		int brick = bricks[i].second;
+		offsets[ i + 1 ] = countBrick( voxelGrid, brick % numBricksX, ( brick / numBricksX ) % numBricksY, brick / ( numBricksX * numBricksY ) );
+	}
+	for ( int i = 0; i < numBricks; i++ )
+	{
+		offsets[ i + 1 ] += offsets[i];
+	}
+
+	int numVoxels = offsets[ numBricks ];
+	if ( numVoxels == 0 )
+	{
+		return 0;
+	}
+
+	coordinates.resize( numVoxels );
+	if ( mortonCodes )
+	{
+		mortonCodes->resize( numVoxels );
+	}
+
+	#pragma omp parallel
+	{
+		std::vector< unsigned int > codes( BRICK_CODES / 32, 0 );
+
+		#pragma omp for schedule(dynamic)
+		for ( int i = 0; i < numBricks; i++ )
+		{
+			if ( offsets[ i + 1 ] == offsets[i] )
+			{
+				continue;
+			}
+			int brick = bricks[i].second;
+			fillBrick( voxelGrid, brick % numBricksX, ( brick / numBricksX ) % numBricksY, brick / ( numBricksX * numBricksY ), bricks[i].first, codes,
+					&coordinates[ offsets[i] ], ( mortonCodes ) ? &( *mortonCodes )[ offsets[i] ] : 0 );
+		}
+	}
+
+	return numVoxels;
+}
+
+void Grid::computeVoxelCenters(const BitVoxelGrid& voxelGrid, const std::vector<glm::ivec3>& coordinates, std::vector<glm::vec3>& centers)
+{
+	glm::mat4 voxelToWorld = glm::inverse( voxelGrid.getWorldToVoxel() );
+	int numVoxels = (int) coordinates.size();
+	centers.resize( numVoxels );
+
+	#pragma omp parallel for schedule(static)
+	for ( int i = 0; i < numVoxels; i++ )
+	{
+		centers[i] = glm::vec3( voxelToWorld * glm::vec4( glm::vec3( coordinates[i] ) + glm::vec3( 0.5f ), 1.0f ) );
+	}
+}
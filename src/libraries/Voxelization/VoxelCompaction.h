@@ -0,0 +1,31 @@
+#ifndef VOXELCOMPACTION_H
+#define VOXELCOMPACTION_H
+
+#include <Voxelization/BitVoxelGrid.h>
+
+#include <vector>
+
+namespace Grid
+{
+	/**
+	 * compact the coordinates of all occupied voxels of a grid into a dense array, sorted by morton code
+	 * the grid is split into bricks of 32^3 voxels, i.e. 32 x 32 words of one word layer, which are visited in morton order.
+	 * the amount of voxels per brick is counted in parallel using popcount, their prefix sums are the write offsets,
+	 * so every brick fills its range of the array in parallel without any dynamic growth
+	 * @param voxelGrid to be compacted
+	 * @param coordinates will be overwritten with the grid coordinates of the occupied voxels
+	 * @param mortonCodes will be overwritten with the morton code of every coordinate, may be 0
+	 * @return amount of occupied voxels
+	 */
+	int compactOccupiedVoxels( const BitVoxelGrid& voxelGrid, std::vector< glm::ivec3 >& coordinates, std::vector< unsigned long long >* mortonCodes = 0 );
+
+	/**
+	 * compute the world space centers of voxels in parallel
+	 * @param voxelGrid providing the mapping from voxel to world coordinates
+	 * @param coordinates grid coordinates of the voxels
+	 * @param centers will be overwritten with the voxel centers in world coordinates
+	 */
+	void computeVoxelCenters( const BitVoxelGrid& voxelGrid, const std::vector< glm::ivec3 >& coordinates, std::vector< glm::vec3 >& centers );
+}
+
+#endif
@@ -0,0 +1,123 @@
+#include "VoxelCounting.h"
+
+#include <Utility/BitTools.h>
+#include <Utility/DebugLog.h>
+
+Grid::OccupancyHistogram::OccupancyHistogram()
+{
+	m_total = 0;
+	m_brickSize = 0;
+	m_numBricksX = 0;
+	m_numBricksY = 0;
+	m_numBricksZ = 0;
+}
+
+unsigned int Grid::OccupancyHistogram::getBrickCount(int bx, int by, int bz) const
+{
+	if ( bx < 0 || bx >= m_numBricksX || by < 0 || by >= m_numBricksY || bz < 0 || bz >= m_numBricksZ )
+	{
+		return 0;
+	}
+	return m_brickCounts[ ( bz * m_numBricksY + by ) * m_numBricksX + bx ];
+}
+
+Grid::OccupancyHistogram Grid::countOccupiedVoxels(const BitVoxelGrid& voxelGrid, int brickSize)
+{
+	OccupancyHistogram histogram;
+
+	// brick boundaries must not cross word boundaries
+	if ( brickSize <= 0 || brickSize > 32 || ( brickSize & ( brickSize - 1 ) ) != 0 )
+	{
+		DEBUGLOG->log("ERROR : VOXEL COUNTING : brick size must be a power of two not larger than 32, using 8 instead of : ", brickSize);
+		brickSize = 8;
+	}
+
+	int width = voxelGrid.getWidth();
+	int height = voxelGrid.getHeight();
+	int numWordLayers = voxelGrid.getNumWordLayers();
+
+	histogram.m_brickSize = brickSize;
+	histogram.m_numBricksX = ( width + brickSize - 1 ) / brickSize;
+	histogram.m_numBricksY = ( height + brickSize - 1 ) / brickSize;
+	histogram.m_numBricksZ = ( voxelGrid.getDepth() + brickSize - 1 ) / brickSize;
+	histogram.m_brickCounts.assign( histogram.m_numBricksX * histogram.m_numBricksY * histogram.m_numBricksZ, 0u );
+	histogram.m_slabCounts.assign( histogram.m_numBricksZ, 0u );
+
+	if ( voxelGrid.getNumWords() == 0 )
+	{
+		return histogram;
+	}
+
+	const unsigned int* words = &voxelGrid.getWords()[0];
+	const int bricksPerWord = 32 / brickSize;
+	const unsigned int brickMask = BitTools::getRangeMask( 0, brickSize );
+	const int numBricksX = histogram.m_numBricksX;
+	const int numBricksY = histogram.m_numBricksY;
+	const int numBricksZ = histogram.m_numBricksZ;
+	unsigned int* brickCounts = &histogram.m_brickCounts[0];
+
+	unsigned int total = 0;
+
+	// every thread owns a row of bricks, so brick counters are never shared
+	#pragma omp parallel for reduction(+:total) schedule(dynamic)
+	for ( int by = 0; by < numBricksY; by++ )
+	{
+		int yEnd = ( ( by + 1 ) * brickSize < height ) ? ( by + 1 ) * brickSize : height;
+		for ( int layer = 0; layer < numWordLayers; layer++ )
+		{
+			for ( int y = by * brickSize; y < yEnd; y++ )
+			{
+				const unsigned int* row = words + voxelGrid.getWordIndex( 0, y, layer );
+				for ( int x = 0; x < width; x++ )
+				{
+					unsigned int word = row[x];
+					if ( word == 0 )
+					{
+						continue;
+					}
+
+					int bx = x / brickSize;
+					for ( int i = 0; i < bricksPerWord; i++ )
+					{
+						unsigned int brickBits = ( word >> ( i * brickSize ) ) & brickMask;
+						int bz = layer * bricksPerWord + i;
+						if ( brickBits != 0 && bz < numBricksZ )
+						{
+							unsigned int amount = BitTools::popCount( brickBits );
+							brickCounts[ ( bz * numBricksY + by ) * numBricksX + bx ] += amount;
+							total += amount;
+						}
+					}
+				}
+			}
+		}
+	}
+
+	// accumulate slabs from bricks
+	for ( int bz = 0; bz < numBricksZ; bz++ )
+	{
+		unsigned int slabCount = 0;
+		for ( int i = 0; i < numBricksX * numBricksY; i++ )
+		{
+			slabCount += brickCounts[ bz * numBricksX * numBricksY + i ];
+		}
+		histogram.m_slabCounts[bz] = slabCount;
+	}
+
+	histogram.m_total = total;
+
+	return histogram;
+}
+
+unsigned int Grid::countOccupiedVoxels(const unsigned int* words, int numWords)
+{
+	unsigned int total = 0;
+
+	#pragma omp parallel for reduction(+:total)
+	for ( int i = 0; i < numWords; i++ )
+	{
+		total += BitTools::popCount( words[i] );
+	}
+
+	return total;
+}
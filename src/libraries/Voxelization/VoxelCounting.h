@@ -0,0 +1,50 @@
+#ifndef VOXELCOUNTING_H
+#define VOXELCOUNTING_H
+
+#include <Voxelization/BitVoxelGrid.h>
+
+#include <vector>
+
+namespace Grid
+{
+	/**
+	 * Result of counting the occupied voxels of a bit voxel grid
+	 * - total amount of occupied voxels
+	 * - occupied voxels per z slab ( brickSize slices thick )
+	 * - occupied voxels per brick ( brickSize^3 voxels )
+	 */
+	class OccupancyHistogram
+	{
+	public:
+		unsigned int m_total;
+		int m_brickSize;
+		int m_numBricksX;
+		int m_numBricksY;
+		int m_numBricksZ;
+
+		std::vector< unsigned int > m_slabCounts;	// index : bz
+		std::vector< unsigned int > m_brickCounts;	// index : ( bz * numBricksY + by ) * numBricksX + bx
+
+		OccupancyHistogram();
+
+		unsigned int getBrickCount( int bx, int by, int bz ) const;
+	};
+
+	/**
+	 * count all occupied voxels of a grid in one parallel pass using hardware popcount on the grid words
+	 * @param voxelGrid to be counted
+	 * @param brickSize side length of a brick, must be a power of two not larger than 32
+	 * @return total amount, per slab and per brick amounts of occupied voxels
+	 */
+	OccupancyHistogram countOccupiedVoxels( const BitVoxelGrid& voxelGrid, int brickSize = 8 );
+
+	/**
+	 * count all set bits of raw slice map words, i.e. read back R32UI texture data
+	 * @param words to be counted
+	 * @param numWords amount of words
+	 * @return amount of set bits
+	 */
+	unsigned int countOccupiedVoxels( const unsigned int* words, int numWords );
+}
+
+#endif
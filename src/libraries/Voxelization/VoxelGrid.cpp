@@ -115,7 +115,7 @@ GridCell* VoxelGridCPU::getGridCell(int x, int y, int z)
 
 bool VoxelGridCPU::checkCoordinates(int x, int y, int z)
 {
-	return ( ( x > 0 && x < m_width ) && ( y > 0 && y < m_height ) && ( z > 0 && z < m_depth ) );
+	return ( ( x >= 0 && x < m_width ) && ( y >= 0 && y < m_height ) && ( z >= 0 && z < m_depth ) );
 }
 
 float Grid::AxisAlignedVoxelGrid::getX() const {
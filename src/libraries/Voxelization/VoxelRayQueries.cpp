@@ -0,0 +1,671 @@
+#include "VoxelRayQueries.h"
+
+#include <Voxelization/VoxelGrid.h>
+#include <Utility/BitTools.h>
+#include <Utility/DebugLog.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+using namespace Grid;
+
+static const int RAY_PACKET_SIZE = 8;
+static const int RAY_PACKET_MIN_ACTIVE_RAYS = 3;	// packets with fewer active rays are continued ray by ray
+
+/**
+ * compute the ray parameter where the ray leaves the voxel of the given level containing voxel
+ * @param lower will be set to the first covered level 0 coordinate per axis
+ * @param upper will be set to the last covered level 0 coordinate + 1 per axis
+ * @param exitAxis will be set to the axis through which the ray leaves, -1 if the direction is zero
+ */
+static inline float computeExit( const glm::vec3& origin, const glm::vec3& direction, const glm::vec3& inverseDirection, const glm::ivec3& voxel, int level, glm::ivec3& lower, glm::ivec3& upper, int& exitAxis )
+{
+	float tExit = std::numeric_limits<float>::max();
+	exitAxis = -1;
+
+	for ( int axis = 0; axis < 3; axis++ )
+	{
+		lower[axis] = ( voxel[axis] >> level ) << level;
+		upper[axis] = lower[axis] + ( 1 << level );
+
+		float tAxis;
+		if ( direction[axis] > 0.0f )
+		{
+			tAxis = ( (float) upper[axis] - origin[axis] ) * inverseDirection[axis];
+		}
+		else if ( direction[axis] < 0.0f )
+		{
+			tAxis = ( (float) lower[axis] - origin[axis] ) * inverseDirection[axis];
+		}
+		else
+		{
+			continue;
+		}
+
+		if ( tAxis < tExit )
+		{
+			tExit = tAxis;
+			exitAxis = axis;
+		}
+	}
+
+	return tExit;
+}
+
+/**
+ * advance the ray to the next voxel behind the voxel of the given level containing voxel
+ * @return false if the ray leaves the grid or passes tMax
+ */
+static inline bool stepOut( const glm::vec3& origin, const glm::vec3& direction, const glm::vec3& inverseDirection, const glm::ivec3& resolution, int level, float tMax, glm::ivec3& voxel, float& t )
+{
+	glm::ivec3 lower;
+	glm::ivec3 upper;
+	int exitAxis;
+	float tExit = computeExit( origin, direction, inverseDirection, voxel, level, lower, upper, exitAxis );
+
+	if ( exitAxis < 0 )
+	{
+		return false;
+	}
+
+	// never step backwards due to rounding
+	if ( tExit > t )
+	{
+		t = tExit;
+	}
+
+	for ( int axis = 0; axis < 3; axis++ )
+	{
+		if ( axis == exitAxis )
+		{
+			voxel[axis] = ( direction[axis] > 0.0f ) ? upper[axis] : lower[axis] - 1;
+			if ( voxel[axis] < 0 || voxel[axis] >= resolution[axis] )
+			{
+				return false;
+			}
+		}
+		else
+		{
+			// stay within the extent of the voxel being left, regardless of rounding
+			int coordinate = (int) std::floor( origin[axis] + direction[axis] * t );
+			int last = ( upper[axis] < resolution[axis] ) ? upper[axis] - 1 : resolution[axis] - 1;
+			voxel[axis] = ( coordinate < lower[axis] ) ? lower[axis] : ( ( coordinate > last ) ? last : coordinate );
+		}
+	}
+
+	return t <= tMax;
+}
+
+#ifdef __AVX2__
+/**
+ * state of a packet of 8 rays in grid coordinates, one lane per ray
+ */
+struct RayPacket
+{
+	__m256 origin[3];
+	__m256 direction[3];
+	__m256 inverseDirection[3];
+	__m256 t;
+	__m256 tEnd;
+	__m256i voxel[3];
+	__m256i active;	// all bits set for lanes still being traversed
+};
+
+/**
+ * gather the occupancy of the voxels of the given pyramid level containing the voxels of all active lanes
+ * @return all bits set for active lanes with an occupied voxel
+ */
+static inline __m256i gatherOccupancy( const OccupancyPyramid& pyramid, int level, const RayPacket& packet )
+{
+	const BitVoxelGrid& grid = pyramid.getLevel( level );
+	__m128i shift = _mm_cvtsi32_si128( level );
+
+	__m256i x = _mm256_srl_epi32( packet.voxel[0], shift );
+	__m256i y = _mm256_srl_epi32( packet.voxel[1], shift );
+	__m256i z = _mm256_srl_epi32( packet.voxel[2], shift );
+
+	// ( ( z / 32 ) * height + y ) * width + x
+	__m256i index = _mm256_mullo_epi32( _mm256_srli_epi32( z, 5 ), _mm256_set1_epi32( grid.getHeight() ) );
+	index = _mm256_mullo_epi32( _mm256_add_epi32( index, y ), _mm256_set1_epi32( grid.getWidth() ) );
+	index = _mm256_add_epi32( index, x );
+
+	__m256i words = _mm256_mask_i32gather_epi32( _mm256_setzero_si256(), (const int*) &grid.getWords()[0], index, packet.active, 4 );
+	__m256i bits = _mm256_srlv_epi32( words, _mm256_and_si256( z, _mm256_set1_epi32( 31 ) ) );
+	bits = _mm256_and_si256( bits, _mm256_set1_epi32( 1 ) );
+
+	return _mm256_and_si256( _mm256_cmpeq_epi32( bits, _mm256_set1_epi32( 1 ) ), packet.active );
+}
+
+/**
+ * packet version of computeExit
+ * @param exitAxis will be set to all bits for the axis through which each lane leaves
+ */
+static inline __m256 computePacketExit( const RayPacket& packet, int level, __m256i* lower, __m256i* upper, __m256i* exitAxis )
+{
+	__m128i shift = _mm_cvtsi32_si128( level );
+	__m256i size = _mm256_set1_epi32( 1 << level );
+	__m256 noExit = _mm256_set1_ps( std::numeric_limits<float>::max() );
+
+	__m256 tAxis[3];
+	for ( int axis = 0; axis < 3; axis++ )
+	{
+		lower[axis] = _mm256_sll_epi32( _mm256_srl_epi32( packet.voxel[axis], shift ), shift );
+		upper[axis] = _mm256_add_epi32( lower[axis], size );
+
+		__m256 positive = _mm256_cmp_ps( packet.direction[axis], _mm256_setzero_ps(), _CMP_GT_OQ );
+		__m256 negative = _mm256_cmp_ps( packet.direction[axis], _mm256_setzero_ps(), _CMP_LT_OQ );
+		__m256 boundary = _mm256_blendv_ps( _mm256_cvtepi32_ps( lower[axis] ), _mm256_cvtepi32_ps( upper[axis] ), positive );
+
+		tAxis[axis] = _mm256_mul_ps( _mm256_sub_ps( boundary, packet.origin[axis] ), packet.inverseDirection[axis] );
+		tAxis[axis] = _mm256_blendv_ps( noExit, tAxis[axis], _mm256_or_ps( positive, negative ) );
+	}
+
+	// ties are resolved in favour of the lower axis, just like computeExit
+	__m256 exitX = _mm256_and_ps( _mm256_cmp_ps( tAxis[0], tAxis[1], _CMP_LE_OQ ), _mm256_cmp_ps( tAxis[0], tAxis[2], _CMP_LE_OQ ) );
+	__m256 exitY = _mm256_andnot_ps( exitX, _mm256_cmp_ps( tAxis[1], tAxis[2], _CMP_LE_OQ ) );
+	__m256 exitZ = _mm256_andnot_ps( _mm256_or_ps( exitX, exitY ), _mm256_castsi256_ps( _mm256_set1_epi32( -1 ) ) );
+	exitAxis[0] = _mm256_castps_si256( exitX );
+	exitAxis[1] = _mm256_castps_si256( exitY );
+	exitAxis[2] = _mm256_castps_si256( exitZ );
+
+	return _mm256_min_ps( tAxis[0], _mm256_min_ps( tAxis[1], tAxis[2] ) );
+}
+
+/**
+ * packet version of stepOut, lanes leaving the grid or passing tEnd are deactivated
+ */
+static inline void stepPacketOut( RayPacket& packet, int level, const glm::ivec3& resolution )
+{
+	__m256i lower[3];
+	__m256i upper[3];
+	__m256i exitAxis[3];
+	__m256 tExit = computePacketExit( packet, level, lower, upper, exitAxis );
+
+	__m256 activeMask = _mm256_castsi256_ps( packet.active );
+	__m256 hasExit = _mm256_cmp_ps( tExit, _mm256_set1_ps( std::numeric_limits<float>::max() ), _CMP_LT_OQ );
+	packet.t = _mm256_blendv_ps( packet.t, _mm256_max_ps( packet.t, tExit ), activeMask );
+
+	__m256i one = _mm256_set1_epi32( 1 );
+	__m256i outside = _mm256_setzero_si256();
+	for ( int axis = 0; axis < 3; axis++ )
+	{
+		__m256i size = _mm256_set1_epi32( resolution[axis] );
+		__m256i positive = _mm256_castps_si256( _mm256_cmp_ps( packet.direction[axis], _mm256_setzero_ps(), _CMP_GT_OQ ) );
+		__m256i exitVoxel = _mm256_blendv_epi8( _mm256_sub_epi32( lower[axis], one ), upper[axis], positive );
+
+		// stay within the extent of the voxel being left, regardless of rounding
+		__m256 position = _mm256_add_ps( packet.origin[axis], _mm256_mul_ps( packet.direction[axis], packet.t ) );
+		__m256i coordinate = _mm256_cvttps_epi32( _mm256_floor_ps( position ) );
+		__m256i last = _mm256_sub_epi32( _mm256_min_epi32( upper[axis], size ), one );
+		coordinate = _mm256_min_epi32( _mm256_max_epi32( coordinate, lower[axis] ), last );
+
+		__m256i voxel = _mm256_blendv_epi8( coordinate, exitVoxel, exitAxis[axis] );
+		__m256i outOfRange = _mm256_or_si256( _mm256_cmpgt_epi32( _mm256_setzero_si256(), voxel ), _mm256_cmpgt_epi32( voxel, _mm256_sub_epi32( size, one ) ) );
+		outside = _mm256_or_si256( outside, _mm256_and_si256( outOfRange, exitAxis[axis] ) );
+
+		packet.voxel[axis] = _mm256_blendv_epi8( packet.voxel[axis], voxel, packet.active );
+	}
+
+	__m256 inRange = _mm256_and_ps( hasExit, _mm256_cmp_ps( packet.t, packet.tEnd, _CMP_LE_OQ ) );
+	packet.active = _mm256_andnot_si256( outside, _mm256_and_si256( packet.active, _mm256_castps_si256( inRange ) ) );
+}
+#endif
+
+RayHit::RayHit()
+{
+	m_voxel = glm::ivec3( -1, -1, -1 );
+	m_tEnter = 0.0f;
+	m_tExit = 0.0f;
+}
+
+bool RayHit::isHit() const
+{
+	return m_voxel.x >= 0;
+}
+
+RayQueries::RayQueries(const BitVoxelGrid* voxelGrid)
+	: m_pyramid( voxelGrid )
+{
+	p_voxelGrid = voxelGrid;
+}
+
+RayQueries::RayQueries(AxisAlignedVoxelGrid* axisAlignedVoxelGrid)
+{
+	p_voxelGrid = &m_convertedGrid;
+
+	update( axisAlignedVoxelGrid );
+}
+
+RayQueries::~RayQueries()
+{
+}
+
+void RayQueries::update()
+{
+	m_pyramid.setVoxelGrid( p_voxelGrid );
+}
+
+void RayQueries::update(AxisAlignedVoxelGrid* axisAlignedVoxelGrid)
+{
+	m_convertedGrid.readFromAxisAlignedVoxelGrid( axisAlignedVoxelGrid );
+	p_voxelGrid = &m_convertedGrid;
+
+	update();
+}
+
+bool RayQueries::enterGrid(const glm::vec3& worldOrigin, const glm::vec3& worldDirection, float tMin, float tMax, glm::vec3& origin, glm::vec3& direction, glm::vec3& inverseDirection, glm::ivec3& voxel, float& t, float& tEnd) const
+{
+	if ( !p_voxelGrid || m_pyramid.getNumLevels() == 0 )
+	{
+		return false;
+	}
+
+	// affine transformation, so ray parameters stay the same
+	const glm::mat4& worldToVoxel = p_voxelGrid->getWorldToVoxel();
+	origin = glm::vec3( worldToVoxel * glm::vec4( worldOrigin, 1.0f ) );
+	direction = glm::vec3( worldToVoxel * glm::vec4( worldDirection, 0.0f ) );
+
+	glm::ivec3 resolution( p_voxelGrid->getWidth(), p_voxelGrid->getHeight(), p_voxelGrid->getDepth() );
+
+	t = tMin;
+	tEnd = tMax;
+	for ( int axis = 0; axis < 3; axis++ )
+	{
+		if ( direction[axis] == 0.0f )
+		{
+			inverseDirection[axis] = std::numeric_limits<float>::max();
+			if ( origin[axis] < 0.0f || origin[axis] > (float) resolution[axis] )
+			{
+				return false;
+			}
+			continue;
+		}
+
+		inverseDirection[axis] = 1.0f / direction[axis];
+		float t0 = ( 0.0f - origin[axis] ) * inverseDirection[axis];
+		float t1 = ( (float) resolution[axis] - origin[axis] ) * inverseDirection[axis];
+		if ( t0 > t1 )
+		{
+			std::swap( t0, t1 );
+		}
+		t = ( t0 > t ) ? t0 : t;
+		tEnd = ( t1 < tEnd ) ? t1 : tEnd;
+	}
+
+	if ( t > tEnd )
+	{
+		return false;
+	}
+
+	for ( int axis = 0; axis < 3; axis++ )
+	{
+		int coordinate = (int) std::floor( origin[axis] + direction[axis] * t );
+		voxel[axis] = ( coordinate < 0 ) ? 0 : ( ( coordinate >= resolution[axis] ) ? resolution[axis] - 1 : coordinate );
+	}
+
+	return true;
+}
+
+bool RayQueries::findNextHit(const glm::vec3& origin, const glm::vec3& direction, const glm::vec3& inverseDirection, float tMax, glm::ivec3& voxel, float& t, RayHit& hit) const
+{
+	glm::ivec3 resolution( p_voxelGrid->getWidth(), p_voxelGrid->getHeight(), p_voxelGrid->getDepth() );
+	int numLevels = m_pyramid.getNumLevels();
+
+	// start on the coarsest level containing the voxel, descend into occupied voxels
+	int level = numLevels - 1;
+	while ( t <= tMax )
+	{
+		if ( m_pyramid.isOccupied( level, voxel.x >> level, voxel.y >> level, voxel.z >> level ) )
+		{
+			if ( level > 0 )
+			{
+				level--;
+				continue;
+			}
+
+			glm::ivec3 lower;
+			glm::ivec3 upper;
+			int exitAxis;
+			hit.m_voxel = voxel;
+			hit.m_tEnter = t;
+			hit.m_tExit = computeExit( origin, direction, inverseDirection, voxel, 0, lower, upper, exitAxis );
+			if ( hit.m_tExit < t )
+			{
+				hit.m_tExit = t;
+			}
+			return true;
+		}
+
+		// skip the whole empty voxel of this level
+		if ( !stepOut( origin, direction, inverseDirection, resolution, level, tMax, voxel, t ) )
+		{
+			return false;
+		}
+
+		// ascend as long as the surrounding voxel is empty
+		while ( level + 1 < numLevels && !m_pyramid.isOccupied( level + 1, voxel.x >> ( level + 1 ), voxel.y >> ( level + 1 ), voxel.z >> ( level + 1 ) ) )
+		{
+			level++;
+		}
+	}
+
+	return false;
+}
+
+bool RayQueries::firstHit(const glm::vec3& origin, const glm::vec3& direction, float tMin, float tMax, RayHit& hit) const
+{
+	glm::vec3 gridOrigin;
+	glm::vec3 gridDirection;
+	glm::vec3 inverseDirection;
+	glm::ivec3 voxel;
+	float t;
+	float tEnd;
+
+	hit = RayHit();
+	if ( !enterGrid( origin, direction, tMin, tMax, gridOrigin, gridDirection, inverseDirection, voxel, t, tEnd ) )
+	{
+		return false;
+	}
+
+	return findNextHit( gridOrigin, gridDirection, inverseDirection, tEnd, voxel, t, hit );
+}
+
+int RayQueries::allHits(const glm::vec3& origin, const glm::vec3& direction, float tMin, float tMax, std::vector<RayHit>& hits) const
+{
+	glm::vec3 gridOrigin;
+	glm::vec3 gridDirection;
+	glm::vec3 inverseDirection;
+	glm::ivec3 voxel;
+	float t;
+	float tEnd;
+
+	hits.clear();
+	if ( !enterGrid( origin, direction, tMin, tMax, gridOrigin, gridDirection, inverseDirection, voxel, t, tEnd ) )
+	{
+		return 0;
+	}
+
+	glm::ivec3 resolution( p_voxelGrid->getWidth(), p_voxelGrid->getHeight(), p_voxelGrid->getDepth() );
+	RayHit hit;
+	while ( findNextHit( gridOrigin, gridDirection, inverseDirection, tEnd, voxel, t, hit ) )
+	{
+		hits.push_back( hit );
+		if ( !stepOut( gridOrigin, gridDirection, inverseDirection, resolution, 0, tEnd, voxel, t ) )
+		{
+			break;
+		}
+	}
+
+	return (int) hits.size();
+}
+
+int RayQueries::countOccupiedVoxels(const glm::vec3& origin, const glm::vec3& direction, float tMin, float tMax, float* occupiedLength) const
+{
+	glm::vec3 gridOrigin;
+	glm::vec3 gridDirection;
+	glm::vec3 inverseDirection;
+	glm::ivec3 voxel;
+	float t;
+	float tEnd;
+
+	if ( occupiedLength )
+	{
+		*occupiedLength = 0.0f;
+	}
+	if ( !enterGrid( origin, direction, tMin, tMax, gridOrigin, gridDirection, inverseDirection, voxel, t, tEnd ) )
+	{
+		return 0;
+	}
+
+	glm::ivec3 resolution( p_voxelGrid->getWidth(), p_voxelGrid->getHeight(), p_voxelGrid->getDepth() );
+	int occupiedVoxels = 0;
+	RayHit hit;
+	while ( findNextHit( gridOrigin, gridDirection, inverseDirection, tEnd, voxel, t, hit ) )
+	{
+		occupiedVoxels++;
+		if ( occupiedLength )
+		{
+			*occupiedLength += ( ( hit.m_tExit < tEnd ) ? hit.m_tExit : tEnd ) - hit.m_tEnter;
+		}
+		if ( !stepOut( gridOrigin, gridDirection, inverseDirection, resolution, 0, tEnd, voxel, t ) )
+		{
+			break;
+		}
+	}
+
+	return occupiedVoxels;
+}
+
+bool RayQueries::isVisible(const glm::vec3& from, const glm::vec3& to) const
+{
+	RayHit hit;
+	return !firstHit( from, to - from, 0.0f, 1.0f, hit );
+}
+
+void RayQueries::firstHits(const std::vector<glm::vec3>& origins, const std::vector<glm::vec3>& directions, float tMin, float tMax, std::vector<RayHit>& hits) const
+{
+	if ( origins.size() != directions.size() )
+	{
+		DEBUGLOG->log("ERROR : RAY QUERIES : amount of origins and directions differs");
+		hits.clear();
+		return;
+	}
+
+	hits.resize( origins.size() );
+	int numRays = (int) origins.size();
+
+	#pragma omp parallel for schedule(dynamic, 64)
+	for ( int i = 0; i < numRays; i++ )
+	{
+		firstHit( origins[i], directions[i], tMin, tMax, hits[i] );
+	}
+}
+
+void RayQueries::areVisible(const std::vector<glm::vec3>& from, const std::vector<glm::vec3>& to, std::vector<char>& visible) const
+{
+	if ( from.size() != to.size() )
+	{
+		DEBUGLOG->log("ERROR : RAY QUERIES : amount of start and end positions differs");
+		visible.clear();
+		return;
+	}
+
+	visible.resize( from.size() );
+	int numRays = (int) from.size();
+
+	#pragma omp parallel for schedule(dynamic, 64)
+	for ( int i = 0; i < numRays; i++ )
+	{
+		visible[i] = isVisible( from[i], to[i] ) ? 1 : 0;
+	}
+}
+
+void RayQueries::firstHitPacket(const glm::vec3* origins, const glm::vec3* directions, int numRays, float tMin, float tMax, RayHit* hits) const
+{
+	if ( numRays > RAY_PACKET_SIZE )
+	{
+		DEBUGLOG->log("ERROR : RAY QUERIES : too many rays for one packet : ", numRays);
+		numRays = RAY_PACKET_SIZE;
+	}
+
+#ifdef __AVX2__
+	// per lane state, also used to continue diverged rays one by one
+	float origin[3][RAY_PACKET_SIZE];
+	float direction[3][RAY_PACKET_SIZE];
+	float inverseDirection[3][RAY_PACKET_SIZE];
+	int voxel[3][RAY_PACKET_SIZE];
+	float t[RAY_PACKET_SIZE];
+	float tEnd[RAY_PACKET_SIZE];
+	int active[RAY_PACKET_SIZE];
+
+	int numActive = 0;
+	for ( int i = 0; i < RAY_PACKET_SIZE; i++ )
+	{
+		glm::vec3 gridOrigin( 0.0f );
+		glm::vec3 gridDirection( 1.0f );
+		glm::vec3 gridInverseDirection( 1.0f );
+		glm::ivec3 gridVoxel( 0 );
+		float tStart = 0.0f;
+		float tStop = -1.0f;
+
+		active[i] = 0;
+		if ( i < numRays )
+		{
+			hits[i] = RayHit();
+			if ( enterGrid( origins[i], directions[i], tMin, tMax, gridOrigin, gridDirection, gridInverseDirection, gridVoxel, tStart, tStop ) )
+			{
+				active[i] = -1;
+				numActive++;
+			}
+		}
+
+		for ( int axis = 0; axis < 3; axis++ )
+		{
+			origin[axis][i] = gridOrigin[axis];
+			direction[axis][i] = gridDirection[axis];
+			inverseDirection[axis][i] = gridInverseDirection[axis];
+			voxel[axis][i] = gridVoxel[axis];
+		}
+		t[i] = tStart;
+		tEnd[i] = tStop;
+	}
+
+	if ( numActive >= RAY_PACKET_MIN_ACTIVE_RAYS )
+	{
+		RayPacket packet;
+		for ( int axis = 0; axis < 3; axis++ )
+		{
+			packet.origin[axis] = _mm256_loadu_ps( origin[axis] );
+			packet.direction[axis] = _mm256_loadu_ps( direction[axis] );
+			packet.inverseDirection[axis] = _mm256_loadu_ps( inverseDirection[axis] );
+			packet.voxel[axis] = _mm256_loadu_si256( (const __m256i*) voxel[axis] );
+		}
+		packet.t = _mm256_loadu_ps( t );
+		packet.tEnd = _mm256_loadu_ps( tEnd );
+		packet.active = _mm256_loadu_si256( (const __m256i*) active );
+
+		glm::ivec3 resolution( p_voxelGrid->getWidth(), p_voxelGrid->getHeight(), p_voxelGrid->getDepth() );
+		int numLevels = m_pyramid.getNumLevels();
+
+		// all lanes share one level : descend if any lane is occupied, ascend if all lanes are empty
+		int level = numLevels - 1;
+		while ( true )
+		{
+			__m256i occupied = gatherOccupancy( m_pyramid, level, packet );
+			if ( !_mm256_testz_si256( occupied, occupied ) )
+			{
+				if ( level > 0 )
+				{
+					level--;
+					continue;
+				}
+
+				__m256i lower[3];
+				__m256i upper[3];
+				__m256i exitAxis[3];
+				float tExit[RAY_PACKET_SIZE];
+				_mm256_storeu_ps( tExit, computePacketExit( packet, 0, lower, upper, exitAxis ) );
+				_mm256_storeu_ps( t, packet.t );
+				for ( int axis = 0; axis < 3; axis++ )
+				{
+					_mm256_storeu_si256( (__m256i*) voxel[axis], packet.voxel[axis] );
+				}
+
+				int hitMask = _mm256_movemask_ps( _mm256_castsi256_ps( occupied ) );
+				for ( int i = 0; i < numRays; i++ )
+				{
+					if ( hitMask & ( 1 << i ) )
+					{
+						hits[i].m_voxel = glm::ivec3( voxel[0][i], voxel[1][i], voxel[2][i] );
+						hits[i].m_tEnter = t[i];
+						hits[i].m_tExit = ( tExit[i] > t[i] ) ? tExit[i] : t[i];
+					}
+				}
+
+				packet.active = _mm256_andnot_si256( occupied, packet.active );
+				if ( _mm256_testz_si256( packet.active, packet.active ) )
+				{
+					break;
+				}
+			}
+
+			stepPacketOut( packet, level, resolution );
+			if ( _mm256_testz_si256( packet.active, packet.active ) )
+			{
+				break;
+			}
+
+			while ( level + 1 < numLevels && _mm256_testz_si256( gatherOccupancy( m_pyramid, level + 1, packet ), packet.active ) )
+			{
+				level++;
+			}
+
+			// packet has diverged
+			if ( BitTools::popCount( _mm256_movemask_ps( _mm256_castsi256_ps( packet.active ) ) ) < RAY_PACKET_MIN_ACTIVE_RAYS )
+			{
+				break;
+			}
+		}
+
+		_mm256_storeu_ps( t, packet.t );
+		_mm256_storeu_si256( (__m256i*) active, packet.active );
+		for ( int axis = 0; axis < 3; axis++ )
+		{
+			_mm256_storeu_si256( (__m256i*) voxel[axis], packet.voxel[axis] );
+		}
+	}
+
+	// continue remaining rays one by one
+	for ( int i = 0; i < numRays; i++ )
+	{
+		if ( active[i] )
+		{
+			glm::vec3 gridOrigin( origin[0][i], origin[1][i], origin[2][i] );
+			glm::vec3 gridDirection( direction[0][i], direction[1][i], direction[2][i] );
+			glm::vec3 gridInverseDirection( inverseDirection[0][i], inverseDirection[1][i], inverseDirection[2][i] );
+			glm::ivec3 gridVoxel( voxel[0][i], voxel[1][i], voxel[2][i] );
+			findNextHit( gridOrigin, gridDirection, gridInverseDirection, tEnd[i], gridVoxel, t[i], hits[i] );
+		}
+	}
+#else
+	for ( int i = 0; i < numRays; i++ )
+	{
+		firstHit( origins[i], directions[i], tMin, tMax, hits[i] );
+	}
+#endif
+}
+
+void RayQueries::firstHitsCoherent(const std::vector<glm::vec3>& origins, const std::vector<glm::vec3>& directions, float tMin, float tMax, std::vector<RayHit>& hits) const
+{
+	if ( origins.size() != directions.size() )
+	{
+		DEBUGLOG->log("ERROR : RAY QUERIES : amount of origins and directions differs");
+		hits.clear();
+		return;
+	}
+
+	hits.resize( origins.size() );
+	int numRays = (int) origins.size();
+	int numPackets = ( numRays + RAY_PACKET_SIZE - 1 ) / RAY_PACKET_SIZE;
+
+	#pragma omp parallel for schedule(dynamic, 8)
+	for ( int i = 0; i < numPackets; i++ )
+	{
+		int first = i * RAY_PACKET_SIZE;
+		int packetSize = ( numRays - first < RAY_PACKET_SIZE ) ? numRays - first : RAY_PACKET_SIZE;
+		firstHitPacket( &origins[first], &directions[first], packetSize, tMin, tMax, &hits[first] );
+	}
+}
+
+const BitVoxelGrid* RayQueries::getVoxelGrid() const {
+	return p_voxelGrid;
+}
+
+const OccupancyPyramid& RayQueries::getPyramid() const {
+	return m_pyramid;
+}
@@ -0,0 +1,139 @@
+#ifndef VOXELRAYQUERIES_H
+#define VOXELRAYQUERIES_H
+
+#include <Voxelization/BitVoxelGrid.h>
+#include <Voxelization/OccupancyPyramid.h>
+
+#include <glm/glm.hpp>
+#include <vector>
+
+namespace Grid
+{
+	class AxisAlignedVoxelGrid;
+
+	/**
+	 * An occupied voxel hit by a ray
+	 * ray parameters refer to the ray as it was given in world space, i.e. origin + t * direction
+	 */
+	class RayHit
+	{
+	public:
+		glm::ivec3 m_voxel;	// grid coordinates of the hit voxel, (-1,-1,-1) if nothing was hit
+		float m_tEnter;		// ray parameter where the ray enters the voxel
+		float m_tExit;		// ray parameter where the ray leaves the voxel
+
+		RayHit();
+
+		bool isHit() const;
+	};
+
+	/**
+	 * This class answers ray queries against a bit voxel grid
+	 * Rays are traversed voxel by voxel ( Amanatides & Woo ) on the coarsest empty level of an occupancy pyramid,
+	 * so empty space is skipped in large steps
+	 */
+	class RayQueries
+	{
+	protected:
+		const BitVoxelGrid* p_voxelGrid;	// queried grid, not owned
+		BitVoxelGrid m_convertedGrid;		// used if constructed from a grid cell based voxel grid
+		OccupancyPyramid m_pyramid;
+
+		/**
+		 * find the next occupied voxel, starting at voxel 'voxel' which is entered at t
+		 * origin and direction are given in grid coordinates
+		 */
+		bool findNextHit( const glm::vec3& origin, const glm::vec3& direction, const glm::vec3& inverseDirection, float tMax, glm::ivec3& voxel, float& t, RayHit& hit ) const;
+
+		/**
+		 * transform a world space ray into grid coordinates and clip it against the grid
+		 * @return false if the ray misses the grid within tMin..tMax
+		 */
+		bool enterGrid( const glm::vec3& worldOrigin, const glm::vec3& worldDirection, float tMin, float tMax, glm::vec3& origin, glm::vec3& direction, glm::vec3& inverseDirection, glm::ivec3& voxel, float& t, float& tEnd ) const;
+	public:
+		/**
+		 * @param voxelGrid to be queried, must outlive this object, call update() whenever it changes
+		 */
+		RayQueries( const BitVoxelGrid* voxelGrid );
+
+		/**
+		 * @param axisAlignedVoxelGrid to be queried, its occupancy is copied, call update() whenever it changes
+		 */
+		RayQueries( AxisAlignedVoxelGrid* axisAlignedVoxelGrid );
+		virtual ~RayQueries();
+
+		/**
+		 * rebuild the occupancy pyramid after the voxel grid has changed
+		 */
+		void update();
+
+		/**
+		 * re-read the occupancy of a grid cell based voxel grid and rebuild the occupancy pyramid
+		 */
+		void update( AxisAlignedVoxelGrid* axisAlignedVoxelGrid );
+
+		/**
+		 * find the first occupied voxel along a ray
+		 * @param origin ray origin in world coordinates
+		 * @param direction ray direction in world coordinates, need not be normalized
+		 * @param tMin start of the queried ray segment
+		 * @param tMax end of the queried ray segment
+		 * @param hit will be set to the first hit voxel
+		 * @return true if an occupied voxel was hit
+		 */
+		bool firstHit( const glm::vec3& origin, const glm::vec3& direction, float tMin, float tMax, RayHit& hit ) const;
+
+		/**
+		 * find all occupied voxels along a ray, ordered front to back
+		 * @param hits will be cleared and filled with all hit voxels
+		 * @return amount of hit voxels
+		 */
+		int allHits( const glm::vec3& origin, const glm::vec3& direction, float tMin, float tMax, std::vector< RayHit >& hits ) const;
+
+		/**
+		 * count occupied voxels along a ray segment
+		 * @param occupiedLength if not 0, will be set to the length of the ray parameter range spent inside occupied voxels
+		 * @return amount of occupied voxels
+		 */
+		int countOccupiedVoxels( const glm::vec3& origin, const glm::vec3& direction, float tMin, float tMax, float* occupiedLength = 0 ) const;
+
+		/**
+		 * @return true if no occupied voxel lies between two world positions
+		 */
+		bool isVisible( const glm::vec3& from, const glm::vec3& to ) const;
+
+		/**
+		 * find the first hit for a batch of rays in parallel
+		 * @param hits will be resized and filled with one result per ray, see RayHit::isHit()
+		 */
+		void firstHits( const std::vector< glm::vec3 >& origins, const std::vector< glm::vec3 >& directions, float tMin, float tMax, std::vector< RayHit >& hits ) const;
+
+		/**
+		 * test visibility for a batch of position pairs in parallel
+		 * @param visible will be resized and filled with 1 if the pair is mutually visible, 0 otherwise
+		 */
+		void areVisible( const std::vector< glm::vec3 >& from, const std::vector< glm::vec3 >& to, std::vector< char >& visible ) const;
+
+		/**
+		 * find the first hit for a packet of up to 8 coherent rays ( i.e. neighbouring camera or light rays )
+		 * all rays of the packet are traversed in lockstep on a common pyramid level using AVX2 if available,
+		 * once the packet has diverged to only a few active rays, the remaining rays are traversed one by one
+		 * @param origins of the rays in world coordinates
+		 * @param directions of the rays in world coordinates
+		 * @param numRays amount of rays, at most 8
+		 * @param hits will be filled with one result per ray
+		 */
+		void firstHitPacket( const glm::vec3* origins, const glm::vec3* directions, int numRays, float tMin, float tMax, RayHit* hits ) const;
+
+		/**
+		 * find the first hit for a batch of coherent rays, traversed in packets of 8 consecutive rays in parallel
+		 * @param hits will be resized and filled with one result per ray, see RayHit::isHit()
+		 */
+		void firstHitsCoherent( const std::vector< glm::vec3 >& origins, const std::vector< glm::vec3 >& directions, float tMin, float tMax, std::vector< RayHit >& hits ) const;
+
+		const BitVoxelGrid* getVoxelGrid() const;
+		const OccupancyPyramid& getPyramid() const;
+	};
+}
+
+#endif
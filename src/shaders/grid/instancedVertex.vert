@@ -0,0 +1,19 @@
+#version 330
+
+// an instanced vertex shader which places a unit cube ( -0.5 .. 0.5 ) at every instance: xyz is the center, w the edge length
+// non instanced models read the default attribute ( 0, 0, 0, 1 ) and are drawn unchanged
+
+uniform mat4 uniformModel;
+uniform mat4 uniformView;
+uniform mat4 uniformProjection;
+
+layout (location = 0) in vec4 positionAttribute;
+layout (location = 4) in vec4 instanceAttribute;
+
+void main() {
+	// vertex position
+	vec4 instancePosition = vec4( positionAttribute.xyz * instanceAttribute.w + instanceAttribute.xyz, 1.0 );
+	vec4 position = uniformProjection * uniformView * uniformModel * instancePosition;
+
+	gl_Position = position;
+}